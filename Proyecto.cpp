@@ -8,21 +8,67 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include "engine/scene_cache.h"
+#include "engine/asset_cache.h"
+#include "engine/collision_bvh.h"
+#include "engine/drone_physics.h"
+#include "engine/thread_pool.h"
+#include "engine/light_clusters.h"
+#include "engine/scene_culling.h"
+#include "engine/render_queue.h"
+#include "engine/static_batch.h"
+#include "engine/hud_widget.h"
+#include "engine/text_renderer.h"
+#include "engine/headless.h"
+#include "engine/frame_benchmark.h"
+#include "engine/profiler.h"
+#include "engine/lod_selection.h"
+#include "engine/scene_manifest.h"
+#include "engine/world_streamer.h"
+#include "engine/mesh_analysis.h"
+#include "engine/occlusion_culling.h"
+#include "engine/shader_variants.h"
+#include "engine/drone_swarm.h"
+#include "engine/lidar_sensor.h"
+#include "engine/frame_capture.h"
+#include "engine/dynamic_resolution.h"
 #include <vector>
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
 #define STB_IMAGE_IMPLEMENTATION
 #include <learnopengl/stb_image.h>
 
 // --- CONFIGURACIÓN ---
 const unsigned int SCR_WIDTH = 1600;
 const unsigned int SCR_HEIGHT = 800;
-const int MAX_LIGHTS = 32;
 const float MAX_DISTANCE = 100.0f;
+// Fondo = color de la niebla de lighting.fs (0.01, 0.01, 0.02) con su pow(1/1.2):
+// lo que se descarta por niebla (scene_culling.h) no deja un borde visible.
+// Con visión térmica no hay niebla ni descarte por distancia.
+const glm::vec3 CLEAR_COLOR = glm::vec3(0.0215f, 0.0215f, 0.0385f);
 const float RESPAWN_DELAY = 2.0f;
 const float ACCELERATION = 35.0f;
 const float FRICTION = 0.94f;
 const float MAX_SPEED = 12.0f;
 const float DRONE_RADIUS = 0.3f;
+const GLsizei BATTERY_MAX_VERTICES = 8 + 6 + 8;         // contorno + punta + relleno
+const int BENCHMARK_DEFAULT_FRAMES = 600;
+const float BENCHMARK_FRAME_TIME = 1.0f / 60.0f;        // tiempo simulado por frame sin ventana
+const glm::vec3 BENCHMARK_HOUSE_POINT = glm::vec3(0.0f, 1.2f, 2.5f);   // dentro de la casa, junto a los fantasmas
+const char* const DEFAULT_SCENE = "scenes/scene2.json";
+const float SWARM_STEP = 1.0f / 60.0f;                  // paso fijo del enjambre (en los hilos de trabajo)
+const int SWARM_MAX_STEPS = 4;                          // pasos como máximo por frame
+const float SWARM_CHASE_DISTANCE = 3.0f;                // cámara detrás del dron del enjambre seguido
+const int CAPTURE_FPS = 60;                             // cuadros por segundo declarados en el video
+
+// Variantes de lighting.fs y del shader del HUD (ver engine/shader_variants.h)
+const uint32_t LIGHTING_THERMAL = 1, LIGHTING_EMISSIVE = 2, LIGHTING_FOG = 4;
+const uint32_t HUD_FRAME = 1, HUD_WARNING = 2, HUD_BATTERY = 4;
 
 // --- ESTADOS ---
 struct DroneState {
@@ -30,23 +76,95 @@ struct DroneState {
     bool vKeyPressed = false;
     bool lightsOn = true;
     bool lKeyPressed = false;
-    bool signalLost = false;
-    float signalLostTimer = 0.0f;
+    bool cKeyPressed = false;
+    bool signalLost = false;            // copiados del último paso de física
     glm::vec3 velocity = glm::vec3(0.0f);
     float startTime = 0.0f;
     float batteryPercent = 100.0f;
 } drone;
 
+// Un modelo del manifiesto ya cargado
+struct SceneObject {
+    const SceneObjectDesc* desc = nullptr;
+    ModelHandle model;
+    glm::mat4 transform = glm::mat4(1.0f);
+    int cullId = -1;
+    int batchId = -1;                   // >= 0 si se dibuja en el lote estático
+    int chunk = -1;                     // >= 0 si lo maneja el WorldStreamer
+};
+
 Camera camera(glm::vec3(-4.2f, 2.0f, 35.0f));
 const glm::vec3 SPAWN_POINT = glm::vec3(0.0f, 2.0f, 15.0f);
 float lastX = SCR_WIDTH / 2.0f, lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
+bool profilerKeyPressed = false, traceKeyPressed = false, captureKeyPressed = false;
+bool captureToggleRequested = false;    // F5: el bucle empieza o termina la grabación
+int cameraDrone = -1;                   // dron del enjambre que sigue la cámara; -1: el del jugador
 float deltaTime = 0.0f, lastFrame = 0.0f;
 
-struct BoundingBox { glm::vec3 min, max; };
-std::vector<BoundingBox> collisionBoxes;
+CollisionBVH sceneCollision;
 std::vector<glm::vec3> lampPositions;
 
+// --- LÍNEA DE COMANDOS ---
+// Drone [--scene scenes/scene2.json] [--assets DIR] --headless [--frames N] [--size 1600x800] [--out benchmark]
+struct LaunchOptions {
+    bool headless = false;
+    int frames = BENCHMARK_DEFAULT_FRAMES;
+    int width = SCR_WIDTH;
+    int height = SCR_HEIGHT;
+    std::string output = "benchmark";   // se escriben <output>.csv y <output>.json
+    std::string trace;                  // si no está vacío, traza del profiler al terminar
+    bool compressedTextures = true;     // --no-ktx: ignorar los .ktx y decodificar las imágenes
+    std::string scene = DEFAULT_SCENE;  // manifiesto con los modelos, luces y HUD
+    std::string assetRoot;              // si no está vacío, reemplaza la raíz de assets del manifiesto
+    bool occlusion = true;              // --no-occlusion: solo frustum y niebla
+    int swarm = -1;                     // --swarm N: drones del enjambre (-1: los del manifiesto)
+    bool lidar = false;                 // --lidar: sensor LiDAR simulado en su propio hilo
+    std::string lidarOutput;            // --lidar-out PATH: además graba los barridos (implica --lidar)
+    std::string capture;                // --capture PATH: graba el video desde el primer frame (.y4m o RGB crudo)
+    float budget = -1.0f;               // --budget MS: resolución dinámica (-1: DRS_DEFAULT_BUDGET_MS con ventana,
+                                        // apagada sin ventana; 0: siempre a resolución nativa)
+    bool sharpen = true;                // --no-sharpen: escalado solo bilineal
+};
+
+bool parseLaunchOptions(int argc, char** argv, LaunchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--headless") options.headless = true;
+        else if (arg == "--frames" && hasValue) options.frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 ||
+                options.width <= 0 || options.height <= 0) {
+                std::cout << "Invalid --size, expected WIDTHxHEIGHT" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--out" && hasValue) options.output = argv[++i];
+        else if (arg == "--trace" && hasValue) options.trace = argv[++i];
+        else if (arg == "--no-ktx") options.compressedTextures = false;
+        else if (arg == "--scene" && hasValue) options.scene = argv[++i];
+        else if (arg == "--assets" && hasValue) options.assetRoot = argv[++i];
+        else if (arg == "--no-occlusion") options.occlusion = false;
+        else if (arg == "--swarm" && hasValue) options.swarm = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--capture" && hasValue) options.capture = argv[++i];
+        else if (arg == "--budget" && hasValue) options.budget = std::max(0.0f, (float)std::atof(argv[++i]));
+        else if (arg == "--no-sharpen") options.sharpen = false;
+        else if (arg == "--lidar") options.lidar = true;
+        else if (arg == "--lidar-out" && hasValue) {
+            options.lidar = true;
+            options.lidarOutput = argv[++i];
+        }
+        else {
+            std::cout << "Usage: " << argv[0] << " [--scene PATH] [--assets DIR] [--headless] [--frames N] [--size WxH]"
+                      << " [--out PATH] [--trace PATH] [--no-ktx] [--no-occlusion] [--swarm N]"
+                      << " [--lidar] [--lidar-out PATH] [--capture PATH] [--budget MS] [--no-sharpen]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
 // --- CALLBACKS ---
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
@@ -58,31 +176,108 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
     lastX = (float)xpos; lastY = (float)ypos;
 }
 
-void ExtractData(Model& house, Model& lights) {
-    collisionBoxes.clear();
-    collisionBoxes.reserve(house.meshes.size());
-    for (const auto& mesh : house.meshes) {
-        glm::vec3 minP(1e10f), maxP(-1e10f);
-        for (const auto& v : mesh.vertices) {
-            minP = glm::min(minP, v.Position);
-            maxP = glm::max(maxP, v.Position);
-        }
-        collisionBoxes.push_back({ minP, maxP });
+// false (con un aviso) si el archivo del modelo no existe.
+bool sceneFileExists(const SceneObjectDesc& desc) {
+    if (std::ifstream(desc.path).good()) return true;
+    std::cout << (desc.optional ? "SCENE::SKIPPED " : "SCENE::MISSING ") << desc.name << " (" << desc.path << ")" << std::endl;
+    return false;
+}
+
+// Carga un modelo del manifiesto; false si su archivo no existe.
+bool loadSceneObject(AssetCache& assets, const SceneObjectDesc& desc, SceneObject& object) {
+    if (!sceneFileExists(desc)) return false;
+    object.desc = &desc;
+    object.model = assets.acquireModel(desc.path);
+    object.transform = desc.transformAt(0.0f);
+    return true;
+}
+
+void ExtractData(const std::vector<SceneObject>& objects, const SceneManifest& manifest, ThreadPool& workers) {
+    // Un análisis por modelo (en paralelo entre mallas): triángulos para
+    // reservar la BVH de una vez y centroides para las lámparas
+    std::vector<std::vector<MeshStats>> stats(objects.size());
+    size_t collisionTriangles = 0;
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (!objects[i].desc->collision && !objects[i].desc->lamps) continue;
+        stats[i] = analyzeMeshes(objects[i].model->meshes, workers);
+        if (objects[i].desc->collision)
+            for (const auto& mesh : stats[i]) collisionTriangles += mesh.triangleCount;
     }
 
-    lampPositions.clear();
-    lampPositions.reserve(lights.meshes.size());
-    for (const auto& mesh : lights.meshes) {
-        glm::vec3 center(0.0f);
-        for (const auto& v : mesh.vertices) center += v.Position;
-        lampPositions.push_back(center / (float)mesh.vertices.size());
+    // Colisión contra los triángulos reales de la casa (BVH), no contra una caja por malla
+    sceneCollision.clear();
+    sceneCollision.triangles.reserve(collisionTriangles);
+    for (const auto& object : objects)
+        if (object.desc->collision) sceneCollision.addMeshes(object.model->meshes);
+    sceneCollision.build();
+
+    lampPositions = manifest.lightPositions;
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (!objects[i].desc->lamps) continue;
+        for (const auto& mesh : stats[i])
+            if (mesh.vertexCount > 0) lampPositions.push_back(mesh.centroid);
+    }
+}
+
+// Para la oclusión solo sirven mallas sin agujeros: lighting.fs descarta los
+// píxeles con alfa bajo, así que se excluye toda textura difusa con canal alfa
+// (o que no se pueda leer).
+bool isSolidMesh(const SceneModel& model, const SceneMesh& mesh) {
+    for (const auto& tex : mesh.textures) {
+        if (tex.type != "texture_diffuse") continue;
+        int width = 0, height = 0, channels = 0;
+        if (!stbi_info((model.directory + '/' + tex.path).c_str(), &width, &height, &channels)) return false;
+        if (channels == 2 || channels == 4) return false;
+    }
+    return true;
+}
+
+// La visión nocturna ignora luces, niebla y emisión, y lo emisivo ignora la
+// niebla: de las 8 combinaciones solo hacen falta 4 programas.
+uint32_t lightingVariant(bool thermal, bool emissive, bool fog) {
+    if (thermal) return LIGHTING_THERMAL;
+    if (emissive) return LIGHTING_EMISSIVE;
+    return fog ? LIGHTING_FOG : 0;
+}
+
+// Recorrido del modo sin ventana: aparición, la calle iluminada por la lámpara
+// más cercana y el interior de la casa.
+CameraPath buildBenchmarkPath() {
+    CameraPath path;
+    path.add(SPAWN_POINT, SPAWN_POINT + glm::vec3(0.0f, -0.5f, -10.0f));
+    if (!lampPositions.empty()) {
+        glm::vec3 lamp = lampPositions[0];
+        for (const auto& p : lampPositions)
+            if (glm::distance2(p, SPAWN_POINT) < glm::distance2(lamp, SPAWN_POINT)) lamp = p;
+        path.add(glm::vec3(lamp.x + 2.0f, 2.0f, lamp.z + 3.0f), glm::vec3(lamp.x, 0.5f, lamp.z));
     }
+    path.add(BENCHMARK_HOUSE_POINT + glm::vec3(0.0f, 0.3f, 4.0f), BENCHMARK_HOUSE_POINT);
+    path.add(BENCHMARK_HOUSE_POINT, glm::vec3(0.0f, 0.6f, 0.0f));
+    return path;
 }
 
-void processInput(GLFWwindow* window) {
+// Solo lee el teclado; la integración ocurre en el hilo de física a paso fijo.
+void processInput(GLFWwindow* window, DronePhysics& physics, Profiler& profiler, size_t swarmSize) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
+    // F3: profiler y su panel en el HUD; F4: guarda la traza para chrome://tracing
+    bool profilerKey = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
+    if (profilerKey && !profilerKeyPressed) profiler.setEnabled(!profiler.enabled());
+    profilerKeyPressed = profilerKey;
+
+    bool traceKey = glfwGetKey(window, GLFW_KEY_F4) == GLFW_PRESS;
+    if (traceKey && !traceKeyPressed && profiler.active()) {
+        const char* tracePath = "profile_trace.json";
+        if (profiler.writeChromeTrace(tracePath)) std::cout << "Traza guardada en " << tracePath << std::endl;
+    }
+    traceKeyPressed = traceKey;
+
+    // F5: grabar / dejar de grabar la imagen final
+    bool captureKey = glfwGetKey(window, GLFW_KEY_F5) == GLFW_PRESS;
+    if (captureKey && !captureKeyPressed) captureToggleRequested = true;
+    captureKeyPressed = captureKey;
+
     bool vKey = glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS;
     if (vKey && !drone.vKeyPressed) drone.thermalVision = !drone.thermalVision;
     drone.vKeyPressed = vKey;
@@ -91,6 +286,11 @@ void processInput(GLFWwindow* window) {
     if (lKey && !drone.lKeyPressed) drone.lightsOn = !drone.lightsOn;
     drone.lKeyPressed = lKey;
 
+    // C: la cámara pasa al siguiente dron del enjambre y, tras el último, vuelve al del jugador
+    bool cKey = glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS;
+    if (cKey && !drone.cKeyPressed) cameraDrone = cameraDrone + 1 < (int)swarmSize ? cameraDrone + 1 : -1;
+    drone.cKeyPressed = cKey;
+
     bool ghostMode = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS;
 
     glm::vec3 inputDir(0.0f);
@@ -101,67 +301,17 @@ void processInput(GLFWwindow* window) {
     if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) inputDir.y += 1.0f;
     if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) inputDir.y -= 1.0f;
 
-    if (glm::length(inputDir) > 0.0f)
-        drone.velocity += glm::normalize(inputDir) * ACCELERATION * deltaTime;
-
-    if (glm::length(drone.velocity) > MAX_SPEED)
-        drone.velocity = glm::normalize(drone.velocity) * MAX_SPEED;
-
-    drone.velocity *= FRICTION;
-    glm::vec3 nextPos = camera.Position + drone.velocity * deltaTime;
-
-    if (!ghostMode) {
-        for (const auto& box : collisionBoxes) {
-            if (nextPos.x + DRONE_RADIUS > box.min.x && nextPos.x - DRONE_RADIUS < box.max.x &&
-                nextPos.y + DRONE_RADIUS > box.min.y && nextPos.y - DRONE_RADIUS < box.max.y &&
-                nextPos.z + DRONE_RADIUS > box.min.z && nextPos.z - DRONE_RADIUS < box.max.z) {
-                drone.velocity = glm::vec3(0.0f);
-                return;
-            }
-        }
-    }
-    camera.Position = nextPos;
+    DroneInput input;
+    input.direction = cameraDrone < 0 ? inputDir : glm::vec3(0.0f);    // mirando otro dron, el propio queda quieto
+    input.ghostMode = ghostMode;
+    physics.submitInput(input);
 }
 
 // --- HUD SETUP ---
-unsigned int loadTexture(const char* path) {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    stbi_set_flip_vertically_on_load(true);
-
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 0);
-
-    if (data) {
-        GLenum format;
-        if (nrChannels == 1)
-            format = GL_RED;
-        else if (nrChannels == 3)
-            format = GL_RGB;
-        else if (nrChannels == 4)
-            format = GL_RGBA; // <--- ¡Esto es lo que necesitabas!
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        // Enviamos la textura a OpenGL con el formato correcto detectado arriba
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        // Parámetros de texturas
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else {
-        std::cout << "Failed to load texture: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    stbi_set_flip_vertically_on_load(false);
-    return textureID;
+// La imagen se decodifica en los hilos del streamer; mientras llega, la
+// textura devuelta ya es válida (placeholder de 1x1).
+unsigned int loadTexture(AssetCache& assets, const std::string& path) {
+    return assets.acquireTexture(path, true, GL_CLAMP_TO_EDGE);
 }
 
 unsigned int setupQuadVAO() {
@@ -218,120 +368,7 @@ unsigned int setupWarningVAO() {
     return VAO;
 }
 
-unsigned int setupTextVAO() {
-    std::vector<float> v;
-    float s = 0.015f, x = -0.28f, y = 0.0f, sp = 0.05f;
-
-    v.insert(v.end(), { x + s,y + 2 * s,0, x,y + 2 * s,0, x,y + 2 * s,0, x,y + s,0, x,y + s,0, x + s,y + s,0, x + s,y + s,0, x + s,y,0, x + s,y,0, x,y,0 });
-    x += sp; v.insert(v.end(), { x,y + 2 * s,0, x,y,0 });
-    x += sp; v.insert(v.end(), { x + s,y + 2 * s,0, x,y + 2 * s,0, x,y + 2 * s,0, x,y,0, x,y,0, x + s,y,0, x + s,y,0, x + s,y + s,0, x + s,y + s,0, x + s * 0.5f,y + s,0 });
-    x += sp; v.insert(v.end(), { x,y,0, x,y + 2 * s,0, x,y + 2 * s,0, x + s,y,0, x + s,y,0, x + s,y + 2 * s,0 });
-    x += sp; v.insert(v.end(), { x,y,0, x + s * 0.5f,y + 2 * s,0, x + s * 0.5f,y + 2 * s,0, x + s,y,0, x + s * 0.25f,y + s,0, x + s * 0.75f,y + s,0 });
-    x += sp; v.insert(v.end(), { x,y + 2 * s,0, x,y,0, x,y,0, x + s,y,0 });
-    x += sp * 1.5f;
-    v.insert(v.end(), { x,y + 2 * s,0, x,y,0, x,y,0, x + s,y,0 });
-    x += sp; v.insert(v.end(), { x,y,0, x,y + 2 * s,0, x,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y,0, x + s,y,0, x,y,0 });
-    x += sp; v.insert(v.end(), { x + s,y + 2 * s,0, x,y + 2 * s,0, x,y + 2 * s,0, x,y + s,0, x,y + s,0, x + s,y + s,0, x + s,y + s,0, x + s,y,0, x + s,y,0, x,y,0 });
-    x += sp; v.insert(v.end(), { x,y + 2 * s,0, x + s,y + 2 * s,0, x + s * 0.5f,y + 2 * s,0, x + s * 0.5f,y,0 });
-
-    unsigned int VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, v.size() * sizeof(float), v.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glBindVertexArray(0);
-    return VAO;
-}
-
-void createDigitVertices(std::vector<float>& v, int digit, float x, float y, float s) {
-    // Dibuja dígitos del 0-9 usando segmentos de 7 líneas
-    // Coordenadas ajustables: x (horizontal), y (vertical), s (tamaño)
-    switch (digit) {
-    case 0:
-        v.insert(v.end(), { x,y,0, x,y + 2 * s,0, x,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y,0, x + s,y,0, x,y,0 });
-        break;
-    case 1:
-        v.insert(v.end(), { x + s,y + 2 * s,0, x + s,y,0 });
-        break;
-    case 2:
-        v.insert(v.end(), { x,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y + s,0, x + s,y + s,0, x,y + s,0, x,y + s,0, x,y,0, x,y,0, x + s,y,0 });
-        break;
-    case 3:
-        v.insert(v.end(), { x,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y,0, x + s,y,0, x,y,0, x,y + s,0, x + s,y + s,0 });
-        break;
-    case 4:
-        v.insert(v.end(), { x,y + 2 * s,0, x,y + s,0, x,y + s,0, x + s,y + s,0, x + s,y + 2 * s,0, x + s,y,0 });
-        break;
-    case 5:
-        v.insert(v.end(), { x + s,y + 2 * s,0, x,y + 2 * s,0, x,y + 2 * s,0, x,y + s,0, x,y + s,0, x + s,y + s,0, x + s,y + s,0, x + s,y,0, x + s,y,0, x,y,0 });
-        break;
-    case 6:
-        v.insert(v.end(), { x + s,y + 2 * s,0, x,y + 2 * s,0, x,y + 2 * s,0, x,y,0, x,y,0, x + s,y,0, x + s,y,0, x + s,y + s,0, x + s,y + s,0, x,y + s,0 });
-        break;
-    case 7:
-        v.insert(v.end(), { x,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y,0 });
-        break;
-    case 8:
-        v.insert(v.end(), { x,y,0, x,y + 2 * s,0, x,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y + 2 * s,0, x + s,y,0, x + s,y,0, x,y,0, x,y + s,0, x + s,y + s,0 });
-        break;
-    case 9:
-        v.insert(v.end(), { x + s,y,0, x + s,y + 2 * s,0, x + s,y + 2 * s,0, x,y + 2 * s,0, x,y + 2 * s,0, x,y + s,0, x,y + s,0, x + s,y + s,0 });
-        break;
-    }
-}
-
-unsigned int createTimerVAO(int hours, int mins, int secs) {
-    std::vector<float> v;
-    // POSICIÓN: Esquina inferior derecha
-    // Ajusta estas coordenadas para mover el timer:
-    float startX = 0.60f;   // Más positivo = más a la derecha
-    float startY = -0.70f;  // Más negativo = más abajo
-    float digitSize = 0.012f;
-    float spacing = 0.035f;
-
-    float x = startX;
-
-    // HH:MM:SS
-    createDigitVertices(v, hours / 10, x, startY, digitSize); x += spacing;
-    createDigitVertices(v, hours % 10, x, startY, digitSize); x += spacing;
-
-    // Dos puntos (:)
-    v.insert(v.end(), { x + digitSize * 0.3f, startY + digitSize * 1.5f, 0, x + digitSize * 0.3f, startY + digitSize * 1.5f, 0 });
-    v.insert(v.end(), { x + digitSize * 0.3f, startY + digitSize * 0.5f, 0, x + digitSize * 0.3f, startY + digitSize * 0.5f, 0 });
-    x += spacing * 0.7f;
-
-    createDigitVertices(v, mins / 10, x, startY, digitSize); x += spacing;
-    createDigitVertices(v, mins % 10, x, startY, digitSize); x += spacing;
-
-    // Dos puntos (:)
-    v.insert(v.end(), { x + digitSize * 0.3f, startY + digitSize * 1.5f, 0, x + digitSize * 0.3f, startY + digitSize * 1.5f, 0 });
-    v.insert(v.end(), { x + digitSize * 0.3f, startY + digitSize * 0.5f, 0, x + digitSize * 0.3f, startY + digitSize * 0.5f, 0 });
-    x += spacing * 0.7f;
-
-    createDigitVertices(v, secs / 10, x, startY, digitSize); x += spacing;
-    createDigitVertices(v, secs % 10, x, startY, digitSize);
-
-    unsigned int VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, v.size() * sizeof(float), v.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glBindVertexArray(0);
-    return VAO;
-}
-
-unsigned int createBatteryVAO(float percent) {
-    std::vector<float> v;
+void buildBatteryVertices(std::vector<float>& v, float percent) {
     // POSICIÓN: Esquina superior izquierda
     // Ajusta estas coordenadas para mover la batería:
     float x = -0.85f;  // Más negativo = más a la izquierda
@@ -365,50 +402,179 @@ unsigned int createBatteryVAO(float percent) {
             x + 0.004f, y - h + 0.004f, 0, x + 0.004f, y - 0.004f, 0
             });
     }
-
-    unsigned int VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, v.size() * sizeof(float), v.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glBindVertexArray(0);
-    return VAO;
 }
 
-int main() {
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+// Crea todo lo que vive en el contexto GL, corre el bucle y lo libera al
+// volver: los destructores (buffers, texturas, hilos) se ejecutan antes de que
+// main() llame a glfwTerminate().
+int runSimulation(GLFWwindow* window, const LaunchOptions& options) {
+    const auto loadStart = std::chrono::steady_clock::now();
+    glEnable(GL_DEPTH_TEST);
 
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Drone Simulation", nullptr, nullptr);
-    if (!window) return -1;
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    // Qué se carga, dónde va y en qué orden lo dice el manifiesto de la escena
+    SceneManifest manifest;
+    std::string manifestError;
+    if (!loadSceneManifest(options.scene, options.assetRoot, manifest, manifestError)) {
+        std::cout << "SCENE::MANIFEST " << manifestError << std::endl;
+        return -1;
+    }
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) return -1;
-    glEnable(GL_DEPTH_TEST);
+    // Las texturas se decodifican en paralelo y se suben poco a poco en el bucle.
+    // Modelos, texturas y mallas pasan por la caché de assets: lo que se repite
+    // (las texturas de pared que comparten la casa y las lámparas) se carga una vez.
+    TextureStreamer textureStreamer;
+    textureStreamer.setUseCompressed(options.compressedTextures);
+    AssetCache assets(&textureStreamer);
+
+    // Si existe un <modelo>.obj.cache vigente se mapea directamente; si no, se
+    // carga el OBJ con Assimp y se hornea la caché para el próximo arranque.
+    // Antes del primer frame solo va lo que el resto necesita (colisión, lote
+    // estático, lámparas) y la prioridad 0; los props de fondo quedan en cola y
+    // se cargan de a uno por frame. Sin ventana se carga todo antes de empezar.
+    // Los modelos "stream" los carga y descarga el WorldStreamer por distancia.
+    std::vector<SceneObject> sceneObjects;
+    std::vector<const SceneObjectDesc*> pendingObjects;
+    WorldStreamer worldStreamer(assets, manifest.streaming);
+    worldStreamer.setSynchronous(options.headless);
+    for (const auto& desc : manifest.objects) {
+        if (desc.stream) {
+            if (sceneFileExists(desc)) worldStreamer.add(desc);
+            else if (!desc.optional) return -1;
+            continue;
+        }
+        if (!options.headless && !desc.loadAtStartup()) {
+            pendingObjects.push_back(&desc);
+            continue;
+        }
+        SceneObject object;
+        if (loadSceneObject(assets, desc, object)) sceneObjects.push_back(object);
+        else if (!desc.optional) return -1;
+    }
 
-    Shader lightingShader("shaders/lighting.vs", "shaders/lighting.fs");
+    // Hilos de trabajo: análisis de mallas al cargar y asignación de luces por frame
+    ThreadPool workers;
+    ExtractData(sceneObjects, manifest, workers);
+    worldStreamer.setBaseCollision(sceneCollision);
+
+    // Cajas en mundo por malla para el culling; los objetos animados
+    // actualizan su transformación cada frame.
+    SceneCuller culler;
+    for (auto& object : sceneObjects)
+        object.cullId = culler.addObject(*object.model, object.transform, object.desc->fog);
+
+    // Oclusión en CPU: paredes y pisos de los modelos marcados como "occluder"
+    OcclusionCuller occlusion;
+    if (options.occlusion) {
+        for (const auto& object : sceneObjects) {
+            if (!object.desc->occluder) continue;
+            const SceneModel& model = *object.model;
+            occlusion.addOccluderModel(model, object.transform,
+                                       [&](const SceneMesh& mesh) { return isSolidMesh(model, mesh); });
+        }
+        occlusion.build();
+        std::cout << "Oclusores: " << occlusion.stats.occluderMeshes << " mallas, "
+                  << occlusion.stats.occluderTriangles << " triangulos" << std::endl;
+    }
 
-    Model house("C:/Users/DELL/Documents/Visual Studio 2022/OpenGL/OpenGL/model/scene2/Scnecp.obj");
-    Model clouds("C:/Users/DELL/Documents/Visual Studio 2022/OpenGL/OpenGL/model/scene2/Clouds.obj");
-    Model lightsModel("C:/Users/DELL/Documents/Visual Studio 2022/OpenGL/OpenGL/model/scene2/Lights.obj");
-	Model moon("C:/Users/DELL/Documents/Visual Studio 2022/OpenGL/OpenGL/model/scene2/Moon.obj");
-    Model ghost1Model("C:/Users/DELL/Documents/Visual Studio 2022/OpenGL/OpenGL/model/scene2/Ghost1.obj");
-    Model ghost2Model("C:/Users/DELL/Documents/Visual Studio 2022/OpenGL/OpenGL/model/scene2/Ghost2.obj");
-    Model vanModel("C:/Users/DELL/Documents/Visual Studio 2022/OpenGL/OpenGL/model/scene2/van.obj");
+    // Props (luna, nubes, fantasmas, van): nivel de detalle según su tamaño
+    // en pantalla; los niveles vienen horneados en la caché.
+    LodSelector lodSelector;
+
+    // Casa y lámparas en un solo VBO/EBO agrupado por material: se dibujan con
+    // un glMultiDraw por array de texturas en vez de un dibujo por malla.
+    StaticBatch staticBatch(&textureStreamer);
+    for (auto& object : sceneObjects)
+        if (object.desc->staticBatch) object.batchId = staticBatch.add(*object.model);
+    staticBatch.build();
+    std::cout << "Geometría estática: " << staticBatch.meshCount() << " mallas, "
+              << staticBatch.materialCount() << " materiales, "
+              << (staticBatch.usesIndirect() ? "multi-draw indirect" : "multi-draw") << std::endl;
+
+    CullStats cullTotals;
+    RenderStats drawTotals;
+    long long stateTotals = 0, legacyStateTotals = 0;
+    int statFrames = 0;
+    float lastStatReport = 0.0f;
+
+    // Física del dron a 240 Hz en su propio hilo (colisiona con la BVH de la casa)
+    DroneTuning tuning;
+    tuning.acceleration = ACCELERATION;
+    tuning.friction = FRICTION;
+    tuning.maxSpeed = MAX_SPEED;
+    tuning.radius = DRONE_RADIUS;
+    tuning.maxDistance = MAX_DISTANCE;
+    tuning.respawnDelay = RESPAWN_DELAY;
+    tuning.spawnPoint = SPAWN_POINT;
+    DronePhysics dronePhysics(tuning, &sceneCollision);
+    if (!options.headless) dronePhysics.start(camera.Position);   // sin ventana la cámara sigue el recorrido
+
+    // Enjambre: drones autónomos en órbitas alrededor del punto de salida, con
+    // la misma física y las mismas reglas de señal que el del jugador
+    const SwarmDesc& swarmDesc = manifest.swarm;
+    size_t swarmCount = options.swarm >= 0 ? (size_t)options.swarm : (size_t)swarmDesc.count;
+    ModelHandle swarmModel;
+    if (swarmCount > 0) {
+        if (!swarmDesc.path.empty() && std::ifstream(swarmDesc.path).good()) swarmModel = assets.acquireModel(swarmDesc.path);
+        else {
+            std::cout << "SCENE::SKIPPED swarm (" << (swarmDesc.path.empty() ? "no model" : swarmDesc.path) << ")" << std::endl;
+            swarmCount = 0;
+        }
+    }
+    DroneSwarm swarm(tuning, SwarmSettings(),
+                     makeOrbitRoutes(SPAWN_POINT, swarmDesc.routes, swarmDesc.minRadius, swarmDesc.maxRadius,
+                                     swarmDesc.minHeight, swarmDesc.maxHeight));
+    swarm.spawn(swarmCount);
+    std::shared_ptr<const CollisionBVH> swarmCollision(&sceneCollision, [](const CollisionBVH*) {});
+    std::vector<uint32_t> swarmMeshes;
+    for (size_t i = 0; swarmModel && i < swarmModel->meshes.size(); i++) swarmMeshes.push_back((uint32_t)i);
+    std::vector<std::vector<glm::mat4>> swarmInstances;    // por nivel de detalle
+    float swarmAccumulator = 0.0f;
+    double swarmStepMs = 0.0;
+    int swarmSteps = 0;
+    if (swarmCount > 0) std::cout << "Enjambre: " << swarmCount << " drones, " << swarmDesc.routes << " rutas" << std::endl;
+
+    // LiDAR: barridos a ritmo fijo en su hilo y su pool, contra la misma BVH
+    // que la física; el bucle solo le pasa la pose de la cámara
+    std::unique_ptr<LidarSensor> lidar;
+    if (options.lidar) {
+        lidar.reset(new LidarSensor(LidarSettings()));
+        lidar->setGeometry(swarmCollision);
+        if (!options.lidarOutput.empty() && !lidar->record(options.lidarOutput)) {
+            std::cout << "Failed to open " << options.lidarOutput << std::endl;
+            return -1;
+        }
+        lidar->start();
+    }
 
-    ExtractData(house, lightsModel);
+    // Zonas alrededor del dron: lo que entra pasa al culling (y su colisión
+    // a la física) y lo que sale se quita.
+    auto streamWorld = [&](const glm::vec3& position, const glm::vec3& velocity, float time) {
+        worldStreamer.update(position, velocity);
+        for (int chunk : worldStreamer.unloaded()) {
+            for (size_t i = 0; i < sceneObjects.size(); i++) {
+                if (sceneObjects[i].chunk != chunk) continue;
+                culler.removeObject(sceneObjects[i].cullId);
+                sceneObjects.erase(sceneObjects.begin() + i);
+                break;
+            }
+        }
+        for (int chunk : worldStreamer.loaded()) {
+            SceneObject object;
+            object.desc = &worldStreamer.desc(chunk);
+            object.model = worldStreamer.model(chunk);
+            object.transform = object.desc->transformAt(time);
+            object.chunk = chunk;
+            object.cullId = culler.addObject(*object.model, object.transform, object.desc->fog);
+            sceneObjects.push_back(object);
+        }
+        if (auto collision = worldStreamer.takeCollision()) {
+            dronePhysics.setCollision(collision);
+            swarmCollision = collision;
+            if (lidar) lidar->setGeometry(collision);
+        }
+    };
 
-    // Shaders HUD
+    // Shaders HUD: una variante por elemento (marco, advertencia, batería)
     const char* hudVS = R"(
         #version 330 core
         layout (location = 0) in vec3 aPos;
@@ -423,74 +589,179 @@ int main() {
         #version 330 core
         out vec4 FragColor;
         in vec2 TexCoords;
-        uniform bool isWarning;
-        uniform bool isText;
-        uniform bool isFrame;
-        uniform bool isTimer;
-        uniform bool isBattery;
         uniform float time;
         uniform sampler2D frameTexture;
         void main() {
-            if(isFrame) {
-                FragColor = texture(frameTexture, TexCoords);
-            } else if(isText) {
-                float flash = sin(time * 6.0) * 0.3 + 0.7;
-                FragColor = vec4(1.0, 1.0, 1.0, flash);
-            } else if(isWarning) {
-                float flash = sin(time * 8.0) * 0.3 + 0.5;
-                FragColor = vec4(0.8, 0.0, 0.0, flash * 0.7);
-            } else if(isTimer) {
-                FragColor = vec4(1.0, 0.2, 0.2, 0.9);
-            } else if(isBattery) {
-                FragColor = vec4(0.2, 1.0, 0.2, 0.9);
-            }
+        #if defined(HUD_FRAME)
+            FragColor = texture(frameTexture, TexCoords);
+        #elif defined(HUD_WARNING)
+            float flash = sin(time * 8.0) * 0.3 + 0.5;
+            FragColor = vec4(0.8, 0.0, 0.0, flash * 0.7);
+        #else
+            FragColor = vec4(0.2, 1.0, 0.2, 0.9);
+        #endif
         }
     )";
 
-    unsigned int vShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vShader, 1, &hudVS, NULL);
-    glCompileShader(vShader);
-    unsigned int fShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fShader, 1, &hudFS, NULL);
-    glCompileShader(fShader);
-    unsigned int hudProgram = glCreateProgram();
-    glAttachShader(hudProgram, vShader);
-    glAttachShader(hudProgram, fShader);
-    glLinkProgram(hudProgram);
-    glDeleteShader(vShader);
-    glDeleteShader(fShader);
+    ShaderVariants hudShaders("hud", hudVS, hudFS,
+                              { { HUD_FRAME, "HUD_FRAME" }, { HUD_WARNING, "HUD_WARNING" }, { HUD_BATTERY, "HUD_BATTERY" } });
+    hudShaders.setProgramSetup([](GLuint program) {
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "frameTexture"), 0);
+    });
+    hudShaders.prepare({ HUD_FRAME, HUD_WARNING, HUD_BATTERY });
+    const GLuint hudFrameProgram = hudShaders.program(HUD_FRAME);
+    const GLuint hudWarningProgram = hudShaders.program(HUD_WARNING);
+    const GLuint hudBatteryProgram = hudShaders.program(HUD_BATTERY);
+    const GLint locTime = glGetUniformLocation(hudWarningProgram, "time");
 
     unsigned int frameQuadVAO = setupQuadVAO();
     unsigned int warningVAO = setupWarningVAO();
-    unsigned int textVAO = setupTextVAO();
-
-    // Cambia esta ruta a tu imagen PNG
-    unsigned int frameTexture = loadTexture("C:/Users/DELL/Documents/Visual Studio 2022/OpenGL/OpenGL/textures/marco.png");
-
-    // Ubicaciones de uniforms
-    std::vector<GLint> lightPosLocs(MAX_LIGHTS), lightColLocs(MAX_LIGHTS), lightIntLocs(MAX_LIGHTS);
-    lightingShader.use();
-    for (int i = 0; i < MAX_LIGHTS; i++) {
-        std::string n = "pointLights[" + std::to_string(i) + "].";
-        lightPosLocs[i] = glGetUniformLocation(lightingShader.ID, (n + "position").c_str());
-        lightColLocs[i] = glGetUniformLocation(lightingShader.ID, (n + "color").c_str());
-        lightIntLocs[i] = glGetUniformLocation(lightingShader.ID, (n + "intensity").c_str());
-    }
 
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / SCR_HEIGHT, 0.1f, 500.0f);
-    glm::vec3 lightColor(1.0f, 0.9f, 0.7f);
+    unsigned int frameTexture = manifest.hudFrame.empty() ? 0 : loadTexture(assets, manifest.hudFrame);
+
+    const float aspect = (float)options.width / (float)options.height;
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 500.0f);
+    glm::vec3 lightColor = manifest.lightColor;
 
-    unsigned int timerVAO = 0;
-    unsigned int batteryVAO = 0;
+    // Luces por clusters: todas las lámparas de la casa, sin límite fijo
+    LightClusters lightClusters;
+    lightClusters.setProjection(glm::radians(45.0f), aspect, 0.1f, 500.0f);
+    std::vector<PointLight> sceneLights(lampPositions.size());
+    for (size_t i = 0; i < lampPositions.size(); i++) {
+        sceneLights[i].position = lampPositions[i];
+        sceneLights[i].color = lightColor;
+    }
+
+    // Cola de dibujo con uniform buffers por frame y por objeto
+    RenderQueue renderQueue;
+
+    // lighting.vs/.fs: un programa por variante, cargado de shader_cache/ si
+    // ya se enlazó en un arranque anterior con el mismo código y driver
+    ShaderVariants lightingShaders("lighting", readShaderFile("shaders/lighting.vs"), readShaderFile("shaders/lighting.fs"),
+                                   { { LIGHTING_THERMAL, "THERMAL_VISION" }, { LIGHTING_EMISSIVE, "EMISSIVE" },
+                                     { LIGHTING_FOG, "FOG" } });
+    lightingShaders.setProgramSetup([&](GLuint program) {
+        lightClusters.setSamplers(program);
+        glUniform1i(glGetUniformLocation(program, "materialLayers"), MATERIAL_ARRAY_UNIT);
+        renderQueue.attach(program);
+    });
+    lightingShaders.prepare({ 0, LIGHTING_FOG, LIGHTING_EMISSIVE, LIGHTING_THERMAL });
+    std::cout << "Shaders: " << lightingShaders.stats.compiled + hudShaders.stats.compiled << " compilados, "
+              << lightingShaders.stats.loadedFromDisk + hudShaders.stats.loadedFromDisk << " desde shader_cache ("
+              << lightingShaders.stats.milliseconds + hudShaders.stats.milliseconds << " ms)" << std::endl;
+
+    // Un buffer persistente por widget: se reescribe, nunca se vuelve a crear
+    HudWidget batteryWidget(BATTERY_MAX_VERTICES);
+    buildBatteryVertices(batteryWidget.begin(), drone.batteryPercent);
+    batteryWidget.commit();
+    float lastBatteryPercent = drone.batteryPercent;
+
+    // Todo el texto del HUD (atlas de glifos, una sola llamada instanciada)
+    TextRenderer hudText;
+    char timerText[16] = "00:00:00", batteryText[16] = "", speedText[32] = "", altitudeText[32] = "", fpsText[16] = "FPS 0";
+    char cameraText[32] = "", lidarText[48] = "";
+    int fpsFrames = 0;
+    float lastFpsUpdate = 0.0f;
     int lastSecond = -1;
     float lastBatteryUpdate = 0.0f;
 
-    while (!glfwWindowShouldClose(window)) {
+    // Sin ventana: todo residente antes de empezar, así cada corrida dibuja lo
+    // mismo y el tiempo de carga incluye la decodificación de texturas.
+    std::unique_ptr<OffscreenTarget> offscreen;
+    CameraPath benchmarkPath;
+    if (options.headless) {
+        textureStreamer.finish();
+        assets.update();
+        staticBatch.updateTextures();
+        offscreen.reset(new OffscreenTarget(options.width, options.height));
+        benchmarkPath = buildBenchmarkPath();
+        float yaw, pitch;
+        glm::vec3 start;
+        benchmarkPath.sample(0.0f, start, yaw, pitch);
+        streamWorld(start, glm::vec3(0.0f), 0.0f);
+        glFinish();
+    }
+    // Profiler por zonas (F3); con --trace queda activo desde el primer frame
+    Profiler profiler;
+    const int zoneStream = profiler.addZone("STREAM");
+    const int zoneInput = profiler.addZone("INPUT", false);
+    const int zoneSwarm = profiler.addZone("SWARM", false);
+    const int zoneLights = profiler.addZone("LIGHTS");
+    const int zoneCull = profiler.addZone("CULL", false);
+    const int zoneOcclusion = profiler.addZone("OCCLUDE", false);
+    const int zoneQueue = profiler.addZone("QUEUE", false);
+    const int zoneDraw = profiler.addZone("DRAW");
+    const int zoneUpscale = profiler.addZone("UPSCALE");
+    const int zoneHud = profiler.addZone("HUD");
+    const int zoneCapture = profiler.addZone("CAPTURE", false);
+    const int zoneSwap = profiler.addZone("SWAP", false);
+    profiler.setEnabled(!options.trace.empty());
+    char profilerLine[48];
+
+    FrameBenchmark benchmark(options.headless ? options.frames : 0);
+    benchmark.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+    std::cout << "Carga de la escena: " << benchmark.loadSeconds << " s" << std::endl;
+    std::cout << "Escena: " << sceneObjects.size() << " modelos cargados, " << pendingObjects.size() << " en cola" << std::endl;
+    if (worldStreamer.chunkCount() > 0) worldStreamer.report(std::cout);
+    assets.report(std::cout);
+    int benchmarkFrame = 0;
+    int renderedFrames = 0;
+
+    // Grabación: readback por PBO con fences y codificación en otro hilo
+    FrameCapture capture;
+    int captureCount = 0;
+    captureToggleRequested = !options.capture.empty();
+
+    // Resolución dinámica: el 3D a la escala que sostiene el presupuesto de GPU, el HUD nativo
+    std::unique_ptr<DynamicResolution> resolution;
+    ResolutionSettings resolutionSettings;
+    resolutionSettings.budgetMs = options.budget >= 0.0f ? options.budget : (options.headless ? 0.0f : DRS_DEFAULT_BUDGET_MS);
+    resolutionSettings.sharpen = options.sharpen;
+    if (resolutionSettings.budgetMs > 0.0f) {
+        resolution.reset(new DynamicResolution(resolutionSettings));
+        std::cout << "Resolución dinámica: " << resolutionSettings.budgetMs << " ms por frame, escala mínima "
+                  << resolutionSettings.minScale << (options.sharpen ? ", con realce" : ", bilineal") << std::endl;
+    }
+    char resolutionText[48] = "";
+    glm::vec3 lastCameraPosition = camera.Position;
+
+    while (options.headless ? (offscreen->valid() && benchmarkFrame < options.frames) : !glfwWindowShouldClose(window)) {
+        if (options.headless) benchmark.beginFrame();
+        profiler.beginFrame();
+
         // --- CÁLCULO DE TIEMPO ---
-        float currentFrame = (float)glfwGetTime();
+        // Sin ventana el tiempo es simulado: recorrido y animaciones no dependen de la máquina
+        float currentFrame = options.headless ? benchmarkFrame * BENCHMARK_FRAME_TIME : (float)glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
+        // Sube las texturas que ya terminaron de decodificarse (sin esperar a las demás)
+        {
+            ProfileZone zone(profiler, zoneStream);
+            textureStreamer.pump();
+            assets.update();
+            staticBatch.updateTextures();
+
+            // Con ventana la velocidad es la del dron; sin ella, la del recorrido
+            glm::vec3 velocity = drone.velocity;
+            if (options.headless)
+                velocity = renderedFrames > 0 ? (camera.Position - lastCameraPosition) / BENCHMARK_FRAME_TIME : glm::vec3(0.0f);
+            lastCameraPosition = camera.Position;
+            streamWorld(camera.Position, velocity, currentFrame);
+
+            // Un prop de la cola por frame, una vez que ya se mostró el primero
+            if (renderedFrames > 0 && !pendingObjects.empty()) {
+                const SceneObjectDesc& desc = *pendingObjects.front();
+                pendingObjects.erase(pendingObjects.begin());
+                SceneObject object;
+                if (loadSceneObject(assets, desc, object)) {
+                    object.cullId = culler.addObject(*object.model, object.transform, desc.fog);
+                    sceneObjects.push_back(object);
+                }
+            }
+        }
+
         // Inicializar tiempo de inicio
         if (drone.startTime == 0.0f) {
             drone.startTime = currentFrame;
@@ -503,195 +774,431 @@ int main() {
             lastBatteryUpdate = currentFrame;
         }
 
-        // Actualizar timer VAO
+        // Actualizar timer
         int elapsedTime = (int)(currentFrame - drone.startTime);
         int currentSecond = elapsedTime % 60;
         if (currentSecond != lastSecond) {
-            if (timerVAO != 0) glDeleteVertexArrays(1, &timerVAO);
             int hours = elapsedTime / 3600;
             int mins = (elapsedTime % 3600) / 60;
             int secs = elapsedTime % 60;
-            timerVAO = createTimerVAO(hours, mins, secs);
+            std::snprintf(timerText, sizeof(timerText), "%02d:%02d:%02d", hours, mins, secs);
             lastSecond = currentSecond;
         }
 
-        // Actualizar batería VAO
-        static float lastBatteryPercent = 100.0f;
+        // Actualizar batería
         if (drone.batteryPercent != lastBatteryPercent) {
-            if (batteryVAO != 0) glDeleteVertexArrays(1, &batteryVAO);
-            batteryVAO = createBatteryVAO(drone.batteryPercent);
+            buildBatteryVertices(batteryWidget.begin(), drone.batteryPercent);
+            batteryWidget.commit();
             lastBatteryPercent = drone.batteryPercent;
         }
-        if (batteryVAO == 0) {
-            batteryVAO = createBatteryVAO(drone.batteryPercent);
+
+        // --- ENJAMBRE (paso fijo; sin ventana, uno por frame simulado) ---
+        if (swarm.size() > 0) {
+            ProfileZone zone(profiler, zoneSwarm);
+            if (options.headless) swarmAccumulator = SWARM_STEP;
+            else swarmAccumulator = std::min(swarmAccumulator + deltaTime, SWARM_STEP * SWARM_MAX_STEPS);
+            while (swarmAccumulator >= SWARM_STEP) {
+                swarm.step(SWARM_STEP, workers, swarmCollision.get());
+                swarmAccumulator -= SWARM_STEP;
+                swarmStepMs += swarm.stats.totalMs();
+                swarmSteps++;
+            }
         }
 
         // --- INPUT Y FÍSICAS ---
-        processInput(window);
-
-        // Verificar distancia (Signal Lost)
-        float dist = glm::length(camera.Position - SPAWN_POINT);
-        if (dist > MAX_DISTANCE) {
-            if (!drone.signalLost) {
-                drone.signalLost = true;
-                drone.signalLostTimer = currentFrame;
-            }
-            if (currentFrame - drone.signalLostTimer > RESPAWN_DELAY) {
-                camera.Position = SPAWN_POINT;
-                drone.velocity = glm::vec3(0.0f);
-                drone.signalLost = false;
-            }
+        ProfileZone inputZone(profiler, zoneInput);
+        if (options.headless) {
+            float yaw, pitch;
+            benchmarkPath.sample((float)benchmarkFrame / (float)std::max(options.frames - 1, 1), camera.Position, yaw, pitch);
+            camera.Yaw = yaw;
+            camera.Pitch = pitch;
+            camera.ProcessMouseMovement(0.0f, 0.0f);    // recalcula Front, Right y Up
         }
         else {
-            drone.signalLost = false;
+            processInput(window, dronePhysics, profiler, swarm.size());
+
+            // Último estado simulado (la pérdida de señal y la reaparición se
+            // resuelven en el hilo de física); la cámara se interpola entre pasos.
+            const DroneSnapshot& sim = dronePhysics.latest();
+            drone.velocity = sim.velocity;
+            drone.signalLost = sim.signalLost;
+            camera.Position = dronePhysics.interpolate(sim, std::chrono::steady_clock::now());
+
+            // Siguiendo a un dron del enjambre: detrás de él, mirando con el mouse
+            if (cameraDrone >= (int)swarm.size()) cameraDrone = -1;
+            if (cameraDrone >= 0) {
+                drone.velocity = swarm.velocity(cameraDrone);
+                drone.signalLost = swarm.signalLost(cameraDrone);
+                camera.Position = swarm.position(cameraDrone) - camera.Front * SWARM_CHASE_DISTANCE;
+            }
         }
+        if (lidar) {
+            LidarPose pose;
+            pose.position = camera.Position;
+            pose.yaw = camera.Yaw;
+            pose.time = currentFrame;
+            lidar->submitPose(pose);
+        }
+        inputZone.end();
 
         // --- RENDERIZADO ---
-        glClearColor(0.01f, 0.01f, 0.02f, 1.0f);
+        int fbWidth = options.width, fbHeight = options.height;
+        if (!options.headless) glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+        // Con resolución dinámica el 3D va al framebuffer escalado y se pasa al final en present()
+        int renderWidth = fbWidth, renderHeight = fbHeight;
+        if (resolution) {
+            resolution->begin(fbWidth, fbHeight);
+            renderWidth = resolution->width();
+            renderHeight = resolution->height();
+        }
+        else if (offscreen) {
+            offscreen->bind();
+        }
+        glClearColor(CLEAR_COLOR.x, CLEAR_COLOR.y, CLEAR_COLOR.z, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // 1. Configuración Global del Shader 3D
-        lightingShader.use();
-        lightingShader.setBool("thermalVision", drone.thermalVision);
-        lightingShader.setBool("isEmissive", false); // Por defecto apagado
-        lightingShader.setMat4("projection", projection);
-        lightingShader.setMat4("view", camera.GetViewMatrix());
-        lightingShader.setVec3("viewPos", camera.Position);
-
-        // 2. Configuración de Luces
-        int numActive = std::min((int)lampPositions.size(), MAX_LIGHTS);
-        float lightIntensity = drone.lightsOn ? 35.0f : 0.0f;
-
-        for (int i = 0; i < numActive; i++) {
-            glUniform3fv(lightPosLocs[i], 1, glm::value_ptr(lampPositions[i]));
-            glUniform3fv(lightColLocs[i], 1, glm::value_ptr(lightColor));
-            glUniform1f(lightIntLocs[i], lightIntensity);
-        }
-        glUniform1i(glGetUniformLocation(lightingShader.ID, "numLights"), numActive);
-
-        // 3. DIBUJAR LA LUNA (Pequeña, lejana y brillante)
-        glm::mat4 moonModel = glm::mat4(1.0f);
-        // Posición: Alta y al fondo
-        moonModel = glm::translate(moonModel, glm::vec3(0.0f, 500.0f, -50.0f));
-        // Escala: Muy pequeña para corregir el tamaño gigante del OBJ original
-        moonModel = glm::scale(moonModel, glm::vec3(0.1f));
-        // Rotación leve
-        moonModel = glm::rotate(moonModel, currentFrame * 0.02f, glm::vec3(0.0f, 1.0f, 0.0f));
-
-        lightingShader.setMat4("model", moonModel);
-
-        // ACTIVAMOS MODO EMISIVO (BRILLO)
-        lightingShader.setBool("isEmissive", true);
-        moon.Draw(lightingShader);
-        // DESACTIVAMOS INMEDIATAMENTE
-        lightingShader.setBool("isEmissive", false);
-
-        // 4. DIBUJAR CASA Y LUCES (Objetos normales)
-        glm::mat4 model = glm::mat4(1.0f);
-        lightingShader.setMat4("model", model);
-        house.Draw(lightingShader);
-        lightsModel.Draw(lightingShader);
-
-        // --- DIBUJAR CAMIONETA (VAN) ---
-        glm::mat4 vanMatrix = glm::mat4(1.0f);
-        lightingShader.setMat4("model", vanMatrix);
-        vanModel.Draw(lightingShader);
-
-        lightingShader.setMat4("model", vanMatrix);
-        vanModel.Draw(lightingShader);
-
-        // --- DIBUJAR FANTASMA 1 ---
-        glm::mat4 ghost1Matrix = glm::mat4(1.0f);
-		ghost1Matrix = glm::translate(ghost1Matrix, glm::vec3(0.0f, 0.5f, 0.0f));
-        ghost1Matrix = glm::translate(ghost1Matrix, glm::vec3(0.0f, sin(currentFrame * 1.5f) * 0.1f, 0.0f));
-        lightingShader.setMat4("model", ghost1Matrix);
-
-        // (Opcional) Si quieres que brille el fantasma, descomenta esto:
-        //lightingShader.setBool("isEmissive", true);
-        ghost1Model.Draw(lightingShader);
-        // lightingShader.setBool("isEmissive", false);
-
-        // --- DIBUJAR FANTASMA 2 ---
-        glm::mat4 ghost2Matrix = glm::mat4(1.0f);
-		ghost2Matrix = glm::translate(ghost2Matrix, glm::vec3(0.0f, 0.7f, 0.0f));
-        ghost2Matrix = glm::translate(ghost2Matrix, glm::vec3(0.0f, cos(currentFrame * 1.5f) * 0.1f, 0.0f));
-        lightingShader.setMat4("model", ghost2Matrix);
-
-        ghost2Model.Draw(lightingShader);
-        // -----------------------------
-
-        // 5. DIBUJAR NUBES
-        model = glm::rotate(glm::mat4(1.0f), currentFrame * 0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
-        lightingShader.setMat4("model", model);
-        clouds.Draw(lightingShader);
+        // 1. Datos por frame (un solo uniform buffer para todo el 3D)
+        glm::mat4 view = camera.GetViewMatrix();
+
+        // 2. Configuración de Luces (asignación a clusters en los hilos de trabajo)
+        {
+            ProfileZone zone(profiler, zoneLights);
+            float lightIntensity = drone.lightsOn ? manifest.lightIntensity : 0.0f;
+            for (auto& light : sceneLights) light.intensity = lightIntensity;
+            lightClusters.update(sceneLights, view, workers);
+            lightClusters.bindBuffers();
+        }
+
+        lodSelector.setViewport(glm::radians(45.0f), renderHeight);
+
+        FrameUniforms frame;
+        frame.projection = projection;
+        frame.view = view;
+        frame.viewPos = glm::vec4(camera.Position, 1.0f);
+        lightClusters.frameParams(renderWidth, renderHeight, frame.clusterDims, frame.clusterParams);
+        renderQueue.begin(frame);
+
+        // Culling: frustum de la cámara + horizonte de la niebla (sin niebla en
+        // visión térmica). Los objetos animados (luna, fantasmas, nubes)
+        // recalculan su transformación.
+        {
+            ProfileZone zone(profiler, zoneCull);
+            for (auto& object : sceneObjects) {
+                if (!object.desc->animated()) continue;
+                object.transform = object.desc->transformAt(currentFrame);
+                culler.setTransform(object.cullId, object.transform);
+            }
+            culler.cull(projection, view, camera.Position, !drone.thermalVision);
+        }
+        // Oclusión: rasteriza los oclusores en los hilos de trabajo y saca lo que tapan
+        if (!occlusion.empty()) {
+            ProfileZone zone(profiler, zoneOcclusion);
+            occlusion.render(projection * view, workers);
+            culler.refine([&](const glm::vec3& mn, const glm::vec3& mx) { return occlusion.visible(mn, mx); });
+        }
+
+        // 3. ENCOLAR LO VISIBLE (la cola ordena por shader -> texturas -> VAO)
+        ProfileZone queueZone(profiler, zoneQueue);
+        // Casa y luces: el culling escribe directamente los comandos del lote estático
+        // (iluminados y con niebla: el lote no separa por material)
+        staticBatch.beginFrame();
+        for (const auto& object : sceneObjects)
+            if (object.batchId >= 0) staticBatch.gather(object.batchId, culler.visibleMeshes(object.cullId));
+        int staticObject = renderQueue.addObject(glm::mat4(1.0f), true);
+        const GLuint staticProgram = lightingShaders.program(lightingVariant(drone.thermalVision, false, true));
+        for (const auto& batch : staticBatch.endFrame())
+            renderQueue.submitMultiDraw(staticProgram, staticBatch.vertexArray(), batch.arrayTexture, *batch.commands, staticObject);
+
+        // El resto, uno por uno (los emisivos como la luna ignoran la niebla y las luces)
+        for (const auto& object : sceneObjects) {
+            if (object.batchId >= 0) continue;
+            const SceneObjectDesc& desc = *object.desc;
+            renderQueue.submit(lightingShaders.program(lightingVariant(drone.thermalVision, desc.emissive, desc.fog)),
+                               *object.model, culler.visibleMeshes(object.cullId), renderQueue.addObject(object.transform),
+                               lodSelector.select(object.cullId, *object.model, object.transform, camera.Position));
+        }
+
+        // Enjambre: cada dron se descarta contra el frustum y el resto se agrupa
+        // por nivel de detalle; cada grupo es un solo dibujo instanciado por malla
+        if (swarmModel && swarm.size() > 0) {
+            const SceneModel& model = *swarmModel;
+            const float radius = glm::length(model.boundsMax - model.boundsMin) * 0.5f * swarmDesc.scale;
+            const glm::mat4 recenter = glm::translate(glm::mat4(1.0f), -(model.boundsMin + model.boundsMax) * 0.5f);
+            Frustum frustum;
+            frustum.extract(projection * view);
+            swarmInstances.resize(std::max(model.lodLevels(), 1));
+            for (auto& group : swarmInstances) group.clear();
+            for (size_t i = 0; i < swarm.size(); i++) {
+                if ((int)i == cameraDrone) continue;
+                glm::vec3 p = swarm.position(i);
+                if (!frustum.intersects(p - glm::vec3(radius), p + glm::vec3(radius))) continue;
+                int level = lodSelector.levelAt(model, swarmDesc.scale, glm::length(p - camera.Position) - radius);
+                swarmInstances[level].push_back(swarm.transform(i, swarmDesc.scale) * recenter);
+            }
+            const GLuint swarmProgram = lightingShaders.program(lightingVariant(drone.thermalVision, false, true));
+            for (size_t level = 0; level < swarmInstances.size(); level++) {
+                const auto& group = swarmInstances[level];
+                if (group.empty()) continue;
+                renderQueue.submit(swarmProgram, model, swarmMeshes, renderQueue.addInstances(group.data(), (int)group.size()),
+                                   (int)level);
+            }
+        }
+
+        queueZone.end();
+
+        // 4. DIBUJAR TODO
+        {
+            ProfileZone zone(profiler, zoneDraw);
+            renderQueue.flush();
+        }
+        // Escalado al tamaño nativo (bilineal + realce) antes del HUD
+        if (resolution) {
+            ProfileZone zone(profiler, zoneUpscale);
+            resolution->present(offscreen ? offscreen->framebuffer() : 0);
+        }
+
+        // Estadísticas promedio por segundo en el título de la ventana
+        cullTotals.meshesTested += culler.stats.meshesTested;
+        cullTotals.meshesVisible += culler.stats.meshesVisible;
+        cullTotals.meshesOccluded += culler.stats.meshesOccluded;
+        drawTotals.drawCalls += renderQueue.stats.drawCalls;
+        stateTotals += renderQueue.stats.stateChanges();
+        legacyStateTotals += renderQueue.legacyStats.stateChanges();
+        statFrames++;
+        if (!options.headless && currentFrame - lastStatReport >= 1.0f && statFrames > 0) {
+            std::string title = "Drone Simulation | mallas visibles " +
+                std::to_string(cullTotals.meshesVisible / statFrames) + "/" +
+                std::to_string(cullTotals.meshesTested / statFrames) + " probadas (" +
+                std::to_string(culler.totalMeshes()) + " total, ocluidas " +
+                std::to_string((int)std::lround(cullTotals.occludedFraction() * 100.0f)) + "%) | draws " +
+                std::to_string(drawTotals.drawCalls / statFrames) + " | cambios de estado " +
+                std::to_string(stateTotals / statFrames) + " (antes " +
+                std::to_string(legacyStateTotals / statFrames) + ") | zonas " +
+                std::to_string(worldStreamer.residentCount()) + "/" + std::to_string(worldStreamer.chunkCount()) + " | VRAM " +
+                std::to_string(assets.usedBytes() / (1024 * 1024)) + " MB";
+            if (resolution)
+                title += " | resolución " + std::to_string((int)std::lround(resolution->scale() * 100.0f)) + "% " +
+                         resolution->stateName();
+            glfwSetWindowTitle(window, title.c_str());
+            cullTotals = CullStats();
+            drawTotals = RenderStats();
+            stateTotals = legacyStateTotals = 0;
+            statFrames = 0;
+            lastStatReport = currentFrame;
+        }
 
         // --- HUD (INTERFAZ 2D) ---
+        ProfileZone hudZone(profiler, zoneHud);
         glDisable(GL_DEPTH_TEST);
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        glUseProgram(hudProgram);
-        GLint locFrame = glGetUniformLocation(hudProgram, "isFrame");
-        GLint locWarning = glGetUniformLocation(hudProgram, "isWarning");
-        GLint locText = glGetUniformLocation(hudProgram, "isText");
-        GLint locTime = glGetUniformLocation(hudProgram, "time");
-        GLint locTimer = glGetUniformLocation(hudProgram, "isTimer");
-        GLint locBattery = glGetUniformLocation(hudProgram, "isBattery");
-
         // Marco
-        glUniform1i(locFrame, true);
-        glUniform1i(locWarning, false);
-        glUniform1i(locText, false);
-        glUniform1i(locTimer, false);
-        glUniform1i(locBattery, false);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, frameTexture);
-        glUniform1i(glGetUniformLocation(hudProgram, "frameTexture"), 0);
-        glBindVertexArray(frameQuadVAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-        // Timer
-        if (timerVAO != 0) {
-            glUniform1i(locFrame, false);
-            glUniform1i(locTimer, true);
-            glBindVertexArray(timerVAO);
-            glLineWidth(2.0f);
-            glDrawArrays(GL_LINES, 0, 200);
+        if (frameTexture) {
+            glUseProgram(hudFrameProgram);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, frameTexture);
+            glBindVertexArray(frameQuadVAO);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
         }
 
         // Batería
-        if (batteryVAO != 0) {
-            glUniform1i(locTimer, false);
-            glUniform1i(locBattery, true);
-            glBindVertexArray(batteryVAO);
-            glLineWidth(2.5f);
-            glDrawArrays(GL_LINES, 0, 100);
-        }
+        glUseProgram(hudBatteryProgram);
+        glLineWidth(2.5f);
+        batteryWidget.draw(GL_LINES);
 
         // Advertencia (Signal Lost)
         if (drone.signalLost) {
-            glUniform1i(locBattery, false);
+            glUseProgram(hudWarningProgram);
             glUniform1f(locTime, currentFrame);
-
-            glUniform1i(locWarning, true);
             glBindVertexArray(warningVAO);
             glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        }
 
-            glUniform1i(locWarning, false);
-            glUniform1i(locText, true);
-            glBindVertexArray(textVAO);
-            glLineWidth(2.5f);
-            glDrawArrays(GL_LINES, 0, 100);
+        // Texto: timer, batería, telemetría y SIGNAL LOST
+        fpsFrames++;
+        if (currentFrame - lastFpsUpdate >= 0.5f) {
+            std::snprintf(fpsText, sizeof(fpsText), "FPS %d", (int)(fpsFrames / (currentFrame - lastFpsUpdate) + 0.5f));
+            fpsFrames = 0;
+            lastFpsUpdate = currentFrame;
+        }
+        std::snprintf(batteryText, sizeof(batteryText), "%d%%", (int)drone.batteryPercent);
+        std::snprintf(speedText, sizeof(speedText), "SPD %.1f M/S", glm::length(drone.velocity));
+        std::snprintf(altitudeText, sizeof(altitudeText), "ALT %.1f M", camera.Position.y);
+
+        const glm::vec4 timerColor(1.0f, 0.2f, 0.2f, 0.9f);
+        const glm::vec4 batteryColor(0.2f, 1.0f, 0.2f, 0.9f);
+        const glm::vec4 telemetryColor(0.8f, 0.9f, 1.0f, 0.9f);
+        hudText.begin((float)fbWidth / (float)std::max(fbHeight, 1));
+        hudText.add(timerText, 0.60f, -0.70f, 0.04f, timerColor);
+        hudText.add(batteryText, -0.75f, 0.71f, 0.04f, batteryColor);
+        hudText.add(speedText, -0.85f, -0.70f, 0.035f, telemetryColor);
+        hudText.add(altitudeText, -0.85f, -0.76f, 0.035f, telemetryColor);
+        hudText.add(fpsText, -0.85f, -0.82f, 0.035f, telemetryColor);
+        if (cameraDrone >= 0) {
+            std::snprintf(cameraText, sizeof(cameraText), "CAM DRONE %d/%d", cameraDrone + 1, (int)swarm.size());
+            hudText.add(cameraText, -0.85f, -0.88f, 0.035f, telemetryColor);
+        }
+        if (capture.active()) hudText.add("REC", 0.60f, -0.76f, 0.04f, timerColor);
+        if (resolution) {
+            float gpuMs = resolution->gpuMilliseconds();
+            std::snprintf(resolutionText, sizeof(resolutionText), "RES %d%% %dX%d GPU %.1f/%.0f MS %s",
+                          (int)std::lround(resolution->scale() * 100.0f), renderWidth, renderHeight,
+                          gpuMs >= 0.0f ? gpuMs : 0.0f, resolution->budgetMilliseconds(), resolution->stateName());
+            hudText.add(resolutionText, 0.30f, -0.88f, 0.035f, telemetryColor);
+        }
+        if (lidar) {
+            if (const LidarScan* scan = lidar->latest())
+                std::snprintf(lidarText, sizeof(lidarText), "LIDAR %u/%zu PTS %.1f MS", scan->hits, scan->points.size(),
+                              scan->milliseconds);
+            hudText.add(lidarText, 0.30f, -0.82f, 0.035f, telemetryColor);
+        }
+        if (drone.signalLost) {
+            const char* lost = "SIGNAL LOST";
+            hudText.add(lost, -hudText.measure(lost, 0.06f) * 0.5f, -0.03f, 0.06f, glm::vec4(1.0f), 6.0f);
+        }
+
+        // Panel del profiler: promedio de los últimos frames por zona
+        if (profiler.active()) {
+            const glm::vec4 profilerColor(1.0f, 0.85f, 0.3f, 0.9f);
+            float y = 0.86f;
+            hudText.add("ZONE     CPU MS  GPU MS", 0.30f, y, 0.03f, profilerColor);
+            for (int z = 0; z < profiler.zoneCount(); z++) {
+                double cpuMs, gpuMs;
+                profiler.averages(z, cpuMs, gpuMs);
+                y -= 0.045f;
+                if (gpuMs >= 0.0)
+                    std::snprintf(profilerLine, sizeof(profilerLine), "%-7s %7.2f %7.2f", profiler.zoneName(z), cpuMs, gpuMs);
+                else
+                    std::snprintf(profilerLine, sizeof(profilerLine), "%-7s %7.2f       -", profiler.zoneName(z), cpuMs);
+                hudText.add(profilerLine, 0.30f, y, 0.03f, profilerColor);
+            }
         }
+        hudText.draw(currentFrame);
 
         glBindVertexArray(0);
         glDisable(GL_BLEND);
         glEnable(GL_DEPTH_TEST);
+        hudZone.end();
+
+        // --- GRABACIÓN (antes del swap; no espera a la GPU) ---
+        {
+            ProfileZone zone(profiler, zoneCapture);
+            if (captureToggleRequested) {
+                captureToggleRequested = false;
+                if (capture.active()) {
+                    capture.stop();
+                    std::cout << "Captura: " << capture.stats.written << " frames en " << capture.path() << ", "
+                              << capture.stats.dropped() << " perdidos" << std::endl;
+                }
+                else {
+                    char capturePath[32];
+                    std::snprintf(capturePath, sizeof(capturePath), "capture_%03d.y4m", ++captureCount);
+                    std::string path = options.capture.empty() || captureCount > 1 ? capturePath : options.capture;
+                    if (!capture.start(path, fbWidth, fbHeight, CAPTURE_FPS))
+                        std::cout << "Failed to open " << path << std::endl;
+                }
+            }
+            capture.capture(offscreen ? offscreen->framebuffer() : 0, fbWidth, fbHeight);
+        }
+        if (resolution) resolution->end();
+
+        if (options.headless) {
+            benchmark.endFrame(renderQueue.stats.drawCalls, renderQueue.stats.triangles, culler.stats.meshesVisible,
+                               culler.stats.meshesOccluded, resolution ? resolution->scale() : 1.0f);
+            glFlush();
+            benchmarkFrame++;
+        }
+        else {
+            ProfileZone zone(profiler, zoneSwap);
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        profiler.endFrame();
+        renderedFrames++;
+    }
+
+    int result = 0;
+    if (options.headless) {
+        benchmark.finish();
+        std::vector<double> cpu, gpu, scales;
+        double occluded = 0.0;
+        for (const auto& s : benchmark.frames()) {
+            cpu.push_back(s.cpuMs);
+            gpu.push_back(s.gpuMs);
+            scales.push_back(s.renderScale);
+            occluded += s.occludedFraction();
+        }
+        std::cout << "Benchmark: " << benchmark.frames().size() << " frames, CPU p50 "
+                  << FrameBenchmark::percentile(cpu, 50.0) << " ms / p95 " << FrameBenchmark::percentile(cpu, 95.0)
+                  << " ms, GPU p50 " << FrameBenchmark::percentile(gpu, 50.0) << " ms / p95 "
+                  << FrameBenchmark::percentile(gpu, 95.0) << " ms, occluded "
+                  << 100.0 * occluded / std::max<size_t>(benchmark.frames().size(), 1) << "% of meshes" << std::endl;
+        if (resolution)
+            std::cout << "Resolución dinámica: escala p50 " << FrameBenchmark::percentile(scales, 50.0) * 100.0
+                      << "% / p5 " << FrameBenchmark::percentile(scales, 5.0) * 100.0 << "%, estado final "
+                      << resolution->stateName() << std::endl;
+        if (!offscreen->valid() ||
+            !benchmark.writeCsv(options.output + ".csv") || !benchmark.writeJson(options.output + ".json")) {
+            std::cout << "Failed to write benchmark results to " << options.output << std::endl;
+            result = -1;
+        }
+    }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    if (capture.active()) {
+        capture.stop();
+        const CaptureStats& c = capture.stats;
+        std::cout << "Captura: " << c.written << " frames en " << capture.path() << ", " << c.dropped() << " perdidos ("
+                  << c.droppedBusy << " con el PBO en vuelo, " << c.droppedQueue << " con la cola llena), lectura "
+                  << c.readbackMs / std::max<uint64_t>(c.captured + c.dropped(), 1) << " ms/frame, codificación "
+                  << c.encodeMs / std::max<uint64_t>(c.written, 1) << " ms/frame" << std::endl;
+    }
+    if (lidar) {
+        lidar->stop();
+        uint64_t scans = lidar->scanCount();
+        std::cout << "LiDAR: " << scans << " barridos, "
+                  << (scans > 0 ? lidar->pointsPerScan() * scans / (lidar->tracedMilliseconds() * 1000.0) : 0.0)
+                  << " Mrayos/s" << std::endl;
+    }
+    if (swarmSteps > 0)
+        std::cout << "Enjambre: " << swarm.size() << " drones, " << swarmStepMs / swarmSteps << " ms por paso" << std::endl;
+
+    if (!options.trace.empty()) {
+        if (profiler.writeChromeTrace(options.trace)) std::cout << "Traza guardada en " << options.trace << std::endl;
+        else result = -1;
+    }
+
+    glDeleteVertexArrays(1, &frameQuadVAO);
+    glDeleteVertexArrays(1, &warningVAO);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    LaunchOptions options;
+    if (!parseLaunchOptions(argc, argv, options)) return -1;
+
+    GLFWwindow* window = nullptr;
+    if (options.headless) {
+        window = createHeadlessContext();
+        if (!window) return -1;
+    }
+    else {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        window = glfwCreateWindow(options.width, options.height, "Drone Simulation", nullptr, nullptr);
+        if (!window) { glfwTerminate(); return -1; }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) { glfwTerminate(); return -1; }
     }
 
+    int result = runSimulation(window, options);
     glfwTerminate();
-    return 0;
+    return result;
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include "scene_cache.h"
+#include "gpu_resources.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Administrador de assets del proceso: modelos, texturas y geometría se piden
+// aquí y se cargan una sola vez. Los modelos se identifican por su ruta
+// canónica y se entregan como ModelHandle (shared_ptr); el resto se comparte
+// a través de GpuResources. Si la memoria de GPU pasa del presupuesto se
+// liberan, del más viejo al más nuevo, los modelos y recursos que ya nadie usa.
+
+const size_t ASSET_DEFAULT_BUDGET = 1536u * 1024u * 1024u;     // bytes de texturas + geometría
+
+typedef std::shared_ptr<SceneModel> ModelHandle;
+
+class AssetCache {
+public:
+    explicit AssetCache(TextureStreamer* streamer = nullptr, size_t budgetBytes = ASSET_DEFAULT_BUDGET)
+        : resources(streamer), streamer(streamer), budget(budgetBytes) {
+        options.textures = streamer;
+        options.resources = &resources;
+    }
+    AssetCache(const AssetCache&) = delete;
+    AssetCache& operator=(const AssetCache&) = delete;
+
+    // El mismo modelo para todas las rutas que llevan al mismo archivo.
+    ModelHandle acquireModel(const std::string& path) {
+        const std::string key = canonicalAssetPath(path);
+        auto it = models.find(key);
+        if (it != models.end()) {
+            it->second.lastUse = ++clock;
+            modelHits++;
+            return it->second.model;
+        }
+        ModelEntry entry;
+        entry.model = std::make_shared<SceneModel>(path, options);
+        entry.lastUse = ++clock;
+        models[key] = entry;
+        enforceBudget();
+        return entry.model;
+    }
+
+    // Textura suelta (HUD); se devuelve con releaseTexture.
+    unsigned int acquireTexture(const std::string& path, bool flipVertically = false, GLint wrap = GL_REPEAT) {
+        unsigned int texture = resources.acquireTexture(path, flipVertically, wrap);
+        enforceBudget();
+        return texture;
+    }
+
+    void releaseTexture(unsigned int texture) { resources.releaseTexture(texture); }
+
+    // Una vez por frame, después de TextureStreamer::pump(): las texturas
+    // recién subidas empiezan a contar en el presupuesto y las que resultaron
+    // copias de otra se reemplazan por ella en los modelos.
+    void update() {
+        if (!streamer || streamer->completedUploads() == seenUploads) return;
+        seenUploads = streamer->completedUploads();
+        resources.mergeDuplicates();
+        enforceBudget();
+    }
+
+    void setBudget(size_t bytes) {
+        budget = bytes;
+        enforceBudget();
+    }
+    size_t budgetBytes() const { return budget; }
+    size_t usedBytes() { return resources.totalBytes(); }
+    size_t modelCount() const { return models.size(); }
+    GpuResources& gpu() { return resources; }
+    const SceneLoadOptions& loadOptions() const { return options; }
+
+    void report(std::ostream& out) {
+        out << "Assets: " << usedBytes() / (1024 * 1024) << " MB de " << budget / (1024 * 1024) << " MB" << std::endl;
+        out << "Modelos: " << models.size() << " (" << modelHits << " reutilizados)" << std::endl;
+        for (const auto& entry : models)
+            out << "  [" << entry.second.model.use_count() - 1 << "] " << entry.second.model->geometryBytes() / 1024
+                << " KB  " << entry.second.model->path() << std::endl;
+        resources.report(out);
+    }
+
+private:
+    struct ModelEntry {
+        ModelHandle model;
+        uint64_t lastUse = 0;
+    };
+
+    // 'resources' se declara antes que 'models': los modelos se destruyen
+    // primero y devuelven sus referencias a un registro que todavía existe.
+    GpuResources resources;
+    std::unordered_map<std::string, ModelEntry> models;
+    TextureStreamer* streamer;
+    SceneLoadOptions options;
+    size_t budget;
+    uint64_t clock = 0;
+    uint64_t modelHits = 0;
+    uint64_t seenUploads = 0;
+    bool overBudget = false;
+
+    void enforceBudget() {
+        size_t used = resources.totalBytes();
+        while (used > budget) {
+            // Primero los recursos huérfanos; si no alcanza, el modelo sin usuarios más viejo
+            used -= resources.trim(budget);
+            if (used <= budget) break;
+            auto oldest = models.end();
+            for (auto it = models.begin(); it != models.end(); ++it)
+                if (it->second.model.use_count() == 1 && (oldest == models.end() || it->second.lastUse < oldest->second.lastUse))
+                    oldest = it;
+            if (oldest == models.end()) break;
+            models.erase(oldest);
+        }
+        if (used > budget && !overBudget)
+            std::cout << "ASSETS::OVER_BUDGET " << used / (1024 * 1024) << " MB de " << budget / (1024 * 1024) << " MB" << std::endl;
+        overBudget = used > budget;
+    }
+};
+
+#endif
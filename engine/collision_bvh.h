@@ -0,0 +1,357 @@
+#ifndef COLLISION_BVH_H
+#define COLLISION_BVH_H
+
+#include <glm/glm.hpp>
+
+#include "scene_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Colisión del dron contra los triángulos reales de la escena. Los triángulos
+// se organizan en una BVH construida con SAH (binned) y guardada como un
+// arreglo plano de nodos de 32 bytes; las consultas de esfera recorren solo
+// las ramas que la tocan, así que el costo crece de forma logarítmica.
+
+const int BVH_BINS = 16;
+const int BVH_MAX_LEAF = 8;
+const int BVH_MAX_DEPTH = 60;        // la pila de recorrido tiene 64 entradas
+const float BVH_TRAVERSAL_COST = 1.0f;
+
+struct CollisionTriangle {
+    glm::vec3 v0, v1, v2;
+};
+
+// Hoja: count > 0 y leftFirst es el primer triángulo.
+// Interno: count == 0 y leftFirst es el hijo izquierdo (el derecho va a continuación).
+struct BvhNode {
+    glm::vec3 boundsMin;
+    uint32_t leftFirst;
+    glm::vec3 boundsMax;
+    uint32_t count;
+
+    bool isLeaf() const { return count > 0; }
+};
+
+struct SphereContact {
+    glm::vec3 point;     // punto más cercano sobre el triángulo
+    glm::vec3 normal;    // de la superficie hacia el centro de la esfera
+    float depth;         // penetración
+};
+
+// Punto más cercano de p sobre el triángulo abc (Ericson, Real-Time Collision Detection 5.1.5).
+inline glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+    float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+    glm::vec3 bp = p - b;
+    float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) return b;
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return a + ab * (d1 / (d1 - d3));
+
+    glm::vec3 cp = p - c;
+    float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) return c;
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return a + ac * (d2 / (d2 - d6));
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+inline float sphereBoxDistance2(const glm::vec3& center, const glm::vec3& bmin, const glm::vec3& bmax) {
+    glm::vec3 q = glm::clamp(center, bmin, bmax);
+    glm::vec3 d = center - q;
+    return glm::dot(d, d);
+}
+
+class CollisionBVH {
+public:
+    std::vector<BvhNode> nodes;
+    std::vector<CollisionTriangle> triangles;
+
+    void clear() {
+        nodes.clear();
+        triangles.clear();
+    }
+
+    // Añade los triángulos de las mallas transformados por 'transform'.
+    void addMeshes(const std::vector<SceneMesh>& meshes, const glm::mat4& transform = glm::mat4(1.0f)) {
+        for (const auto& mesh : meshes) {
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+                CollisionTriangle tri;
+                tri.v0 = glm::vec3(transform * glm::vec4(mesh.vertices[mesh.indices[i]].Position, 1.0f));
+                tri.v1 = glm::vec3(transform * glm::vec4(mesh.vertices[mesh.indices[i + 1]].Position, 1.0f));
+                tri.v2 = glm::vec3(transform * glm::vec4(mesh.vertices[mesh.indices[i + 2]].Position, 1.0f));
+                triangles.push_back(tri);
+            }
+        }
+    }
+
+    void build() {
+        nodes.clear();
+        if (triangles.empty()) return;
+
+        const size_t n = triangles.size();
+        indices.resize(n);
+        centroids.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            indices[i] = (uint32_t)i;
+            centroids[i] = (triangles[i].v0 + triangles[i].v1 + triangles[i].v2) * (1.0f / 3.0f);
+        }
+
+        nodes.reserve(2 * n);
+        BvhNode root;
+        root.leftFirst = 0;
+        root.count = (uint32_t)n;
+        nodes.push_back(root);
+        updateBounds(0);
+
+        std::vector<std::pair<uint32_t, int>> stack = { { 0u, 0 } };
+        while (!stack.empty()) {
+            uint32_t nodeIdx = stack.back().first;
+            int depth = stack.back().second;
+            stack.pop_back();
+            if (depth < BVH_MAX_DEPTH && subdivide(nodeIdx)) {
+                stack.push_back({ nodes[nodeIdx].leftFirst, depth + 1 });
+                stack.push_back({ nodes[nodeIdx].leftFirst + 1, depth + 1 });
+            }
+        }
+
+        // Reordena los triángulos para que cada hoja lea memoria contigua.
+        std::vector<CollisionTriangle> ordered(n);
+        for (size_t i = 0; i < n; i++) ordered[i] = triangles[indices[i]];
+        triangles.swap(ordered);
+        nodes.shrink_to_fit();
+        indices.clear(); indices.shrink_to_fit();
+        centroids.clear(); centroids.shrink_to_fit();
+    }
+
+    // Llama a onTriangle(const CollisionTriangle&) por cada triángulo cuya hoja
+    // toca la esfera. Devuelve el número de nodos visitados.
+    template <typename Callback>
+    int querySphere(const glm::vec3& center, float radius, Callback onTriangle) const {
+        if (nodes.empty()) return 0;
+        const float r2 = radius * radius;
+        uint32_t stack[64];
+        int top = 0, visited = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const BvhNode& node = nodes[stack[--top]];
+            visited++;
+            if (sphereBoxDistance2(center, node.boundsMin, node.boundsMax) > r2) continue;
+            if (node.isLeaf()) {
+                for (uint32_t i = 0; i < node.count; i++) onTriangle(triangles[node.leftFirst + i]);
+            }
+            else {
+                stack[top++] = node.leftFirst;
+                stack[top++] = node.leftFirst + 1;
+            }
+        }
+        return visited;
+    }
+
+    // Contacto más profundo entre la esfera y la geometría (false si no hay).
+    bool deepestContact(const glm::vec3& center, float radius, SphereContact& out) const {
+        bool hit = false;
+        out.depth = 0.0f;
+        querySphere(center, radius, [&](const CollisionTriangle& tri) {
+            glm::vec3 q = closestPointOnTriangle(center, tri.v0, tri.v1, tri.v2);
+            glm::vec3 d = center - q;
+            float dist2 = glm::dot(d, d);
+            if (dist2 >= radius * radius) return;
+            float dist = std::sqrt(dist2);
+            float depth = radius - dist;
+            if (hit && depth <= out.depth) return;
+
+            glm::vec3 normal;
+            if (dist > 1e-6f) {
+                normal = d / dist;
+            }
+            else {
+                // El centro está sobre el plano: se usa la normal geométrica.
+                glm::vec3 faceNormal = glm::cross(tri.v1 - tri.v0, tri.v2 - tri.v0);
+                float len = glm::length(faceNormal);
+                normal = len > 0.0f ? faceNormal / len : glm::vec3(0.0f, 1.0f, 0.0f);
+            }
+            out.point = q;
+            out.normal = normal;
+            out.depth = depth;
+            hit = true;
+        });
+        return hit;
+    }
+
+    bool overlapsSphere(const glm::vec3& center, float radius) const {
+        SphereContact contact;
+        return deepestContact(center, radius, contact);
+    }
+
+    // Mueve la esfera 'displacement' deslizándose sobre las superficies:
+    // se avanza en subpasos de medio radio (sin túneles) y en cada uno se
+    // empuja la esfera fuera de las penetraciones, quitando a la velocidad
+    // solo la componente que va contra la superficie.
+    glm::vec3 moveSphere(const glm::vec3& start, const glm::vec3& displacement, float radius, glm::vec3& velocity) const {
+        const int MAX_ITERATIONS = 4;
+        float distance = glm::length(displacement);
+        int steps = std::max(1, (int)std::ceil(distance / (radius * 0.5f)));
+        steps = std::min(steps, 64);
+        glm::vec3 step = displacement / (float)steps;
+
+        glm::vec3 position = start;
+        for (int s = 0; s < steps; s++) {
+            position += step;
+            for (int it = 0; it < MAX_ITERATIONS; it++) {
+                SphereContact contact;
+                if (!deepestContact(position, radius, contact)) break;
+                position += contact.normal * (contact.depth + 1e-4f);
+                float into = glm::dot(velocity, contact.normal);
+                if (into < 0.0f) velocity -= contact.normal * into;
+                float stepInto = glm::dot(step, contact.normal);
+                if (stepInto < 0.0f) step -= contact.normal * stepInto;
+            }
+        }
+        return position;
+    }
+
+    size_t nodeCount() const { return nodes.size(); }
+    size_t triangleCount() const { return triangles.size(); }
+
+private:
+    std::vector<uint32_t> indices;
+    std::vector<glm::vec3> centroids;
+
+    static float area(const glm::vec3& bmin, const glm::vec3& bmax) {
+        glm::vec3 e = bmax - bmin;
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+
+    void updateBounds(uint32_t nodeIdx) {
+        BvhNode& node = nodes[nodeIdx];
+        node.boundsMin = glm::vec3(1e30f);
+        node.boundsMax = glm::vec3(-1e30f);
+        for (uint32_t i = 0; i < node.count; i++) {
+            const CollisionTriangle& tri = triangles[indices[node.leftFirst + i]];
+            node.boundsMin = glm::min(node.boundsMin, glm::min(tri.v0, glm::min(tri.v1, tri.v2)));
+            node.boundsMax = glm::max(node.boundsMax, glm::max(tri.v0, glm::max(tri.v1, tri.v2)));
+        }
+    }
+
+    struct Bin {
+        glm::vec3 boundsMin = glm::vec3(1e30f);
+        glm::vec3 boundsMax = glm::vec3(-1e30f);
+        uint32_t count = 0;
+    };
+
+    void growBin(Bin& bin, const CollisionTriangle& tri) {
+        bin.boundsMin = glm::min(bin.boundsMin, glm::min(tri.v0, glm::min(tri.v1, tri.v2)));
+        bin.boundsMax = glm::max(bin.boundsMax, glm::max(tri.v0, glm::max(tri.v1, tri.v2)));
+        bin.count++;
+    }
+
+    // Devuelve true si el nodo se dividió.
+    bool subdivide(uint32_t nodeIdx) {
+        BvhNode node = nodes[nodeIdx];
+        if (node.count <= 2) return false;
+
+        glm::vec3 cmin(1e30f), cmax(-1e30f);
+        for (uint32_t i = 0; i < node.count; i++) {
+            cmin = glm::min(cmin, centroids[indices[node.leftFirst + i]]);
+            cmax = glm::max(cmax, centroids[indices[node.leftFirst + i]]);
+        }
+
+        int bestAxis = -1;
+        int bestSplit = 0;
+        float bestCost = 1e30f;
+        for (int axis = 0; axis < 3; axis++) {
+            float extent = cmax[axis] - cmin[axis];
+            if (extent <= 0.0f) continue;
+            Bin bins[BVH_BINS];
+            float scale = BVH_BINS / extent;
+            for (uint32_t i = 0; i < node.count; i++) {
+                uint32_t t = indices[node.leftFirst + i];
+                int b = std::min(BVH_BINS - 1, (int)((centroids[t][axis] - cmin[axis]) * scale));
+                growBin(bins[b], triangles[t]);
+            }
+
+            // Barrido de izquierda a derecha y de derecha a izquierda.
+            float leftArea[BVH_BINS - 1], rightArea[BVH_BINS - 1];
+            uint32_t leftCount[BVH_BINS - 1], rightCount[BVH_BINS - 1];
+            Bin left, right;
+            for (int i = 0; i < BVH_BINS - 1; i++) {
+                left.count += bins[i].count;
+                left.boundsMin = glm::min(left.boundsMin, bins[i].boundsMin);
+                left.boundsMax = glm::max(left.boundsMax, bins[i].boundsMax);
+                leftCount[i] = left.count;
+                leftArea[i] = left.count ? area(left.boundsMin, left.boundsMax) : 0.0f;
+
+                int j = BVH_BINS - 1 - i;
+                right.count += bins[j].count;
+                right.boundsMin = glm::min(right.boundsMin, bins[j].boundsMin);
+                right.boundsMax = glm::max(right.boundsMax, bins[j].boundsMax);
+                rightCount[j - 1] = right.count;
+                rightArea[j - 1] = right.count ? area(right.boundsMin, right.boundsMax) : 0.0f;
+            }
+            for (int i = 0; i < BVH_BINS - 1; i++) {
+                if (leftCount[i] == 0 || rightCount[i] == 0) continue;
+                float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = i;
+                }
+            }
+        }
+
+        float parentArea = area(node.boundsMin, node.boundsMax);
+        float leafCost = node.count * parentArea;
+        float splitCost = BVH_TRAVERSAL_COST * parentArea + bestCost;
+        if (bestAxis < 0 || (splitCost >= leafCost && node.count <= BVH_MAX_LEAF)) return false;
+
+        // Partición en sitio según el bin elegido.
+        float scale = BVH_BINS / (cmax[bestAxis] - cmin[bestAxis]);
+        uint32_t i = node.leftFirst;
+        uint32_t j = node.leftFirst + node.count - 1;
+        while (i <= j) {
+            int b = std::min(BVH_BINS - 1, (int)((centroids[indices[i]][bestAxis] - cmin[bestAxis]) * scale));
+            if (b <= bestSplit) {
+                i++;
+            }
+            else {
+                std::swap(indices[i], indices[j]);
+                if (j == 0) break;
+                j--;
+            }
+        }
+        uint32_t leftCount = i - node.leftFirst;
+        if (leftCount == 0 || leftCount == node.count) return false;
+
+        uint32_t leftIdx = (uint32_t)nodes.size();
+        BvhNode leftNode, rightNode;
+        leftNode.leftFirst = node.leftFirst;
+        leftNode.count = leftCount;
+        rightNode.leftFirst = i;
+        rightNode.count = node.count - leftCount;
+        nodes.push_back(leftNode);
+        nodes.push_back(rightNode);
+        updateBounds(leftIdx);
+        updateBounds(leftIdx + 1);
+
+        nodes[nodeIdx].leftFirst = leftIdx;
+        nodes[nodeIdx].count = 0;
+        return true;
+    }
+};
+
+#endif
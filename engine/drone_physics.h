@@ -0,0 +1,212 @@
+#ifndef DRONE_PHYSICS_H
+#define DRONE_PHYSICS_H
+
+#include <glm/glm.hpp>
+
+#include "collision_bvh.h"
+#include "triple_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// Simulación del dron en un hilo propio a paso fijo (240 Hz por defecto) con
+// acumulador. El hilo de render publica la entrada en un triple buffer y lee
+// el último estado simulado de otro, interpolando entre los dos últimos pasos;
+// así el vuelo es idéntico a cualquier FPS y la física sigue aunque la GPU
+// sea el cuello de botella.
+
+const double PHYSICS_RATE = 240.0;
+const double PHYSICS_MAX_CATCHUP = 0.25;    // segundos simulados como máximo por iteración
+
+struct DroneTuning {
+    float acceleration = 35.0f;
+    float friction = 0.94f;         // factor por frame a FRICTION_REFERENCE_HZ
+    float maxSpeed = 12.0f;
+    float radius = 0.3f;
+    float maxDistance = 100.0f;
+    float respawnDelay = 2.0f;
+    glm::vec3 spawnPoint = glm::vec3(0.0f);
+};
+
+// La fricción original se aplicaba una vez por frame a ~60 FPS.
+const float FRICTION_REFERENCE_HZ = 60.0f;
+
+struct DroneInput {
+    glm::vec3 direction = glm::vec3(0.0f);  // dirección deseada en mundo (sin normalizar)
+    bool ghostMode = false;                 // atraviesa la geometría
+};
+
+struct DroneSnapshot {
+    glm::vec3 previousPosition = glm::vec3(0.0f);
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 velocity = glm::vec3(0.0f);
+    bool signalLost = false;
+    double simTime = 0.0;
+    uint64_t step = 0;
+    std::chrono::steady_clock::time_point stepTime;   // instante real en que se calculó 'position'
+};
+
+// --- PASO DE SIMULACIÓN (determinista, sin estado global) ---
+struct DroneBody {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 velocity = glm::vec3(0.0f);
+    bool signalLost = false;
+    double signalLostSince = 0.0;
+};
+
+// Devuelve true si el dron reapareció en este paso.
+inline bool stepDrone(DroneBody& body, const DroneInput& input, const DroneTuning& tuning,
+                      const CollisionBVH* collision, double simTime, float dt) {
+    if (glm::length(input.direction) > 0.0f)
+        body.velocity += glm::normalize(input.direction) * tuning.acceleration * dt;
+
+    if (glm::length(body.velocity) > tuning.maxSpeed)
+        body.velocity = glm::normalize(body.velocity) * tuning.maxSpeed;
+
+    body.velocity *= std::pow(tuning.friction, dt * FRICTION_REFERENCE_HZ);
+    glm::vec3 displacement = body.velocity * dt;
+
+    if (input.ghostMode || !collision)
+        body.position += displacement;
+    else
+        body.position = collision->moveSphere(body.position, displacement, tuning.radius, body.velocity);
+
+    // Pérdida de señal lejos del punto de salida y reaparición tras la espera
+    float dist = glm::length(body.position - tuning.spawnPoint);
+    if (dist > tuning.maxDistance) {
+        if (!body.signalLost) {
+            body.signalLost = true;
+            body.signalLostSince = simTime;
+        }
+        if (simTime - body.signalLostSince > tuning.respawnDelay) {
+            body.position = tuning.spawnPoint;
+            body.velocity = glm::vec3(0.0f);
+            body.signalLost = false;
+            return true;
+        }
+    }
+    else {
+        body.signalLost = false;
+    }
+    return false;
+}
+
+// --- HILO DE FÍSICA ---
+class DronePhysics {
+public:
+    // 'collision' no pasa a ser del hilo de física: tiene que vivir más que él.
+    DronePhysics(const DroneTuning& tuning, const CollisionBVH* collision, double rate = PHYSICS_RATE)
+        : tuning(tuning), collision(collision, [](const CollisionBVH*) {}), dt(1.0 / rate) {}
+
+    ~DronePhysics() { stop(); }
+    DronePhysics(const DronePhysics&) = delete;
+    DronePhysics& operator=(const DronePhysics&) = delete;
+
+    void start(const glm::vec3& position) {
+        stop();
+        DroneSnapshot initial;
+        initial.previousPosition = initial.position = position;
+        initial.stepTime = std::chrono::steady_clock::now();
+        snapshots.back() = initial;
+        snapshots.publish();
+        body = DroneBody();
+        body.position = position;
+        running = true;
+        worker = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        running = false;
+        if (worker.joinable()) worker.join();
+    }
+
+    // Hilo de render: entrada del frame actual.
+    void submitInput(const DroneInput& input) {
+        inputs.back() = input;
+        inputs.publish();
+    }
+
+    // Hilo de render: último estado publicado.
+    const DroneSnapshot& latest() {
+        snapshots.update();
+        return snapshots.front();
+    }
+
+    // Posición interpolada entre los dos últimos pasos de 's' para el instante 'now'.
+    glm::vec3 interpolate(const DroneSnapshot& s, std::chrono::steady_clock::time_point now) const {
+        double alpha = std::chrono::duration<double>(now - s.stepTime).count() / dt;
+        alpha = std::min(1.0, std::max(0.0, alpha));
+        return glm::mix(s.previousPosition, s.position, (float)alpha);
+    }
+
+    double stepSeconds() const { return dt; }
+
+    // Cualquier hilo: cambia la geometría de colisión (p. ej. al cargar o
+    // descargar zonas). El hilo de física la toma en su siguiente iteración y
+    // la BVH anterior se libera cuando ya nadie la usa.
+    void setCollision(std::shared_ptr<const CollisionBVH> bvh) {
+        std::atomic_store(&collision, std::move(bvh));
+    }
+
+private:
+    DroneTuning tuning;
+    std::shared_ptr<const CollisionBVH> collision;     // se lee y escribe con atomic_load/atomic_store
+    double dt;
+    DroneBody body;
+    std::atomic<bool> running{ false };
+    std::thread worker;
+    TripleBuffer<DroneInput> inputs;
+    TripleBuffer<DroneSnapshot> snapshots;
+
+    void run() {
+        using Clock = std::chrono::steady_clock;
+        const auto stepDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dt));
+        double simTime = 0.0, accumulator = 0.0;
+        uint64_t step = 0;
+        auto last = Clock::now();
+
+        while (running) {
+            auto now = Clock::now();
+            accumulator += std::chrono::duration<double>(now - last).count();
+            accumulator = std::min(accumulator, PHYSICS_MAX_CATCHUP);
+            last = now;
+
+            inputs.update();
+            const DroneInput& input = inputs.front();
+            std::shared_ptr<const CollisionBVH> bvh = std::atomic_load(&collision);
+
+            bool stepped = false, respawned = false;
+            glm::vec3 previous = body.position;
+            while (accumulator >= dt) {
+                previous = body.position;
+                simTime += dt;
+                respawned = stepDrone(body, input, tuning, bvh.get(), simTime, (float)dt);
+                accumulator -= dt;
+                step++;
+                stepped = true;
+            }
+
+            if (stepped) {
+                DroneSnapshot& out = snapshots.back();
+                // Tras una reaparición no se interpola desde la posición lejana.
+                out.previousPosition = respawned ? body.position : previous;
+                out.position = body.position;
+                out.velocity = body.velocity;
+                out.signalLost = body.signalLost;
+                out.simTime = simTime;
+                out.step = step;
+                out.stepTime = now;
+                snapshots.publish();
+            }
+
+            std::this_thread::sleep_until(now + stepDuration);
+        }
+    }
+};
+
+#endif
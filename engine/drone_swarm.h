@@ -0,0 +1,339 @@
+#ifndef DRONE_SWARM_H
+#define DRONE_SWARM_H
+
+#include <glm/glm.hpp>
+
+#include "collision_bvh.h"
+#include "drone_physics.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DRONE_SWARM_SSE 1
+#include <emmintrin.h>
+#endif
+
+// Enjambre de drones autónomos que recorren rutas cerradas de waypoints. El
+// estado va en SoA (px[], py[], ... contiguos) y cada paso tiene cuatro fases:
+//   1. rejilla hash de celdas de 'separationRadius' (orden por conteo);
+//   2. dirección de cada dron en los hilos del pool: hacia su waypoint más la
+//      separación de los vecinos de las 27 celdas alrededor;
+//   3. velocidad (aceleración, tope de velocidad y fricción) de 4 en 4 con SSE;
+//   4. movimiento con la BVH de colisión (solo cerca de la geometría), batería
+//      y las mismas reglas de pérdida de señal y reaparición que stepDrone.
+// Todo es determinista: el resultado no depende de la cantidad de hilos.
+
+struct SwarmSettings {
+    float separationRadius = 1.5f;      // distancia a la que los drones se empujan
+    float separationWeight = 2.0f;      // peso de la separación frente al waypoint
+    float arrivalRadius = 2.0f;         // a esta distancia se pasa al siguiente waypoint
+    float batteryDrain = 1.0f / 6.0f;   // % por segundo, como el dron del jugador
+};
+
+// Ruta cerrada: después del último waypoint se vuelve al primero.
+struct SwarmRoute {
+    std::vector<glm::vec3> waypoints;
+};
+
+struct SwarmStats {
+    double gridMs = 0.0;
+    double steerMs = 0.0;
+    double integrateMs = 0.0;
+    double resolveMs = 0.0;
+    int respawned = 0;                  // en el último paso
+    int signalLost = 0;
+
+    double totalMs() const { return gridMs + steerMs + integrateMs + resolveMs; }
+};
+
+// 'count' órbitas alrededor de 'center' con radios y alturas repartidos en los
+// rangos dados, de 'points' waypoints cada una y sentido alternado.
+inline std::vector<SwarmRoute> makeOrbitRoutes(const glm::vec3& center, int count, float minRadius, float maxRadius,
+                                               float minHeight, float maxHeight, int points = 8) {
+    std::vector<SwarmRoute> routes(std::max(count, 1));
+    for (size_t r = 0; r < routes.size(); r++) {
+        float t = routes.size() > 1 ? (float)r / (float)(routes.size() - 1) : 0.0f;
+        float radius = minRadius + (maxRadius - minRadius) * t;
+        float height = minHeight + (maxHeight - minHeight) * (float)((r * 7) % routes.size()) / (float)routes.size();
+        float direction = (r % 2) ? -1.0f : 1.0f;
+        for (int p = 0; p < points; p++) {
+            float angle = direction * 6.2831853f * (float)p / (float)points + (float)r;
+            routes[r].waypoints.push_back(center + glm::vec3(std::cos(angle) * radius, height, std::sin(angle) * radius));
+        }
+    }
+    return routes;
+}
+
+class DroneSwarm {
+public:
+    SwarmStats stats;
+
+    DroneSwarm(const DroneTuning& tuning, const SwarmSettings& settings, std::vector<SwarmRoute> routes)
+        : tuning(tuning), settings(settings), routes(std::move(routes)) {}
+
+    // Reparte 'count' drones entre las rutas, cada uno en un waypoint distinto
+    // y con la batería escalonada para que no vuelvan todos juntos.
+    void spawn(size_t count, uint32_t seed = 1) {
+        for (auto* v : { &px, &py, &pz, &vx, &vy, &vz, &ax, &ay, &az, &battery })
+            v->assign(count, 0.0f);
+        lostSince.assign(count, -1.0);
+        route.assign(count, 0);
+        waypoint.assign(count, 0);
+        if (routes.empty()) return;
+        for (size_t i = 0; i < count; i++) {
+            uint32_t h = hash((uint32_t)i ^ seed);
+            route[i] = (uint32_t)(i % routes.size());
+            const auto& points = routes[route[i]].waypoints;
+            waypoint[i] = h % (uint32_t)points.size();
+            glm::vec3 p = points[waypoint[i]] + jitter(h) * settings.separationRadius * 2.0f;
+            px[i] = p.x;
+            py[i] = p.y;
+            pz[i] = p.z;
+            battery[i] = 50.0f + (float)(h % 5000) / 100.0f;
+        }
+    }
+
+    // Un paso de 'dt' segundos. 'collision' puede ser nula (sin geometría).
+    void step(float dt, ThreadPool& pool, const CollisionBVH* collision) {
+        using Clock = std::chrono::steady_clock;
+        const size_t n = size();
+        simTime += dt;
+        if (n == 0) return;
+
+        auto t0 = Clock::now();
+        buildGrid();
+        auto t1 = Clock::now();
+        pool.parallelFor(n, [&](size_t begin, size_t end) { steer(begin, end); }, STEER_CHUNK);
+        auto t2 = Clock::now();
+        pool.parallelFor(n, [&](size_t begin, size_t end) { integrate(begin, end, dt); }, INTEGRATE_CHUNK);
+        auto t3 = Clock::now();
+        std::atomic<int> respawned{ 0 }, lost{ 0 };
+        pool.parallelFor(n, [&](size_t begin, size_t end) {
+            int r = 0, l = 0;
+            resolve(begin, end, dt, collision, r, l);
+            respawned += r;
+            lost += l;
+        }, RESOLVE_CHUNK);
+        auto t4 = Clock::now();
+
+        auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+        stats.gridMs = ms(t0, t1);
+        stats.steerMs = ms(t1, t2);
+        stats.integrateMs = ms(t2, t3);
+        stats.resolveMs = ms(t3, t4);
+        stats.respawned = respawned;
+        stats.signalLost = lost;
+    }
+
+    size_t size() const { return px.size(); }
+    glm::vec3 position(size_t i) const { return glm::vec3(px[i], py[i], pz[i]); }
+    glm::vec3 velocity(size_t i) const { return glm::vec3(vx[i], vy[i], vz[i]); }
+    float batteryPercent(size_t i) const { return battery[i]; }
+    bool signalLost(size_t i) const { return lostSince[i] >= 0.0; }
+
+    // Matriz del dron 'i' mirando hacia donde vuela (+Z del modelo), escalada por 'scale'.
+    glm::mat4 transform(size_t i, float scale) const {
+        glm::vec3 forward(vx[i], 0.0f, vz[i]);
+        float len = glm::length(forward);
+        forward = len > 1e-3f ? forward / len : glm::vec3(0.0f, 0.0f, 1.0f);
+        glm::vec3 right(forward.z, 0.0f, -forward.x);
+        glm::mat4 m(1.0f);
+        m[0] = glm::vec4(right * scale, 0.0f);
+        m[1] = glm::vec4(0.0f, scale, 0.0f, 0.0f);
+        m[2] = glm::vec4(forward * scale, 0.0f);
+        m[3] = glm::vec4(position(i), 1.0f);
+        return m;
+    }
+
+private:
+    static const size_t STEER_CHUNK = 256;
+    static const size_t INTEGRATE_CHUNK = 4096;
+    static const size_t RESOLVE_CHUNK = 128;
+
+    DroneTuning tuning;
+    SwarmSettings settings;
+    std::vector<SwarmRoute> routes;
+    double simTime = 0.0;
+
+    // Estado SoA
+    std::vector<float> px, py, pz, vx, vy, vz;
+    std::vector<float> ax, ay, az;          // aceleración decidida en steer()
+    std::vector<float> battery;
+    std::vector<double> lostSince;          // < 0: con señal
+    std::vector<uint32_t> route, waypoint;
+
+    // Rejilla hash: los drones de la celda c son cellDrones[cellStart[c] .. cellStart[c + 1])
+    std::vector<uint32_t> cellOf, cellStart, cellFill, cellDrones;
+    uint32_t cellMask = 0;
+
+    static uint32_t hash(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x7feb352dU;
+        x ^= x >> 15;
+        x *= 0x846ca68bU;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // Desplazamiento en [-0.5, 0.5]^3 derivado de 'h'.
+    static glm::vec3 jitter(uint32_t h) {
+        return glm::vec3((float)(h & 0xff), (float)((h >> 8) & 0xff), (float)((h >> 16) & 0xff)) / 255.0f - 0.5f;
+    }
+
+    int cellCoord(float v) const { return (int)std::floor(v / settings.separationRadius); }
+
+    uint32_t cellHash(int x, int y, int z) const {
+        return ((uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)z * 83492791u) & cellMask;
+    }
+
+    void buildGrid() {
+        const size_t n = size();
+        size_t cells = 1;
+        while (cells < n * 2) cells <<= 1;
+        cellMask = (uint32_t)cells - 1;
+        cellOf.resize(n);
+        cellStart.assign(cells + 1, 0);
+        cellDrones.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            cellOf[i] = cellHash(cellCoord(px[i]), cellCoord(py[i]), cellCoord(pz[i]));
+            cellStart[cellOf[i] + 1]++;
+        }
+        for (size_t c = 0; c < cells; c++) cellStart[c + 1] += cellStart[c];
+        cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+        for (size_t i = 0; i < n; i++) cellDrones[cellFill[cellOf[i]]++] = (uint32_t)i;
+    }
+
+    void steer(size_t begin, size_t end) {
+        const float r = settings.separationRadius, r2 = r * r;
+        for (size_t i = begin; i < end; i++) {
+            const glm::vec3 p(px[i], py[i], pz[i]);
+            const auto& points = routes[route[i]].waypoints;
+            glm::vec3 toTarget = points[waypoint[i]] - p;
+            if (glm::dot(toTarget, toTarget) < settings.arrivalRadius * settings.arrivalRadius) {
+                waypoint[i] = (waypoint[i] + 1) % (uint32_t)points.size();
+                toTarget = points[waypoint[i]] - p;
+            }
+            float distance = glm::length(toTarget);
+            glm::vec3 direction = distance > 1e-4f ? toTarget / distance : glm::vec3(0.0f);
+
+            // Separación: empuje lineal, máximo con los drones encimados y nulo a 'r'
+            glm::vec3 push(0.0f);
+            uint32_t visited[27];
+            int visitedCount = 0;
+            const int cx = cellCoord(p.x), cy = cellCoord(p.y), cz = cellCoord(p.z);
+            for (int dz = -1; dz <= 1; dz++)
+                for (int dy = -1; dy <= 1; dy++)
+                    for (int dx = -1; dx <= 1; dx++) {
+                        uint32_t c = cellHash(cx + dx, cy + dy, cz + dz);
+                        if (std::find(visited, visited + visitedCount, c) != visited + visitedCount) continue;
+                        visited[visitedCount++] = c;
+                        for (uint32_t k = cellStart[c]; k < cellStart[c + 1]; k++) {
+                            uint32_t j = cellDrones[k];
+                            if (j == i) continue;
+                            glm::vec3 d(p.x - px[j], p.y - py[j], p.z - pz[j]);
+                            float d2 = glm::dot(d, d);
+                            if (d2 >= r2) continue;
+                            float dist = std::sqrt(d2);
+                            // Dos drones en el mismo punto se separan según su índice
+                            glm::vec3 away = dist > 1e-4f ? d / dist : (i < j ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(-1.0f, 0.0f, 0.0f));
+                            push += away * (1.0f - dist / r);
+                        }
+                    }
+
+            // Igual que stepDrone: aceleración constante en la dirección deseada
+            glm::vec3 desired = direction + push * settings.separationWeight;
+            float len = glm::length(desired);
+            glm::vec3 a = len > 1e-4f ? desired * (tuning.acceleration / len) : glm::vec3(0.0f);
+            ax[i] = a.x;
+            ay[i] = a.y;
+            az[i] = a.z;
+        }
+    }
+
+    // v += a * dt; tope de velocidad; fricción. Mismo orden de operaciones en SSE y en escalar.
+    void integrate(size_t begin, size_t end, float dt) {
+        const float maxSpeed = tuning.maxSpeed, maxSpeed2 = maxSpeed * maxSpeed;
+        const float friction = std::pow(tuning.friction, dt * FRICTION_REFERENCE_HZ);
+        size_t i = begin;
+#ifdef DRONE_SWARM_SSE
+        const __m128 dt4 = _mm_set1_ps(dt), max2 = _mm_set1_ps(maxSpeed2), max4 = _mm_set1_ps(maxSpeed);
+        const __m128 friction4 = _mm_set1_ps(friction);
+        for (; i + 4 <= end; i += 4) {
+            __m128 x = _mm_add_ps(_mm_loadu_ps(&vx[i]), _mm_mul_ps(_mm_loadu_ps(&ax[i]), dt4));
+            __m128 y = _mm_add_ps(_mm_loadu_ps(&vy[i]), _mm_mul_ps(_mm_loadu_ps(&ay[i]), dt4));
+            __m128 z = _mm_add_ps(_mm_loadu_ps(&vz[i]), _mm_mul_ps(_mm_loadu_ps(&az[i]), dt4));
+            __m128 s2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+            __m128 fast = _mm_cmpgt_ps(s2, max2);
+            __m128 clamp = _mm_div_ps(max4, _mm_sqrt_ps(_mm_max_ps(s2, max2)));
+            __m128 scale = _mm_mul_ps(_mm_or_ps(_mm_and_ps(fast, clamp), _mm_andnot_ps(fast, _mm_set1_ps(1.0f))), friction4);
+            _mm_storeu_ps(&vx[i], _mm_mul_ps(x, scale));
+            _mm_storeu_ps(&vy[i], _mm_mul_ps(y, scale));
+            _mm_storeu_ps(&vz[i], _mm_mul_ps(z, scale));
+        }
+#endif
+        for (; i < end; i++) {
+            float x = vx[i] + ax[i] * dt, y = vy[i] + ay[i] * dt, z = vz[i] + az[i] * dt;
+            float s2 = x * x + y * y + z * z;
+            float scale = (s2 > maxSpeed2 ? maxSpeed / std::sqrt(s2) : 1.0f) * friction;
+            vx[i] = x * scale;
+            vy[i] = y * scale;
+            vz[i] = z * scale;
+        }
+    }
+
+    // Movimiento, batería y pérdida de señal. La BVH solo se consulta si la
+    // esfera barrida toca la caja de la raíz: la mayoría vuela lejos de la casa.
+    void resolve(size_t begin, size_t end, float dt, const CollisionBVH* collision, int& respawned, int& lost) {
+        const bool collide = collision && !collision->nodes.empty();
+        const glm::vec3 sceneMin = collide ? collision->nodes[0].boundsMin : glm::vec3(0.0f);
+        const glm::vec3 sceneMax = collide ? collision->nodes[0].boundsMax : glm::vec3(0.0f);
+        const float maxDistance2 = tuning.maxDistance * tuning.maxDistance;
+        for (size_t i = begin; i < end; i++) {
+            glm::vec3 p(px[i], py[i], pz[i]), v(vx[i], vy[i], vz[i]);
+            glm::vec3 displacement = v * dt;
+            float reach = tuning.radius + glm::length(displacement);
+            if (collide && distanceToBox2(p, sceneMin, sceneMax) < reach * reach) {
+                p = collision->moveSphere(p, displacement, tuning.radius, v);
+                vx[i] = v.x;
+                vy[i] = v.y;
+                vz[i] = v.z;
+            }
+            else {
+                p += displacement;
+            }
+
+            battery[i] = std::max(0.0f, battery[i] - settings.batteryDrain * dt);
+            glm::vec3 fromSpawn = p - tuning.spawnPoint;
+            bool far = glm::dot(fromSpawn, fromSpawn) > maxDistance2;
+            if (far && lostSince[i] < 0.0) lostSince[i] = simTime;
+            else if (!far) lostSince[i] = -1.0;
+
+            // Sin señal pasada la espera, o sin batería: vuelve al punto de salida cargado
+            bool expired = lostSince[i] >= 0.0 && simTime - lostSince[i] > tuning.respawnDelay;
+            if (expired || battery[i] <= 0.0f) {
+                p = tuning.spawnPoint + jitter(hash((uint32_t)i + (uint32_t)(simTime * 1000.0))) * settings.separationRadius * 4.0f;
+                vx[i] = vy[i] = vz[i] = 0.0f;
+                battery[i] = 100.0f;
+                lostSince[i] = -1.0;
+                respawned++;
+            }
+            if (lostSince[i] >= 0.0) lost++;
+            px[i] = p.x;
+            py[i] = p.y;
+            pz[i] = p.z;
+        }
+    }
+
+    static float distanceToBox2(const glm::vec3& p, const glm::vec3& mn, const glm::vec3& mx) {
+        glm::vec3 d = glm::max(glm::max(mn - p, p - mx), glm::vec3(0.0f));
+        return glm::dot(d, d);
+    }
+};
+
+#endif
@@ -0,0 +1,288 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <glad/glad.h>
+
+#include "shader_variants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Resolución dinámica: el 3D se dibuja en un framebuffer propio, en un
+// rectángulo de scale() x el tamaño de la ventana, y se escala al tamaño
+// nativo antes del HUD (que siempre queda nítido). Un controlador lee el
+// tiempo de GPU del frame completo (dos marcas glQueryCounter, leídas
+// DRS_QUERY_LATENCY frames después sin esperar, como el profiler) y mueve la
+// escala para acercarse al presupuesto:
+//   - el costo del 3D crece con el área, así que la escala nueva es
+//     escala * sqrt(presupuesto / medido);
+//   - solo decide con DRS_SETTLE_SAMPLES mediciones hechas a la escala actual
+//     (las que siguen en vuelo son de la anterior);
+//   - baja en cuanto se pasa del presupuesto y sube solo con DRS_HEADROOM de
+//     margen y de a DRS_MAX_STEP_UP, para no oscilar.
+// La textura y la profundidad se reservan al tamaño nativo: cambiar la escala
+// solo cambia el viewport, nunca reasigna memoria.
+// Nota: las marcas incluyen la GPU ociosa esperando a la CPU dentro del
+// frame; con la CPU como cuello de botella la escala también baja.
+
+const float DRS_DEFAULT_BUDGET_MS = 14.0f;
+const float DRS_MIN_SCALE = 0.5f;           // por eje: como mínimo un cuarto de los píxeles
+const float DRS_HEADROOM = 0.15f;           // sube solo si el frame usa menos del 85% del presupuesto
+const float DRS_MAX_STEP_UP = 0.05f;
+const float DRS_MAX_STEP_DOWN = 0.15f;
+const float DRS_SHARPNESS = 0.35f;
+const int DRS_QUERY_LATENCY = 4;            // frames en vuelo antes de leer sus marcas
+const int DRS_SETTLE_SAMPLES = 3;           // mediciones a la escala actual antes de decidir
+const int DRS_WARMUP_FRAMES = 30;           // carga de shaders y texturas: no se decide
+const int DRS_ALIGN = 8;                    // el tamaño escalado va en múltiplos de 8 píxeles
+const uint32_t DRS_SHARPEN = 1;             // variante del shader de escalado con realce
+
+enum class ResolutionState { Warmup, Hold, Down, Up, Min };
+
+struct ResolutionSettings {
+    float budgetMs = DRS_DEFAULT_BUDGET_MS;
+    float minScale = DRS_MIN_SCALE;
+    bool sharpen = true;                    // false: solo bilineal
+};
+
+class DynamicResolution {
+public:
+    explicit DynamicResolution(const ResolutionSettings& settings = ResolutionSettings())
+        : config(settings), shaders("resolution", BLIT_VS, BLIT_FS, { { DRS_SHARPEN, "SHARPEN" } }) {
+        config.minScale = std::min(std::max(config.minScale, 0.1f), 1.0f);
+        glGenFramebuffers(1, &fbo);
+        glGenTextures(1, &color);
+        glGenRenderbuffers(1, &depth);
+        glGenQueries(DRS_QUERY_LATENCY * 2, queries);
+        createPrograms();
+    }
+
+    ~DynamicResolution() {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteTextures(1, &color);
+        glDeleteRenderbuffers(1, &depth);
+        glDeleteQueries(DRS_QUERY_LATENCY * 2, queries);
+        glDeleteVertexArrays(1, &vao);
+    }
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // Al empezar el 3D: ajusta la escala con las mediciones que ya llegaron,
+    // marca el inicio del frame y deja activo el framebuffer escalado.
+    void begin(int nativeWidth, int nativeHeight) {
+        if (nativeWidth != texWidth || nativeHeight != texHeight) allocate(nativeWidth, nativeHeight);
+        collect();
+        glQueryCounter(queries[slot * 2], GL_TIMESTAMP);
+        slotScale[slot] = currentScale;
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, renderW, renderH);
+    }
+
+    // Escala la imagen al framebuffer 'target' (0 = la ventana) y deja ese
+    // framebuffer activo con el viewport nativo, listo para el HUD.
+    void present(GLuint target) {
+        const bool depthTest = glIsEnabled(GL_DEPTH_TEST) == GL_TRUE;
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+        glViewport(0, 0, texWidth, texHeight);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+
+        // A escala 1 cada píxel cae en el centro de un texel: copia exacta
+        const bool sharpen = config.sharpen && (renderW != texWidth || renderH != texHeight);
+        glUseProgram(shaders.program(sharpen ? DRS_SHARPEN : 0));
+        glUniform2f(uvScaleLocation[sharpen ? 1 : 0], (float)renderW / texWidth, (float)renderH / texHeight);
+        glUniform2f(texelLocation[sharpen ? 1 : 0], 1.0f / texWidth, 1.0f / texHeight);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, color);
+        glBindVertexArray(vao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        if (depthTest) glEnable(GL_DEPTH_TEST);
+    }
+
+    // Al final del frame (después del HUD): marca el fin del tiempo medido.
+    void end() {
+        glQueryCounter(queries[slot * 2 + 1], GL_TIMESTAMP);
+        pending[slot] = true;
+        slot = (slot + 1) % DRS_QUERY_LATENCY;
+        frames++;
+    }
+
+    float scale() const { return currentScale; }
+    int width() const { return renderW; }
+    int height() const { return renderH; }
+    float budgetMilliseconds() const { return config.budgetMs; }
+    // Promedio de las mediciones a la escala actual; -1 si todavía no hay.
+    float gpuMilliseconds() const { return samples > 0 ? averageMs : -1.0f; }
+    ResolutionState state() const { return controllerState; }
+
+    const char* stateName() const {
+        switch (controllerState) {
+        case ResolutionState::Warmup: return "WARMUP";
+        case ResolutionState::Down: return "DOWN";
+        case ResolutionState::Up: return "UP";
+        case ResolutionState::Min: return "MIN";
+        default: return "HOLD";
+        }
+    }
+
+private:
+    ResolutionSettings config;
+    ShaderVariants shaders;                 // 0: bilineal, DRS_SHARPEN: bilineal + realce
+    GLuint fbo = 0, color = 0, depth = 0, vao = 0;
+    GLint uvScaleLocation[2] = { -1, -1 }, texelLocation[2] = { -1, -1 };
+    int texWidth = 0, texHeight = 0;        // tamaño nativo (el de la textura)
+    int renderW = 0, renderH = 0;           // rectángulo que se dibuja este frame
+
+    GLuint queries[DRS_QUERY_LATENCY * 2] = {};
+    bool pending[DRS_QUERY_LATENCY] = {};
+    float slotScale[DRS_QUERY_LATENCY] = {};
+    int slot = 0;
+    long long frames = 0;
+
+    float currentScale = 1.0f;
+    float averageMs = 0.0f;
+    int samples = 0;                        // mediciones a currentScale
+    ResolutionState controllerState = ResolutionState::Warmup;
+
+    void allocate(int width, int height) {
+        texWidth = std::max(width, 1);
+        texHeight = std::max(height, 1);
+        glBindTexture(GL_TEXTURE_2D, color);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texWidth, texHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, texWidth, texHeight);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "Dynamic resolution framebuffer incomplete" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        applyScale(currentScale);
+    }
+
+    void applyScale(float s) {
+        currentScale = s;
+        if (s >= 1.0f) {
+            renderW = texWidth;
+            renderH = texHeight;
+        }
+        else {
+            auto aligned = [](int native, float s) {
+                int size = (int)std::lround(native * s / DRS_ALIGN) * DRS_ALIGN;
+                return std::min(std::max(size, DRS_ALIGN), native);
+            };
+            renderW = aligned(texWidth, s);
+            renderH = aligned(texHeight, s);
+        }
+        samples = 0;
+    }
+
+    // Lee el frame que usó este hueco hace DRS_QUERY_LATENCY frames; si la GPU
+    // todavía no lo terminó se descarta en vez de esperar.
+    void collect() {
+        if (!pending[slot]) return;
+        pending[slot] = false;
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return;
+        GLuint64 start = 0, stop = 0;
+        glGetQueryObjectui64v(queries[slot * 2], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(queries[slot * 2 + 1], GL_QUERY_RESULT, &stop);
+        if (slotScale[slot] != currentScale) return;        // medido a otra escala
+        float ms = (float)((double)(stop - start) / 1.0e6);
+        averageMs = samples == 0 ? ms : averageMs * 0.75f + ms * 0.25f;
+        samples++;
+        decide();
+    }
+
+    void decide() {
+        if (frames < DRS_WARMUP_FRAMES) {
+            controllerState = ResolutionState::Warmup;
+            return;
+        }
+        if (samples < DRS_SETTLE_SAMPLES || config.budgetMs <= 0.0f) return;
+
+        const bool over = averageMs > config.budgetMs;
+        const float wanted = currentScale * std::sqrt(config.budgetMs / std::max(averageMs, 0.01f));
+        float next = currentScale;
+        if (over)
+            next = std::max(wanted, currentScale - DRS_MAX_STEP_DOWN);
+        else if (averageMs < config.budgetMs * (1.0f - DRS_HEADROOM))
+            next = std::min(wanted, currentScale + DRS_MAX_STEP_UP);
+        next = std::min(std::max(next, config.minScale), 1.0f);
+
+        if (next < currentScale) controllerState = ResolutionState::Down;
+        else if (next > currentScale) controllerState = ResolutionState::Up;
+        else controllerState = over ? ResolutionState::Min : ResolutionState::Hold;
+
+        // Un cambio menor que la alineación no cambia los píxeles: no se toca
+        int oldW = renderW, oldH = renderH;
+        float old = currentScale;
+        applyScale(next);
+        if (renderW == oldW && renderH == oldH) {
+            currentScale = old;
+            samples = DRS_SETTLE_SAMPLES;
+            if (controllerState != ResolutionState::Min) controllerState = ResolutionState::Hold;
+        }
+    }
+
+    // Triángulo que cubre la pantalla y lee solo el rectángulo dibujado. El
+    // realce compara el texel con sus cuatro vecinos y limita el resultado al
+    // rango de ellos (sin halos en los bordes).
+    static constexpr const char* BLIT_VS = R"(
+        #version 330 core
+        out vec2 uv;
+        void main() {
+            uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+            gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+        }
+    )";
+    static constexpr const char* BLIT_FS = R"(
+        #version 330 core
+        in vec2 uv;
+        out vec4 color;
+        uniform sampler2D source;
+        uniform vec2 uvScale;       // parte de la textura con la imagen
+        uniform vec2 texel;         // 1 / tamaño de la textura
+        uniform float sharpness;
+        vec3 fetch(vec2 p) { return texture(source, clamp(p, texel * 0.5, uvScale - texel * 0.5)).rgb; }
+        void main() {
+            vec2 p = uv * uvScale;
+            vec3 c = fetch(p);
+        #ifdef SHARPEN
+            vec3 n = fetch(p + vec2(0.0, texel.y)), s = fetch(p - vec2(0.0, texel.y));
+            vec3 e = fetch(p + vec2(texel.x, 0.0)), w = fetch(p - vec2(texel.x, 0.0));
+            vec3 lo = min(c, min(min(n, s), min(e, w))), hi = max(c, max(max(n, s), max(e, w)));
+            c = clamp(c + sharpness * (4.0 * c - n - s - e - w), lo, hi);
+        #endif
+            color = vec4(c, 1.0);
+        }
+    )";
+
+    void createPrograms() {
+        shaders.setProgramSetup([](GLuint program) {
+            glUseProgram(program);
+            glUniform1i(glGetUniformLocation(program, "source"), 0);
+            glUniform1f(glGetUniformLocation(program, "sharpness"), DRS_SHARPNESS);
+        });
+        const uint32_t masks[2] = { 0, DRS_SHARPEN };
+        for (int i = 0; i < 2; i++) {
+            GLuint program = shaders.program(masks[i]);
+            uvScaleLocation[i] = glGetUniformLocation(program, "uvScale");
+            texelLocation[i] = glGetUniformLocation(program, "texel");
+        }
+        glUseProgram(0);
+        glGenVertexArrays(1, &vao);
+    }
+};
+
+#endif
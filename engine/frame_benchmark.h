@@ -0,0 +1,171 @@
+#ifndef FRAME_BENCHMARK_H
+#define FRAME_BENCHMARK_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Medición por frame para el modo sin ventana: tiempo de CPU (reloj de pared
+// desde el inicio del frame hasta que se terminó de emitir), tiempo de GPU con
+// consultas GL_TIME_ELAPSED, draws, triángulos y mallas tapadas por oclusión. Las consultas van en un
+// anillo: se leen varios frames después, cuando ya están disponibles, así que
+// medir no detiene la tubería (solo espera si el anillo se llena).
+
+const int BENCHMARK_QUERY_RING = 4;
+
+struct FrameSample {
+    int frame = 0;
+    double cpuMs = 0.0;
+    double gpuMs = -1.0;        // -1 mientras la consulta no tenga resultado
+    int drawCalls = 0;
+    long long triangles = 0;
+    int visibleMeshes = 0;
+    int occludedMeshes = 0;     // dentro del frustum pero tapadas (occlusion_culling.h)
+    float renderScale = 1.0f;   // escala del 3D por eje (dynamic_resolution.h)
+
+    float occludedFraction() const {
+        int candidates = visibleMeshes + occludedMeshes;
+        return candidates > 0 ? (float)occludedMeshes / (float)candidates : 0.0f;
+    }
+};
+
+class FrameBenchmark {
+public:
+    double loadSeconds = 0.0;   // tiempo de carga de la escena (lo fija el llamador)
+
+    explicit FrameBenchmark(int expectedFrames = 0) {
+        samples.reserve((size_t)std::max(expectedFrames, 0));
+        glGenQueries(BENCHMARK_QUERY_RING, queries);
+        std::fill(pending, pending + BENCHMARK_QUERY_RING, -1);
+    }
+
+    ~FrameBenchmark() {
+        glDeleteQueries(BENCHMARK_QUERY_RING, queries);
+    }
+    FrameBenchmark(const FrameBenchmark&) = delete;
+    FrameBenchmark& operator=(const FrameBenchmark&) = delete;
+
+    void beginFrame() {
+        if (pending[slot] >= 0) collect(slot);      // anillo lleno: hay que esperar al más viejo
+        cpuStart = std::chrono::steady_clock::now();
+        glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+    }
+
+    void endFrame(int drawCalls, long long triangles, int visibleMeshes, int occludedMeshes = 0, float renderScale = 1.0f) {
+        glEndQuery(GL_TIME_ELAPSED);
+        FrameSample s;
+        s.frame = (int)samples.size();
+        s.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cpuStart).count();
+        s.drawCalls = drawCalls;
+        s.triangles = triangles;
+        s.visibleMeshes = visibleMeshes;
+        s.occludedMeshes = occludedMeshes;
+        s.renderScale = renderScale;
+        samples.push_back(s);
+        pending[slot] = s.frame;
+        slot = (slot + 1) % BENCHMARK_QUERY_RING;
+        poll();
+    }
+
+    // Recoge lo que falte (bloquea); llamar después del último frame.
+    void finish() {
+        for (int i = 0; i < BENCHMARK_QUERY_RING; i++) {
+            int q = (slot + i) % BENCHMARK_QUERY_RING;
+            if (pending[q] >= 0) collect(q);
+        }
+    }
+
+    const std::vector<FrameSample>& frames() const { return samples; }
+
+    bool writeCsv(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << "frame,cpu_ms,gpu_ms,draw_calls,triangles,visible_meshes,occluded_meshes,occluded_fraction,render_scale\n";
+        for (const auto& s : samples)
+            out << s.frame << ',' << s.cpuMs << ',' << s.gpuMs << ',' << s.drawCalls << ','
+                << s.triangles << ',' << s.visibleMeshes << ',' << s.occludedMeshes << ','
+                << s.occludedFraction() << ',' << s.renderScale << '\n';
+        return (bool)out;
+    }
+
+    bool writeJson(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        std::vector<double> cpu, gpu, occluded, scales;
+        for (const auto& s : samples) {
+            cpu.push_back(s.cpuMs);
+            if (s.gpuMs >= 0.0) gpu.push_back(s.gpuMs);
+            occluded.push_back(s.occludedFraction());
+            scales.push_back(s.renderScale);
+        }
+        out << "{\n  \"load_seconds\": " << loadSeconds << ",\n  \"frames\": " << samples.size() << ",\n";
+        writeSummary(out, "cpu_ms", cpu);
+        out << ",\n";
+        writeSummary(out, "gpu_ms", gpu);
+        out << ",\n";
+        writeSummary(out, "occluded_fraction", occluded);
+        out << ",\n";
+        writeSummary(out, "render_scale", scales);
+        out << ",\n  \"samples\": [\n";
+        for (size_t i = 0; i < samples.size(); i++) {
+            const FrameSample& s = samples[i];
+            out << "    {\"frame\": " << s.frame << ", \"cpu_ms\": " << s.cpuMs << ", \"gpu_ms\": " << s.gpuMs
+                << ", \"draw_calls\": " << s.drawCalls << ", \"triangles\": " << s.triangles
+                << ", \"visible_meshes\": " << s.visibleMeshes << ", \"occluded_meshes\": " << s.occludedMeshes
+                << ", \"occluded_fraction\": " << s.occludedFraction() << ", \"render_scale\": " << s.renderScale << "}" << (i + 1 < samples.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return (bool)out;
+    }
+
+    // Percentil 'p' (0-100) por el método del rango más cercano.
+    static double percentile(std::vector<double> values, double p) {
+        if (values.empty()) return 0.0;
+        std::sort(values.begin(), values.end());
+        size_t rank = (size_t)std::ceil(p / 100.0 * (double)values.size());
+        return values[std::min(std::max(rank, (size_t)1), values.size()) - 1];
+    }
+
+private:
+    GLuint queries[BENCHMARK_QUERY_RING];
+    int pending[BENCHMARK_QUERY_RING];      // frame cuyo resultado espera cada consulta
+    int slot = 0;
+    std::chrono::steady_clock::time_point cpuStart;
+    std::vector<FrameSample> samples;
+
+    void collect(int q) {
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[q], GL_QUERY_RESULT, &ns);
+        samples[pending[q]].gpuMs = (double)ns / 1.0e6;
+        pending[q] = -1;
+    }
+
+    // Lee sin esperar las consultas ya terminadas, de la más vieja a la más nueva.
+    void poll() {
+        for (int i = 0; i < BENCHMARK_QUERY_RING; i++) {
+            int q = (slot + i) % BENCHMARK_QUERY_RING;
+            if (pending[q] < 0) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+            collect(q);
+        }
+    }
+
+    static void writeSummary(std::ofstream& out, const char* name, const std::vector<double>& values) {
+        double sum = 0.0, worst = 0.0;
+        for (double v : values) { sum += v; worst = std::max(worst, v); }
+        double mean = values.empty() ? 0.0 : sum / (double)values.size();
+        out << "  \"" << name << "\": {\"mean\": " << mean << ", \"p50\": " << percentile(values, 50.0)
+            << ", \"p95\": " << percentile(values, 95.0) << ", \"p99\": " << percentile(values, 99.0)
+            << ", \"max\": " << worst << "}";
+    }
+};
+
+#endif
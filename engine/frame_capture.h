@@ -0,0 +1,280 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Grabación de la imagen final sin detener la GPU. Cada frame se copia el
+// framebuffer a uno de CAPTURE_PBO_RING pixel buffer objects con
+// glReadPixels (asíncrono: vuelve en seguida) y se deja un fence detrás. Un
+// par de frames después, cuando el fence ya pasó, se mapea ese PBO, se copia
+// a un frame libre y se encola para el hilo codificador, que lo escribe en
+// disco. Nunca se espera: si el PBO siguiente sigue en vuelo o la cola está
+// llena, el frame se cuenta como perdido y se sigue.
+//
+// Formatos (por la extensión del archivo):
+//   .y4m  YUV 4:2:0 (BT.601, rango limitado), se abre con ffplay/ffmpeg/mpv
+//   otro  RGB24 crudo de arriba hacia abajo:
+//         ffmpeg -f rawvideo -pix_fmt rgb24 -s WxH -r FPS -i archivo
+
+const int CAPTURE_PBO_RING = 3;
+const size_t CAPTURE_QUEUE_FRAMES = 8;      // frames esperando al codificador (memoria acotada)
+
+struct CaptureStats {
+    uint64_t captured = 0;                  // leídos de la GPU y encolados
+    uint64_t written = 0;                   // ya en disco
+    uint64_t droppedBusy = 0;               // el PBO siguiente todavía estaba en vuelo
+    uint64_t droppedQueue = 0;              // la cola del codificador estaba llena
+    double encodeMs = 0.0;                  // tiempo del hilo codificador
+    double readbackMs = 0.0;                // tiempo del hilo de render en capture()
+
+    uint64_t dropped() const { return droppedBusy + droppedQueue; }
+};
+
+class FrameCapture {
+public:
+    CaptureStats stats;                     // 'written' y 'encodeMs' se completan en stop()
+
+    FrameCapture() = default;
+    ~FrameCapture() {
+        stop();
+        if (pbos[0]) glDeleteBuffers(CAPTURE_PBO_RING, pbos);
+    }
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Empieza a grabar frames de width x height en 'path'.
+    bool start(const std::string& path, int width, int height, int fps) {
+        stop();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        w = width;
+        h = height;
+        outputPath = path;
+        y4m = path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+        if (y4m) std::fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", w, h, fps);
+
+        const size_t bytes = (size_t)w * (size_t)h * 4;
+        if (!pbos[0]) glGenBuffers(CAPTURE_PBO_RING, pbos);
+        for (int i = 0; i < CAPTURE_PBO_RING; i++) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)bytes, nullptr, GL_STREAM_READ);
+            if (fences[i]) glDeleteSync(fences[i]);
+            fences[i] = nullptr;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        freeFrames.assign(CAPTURE_QUEUE_FRAMES, std::vector<uint8_t>());
+        for (auto& frame : freeFrames) frame.resize(bytes);
+        queue.clear();
+        next = 0;
+        stats = CaptureStats();
+        encodedFrames = 0;
+        encodedMs = 0.0;
+        finishing = false;
+        encoder = std::thread([this] { encodeLoop(); });
+        recording = true;
+        return true;
+    }
+
+    // Termina los frames en vuelo, espera al codificador y cierra el archivo.
+    void stop() {
+        if (!recording) return;
+        for (int i = 0; i < CAPTURE_PBO_RING; i++) {
+            int slot = (next + i) % CAPTURE_PBO_RING;
+            // Si la GPU no terminó ni esperando, ese frame se pierde pero el fence no
+            if (fences[slot] && !collect(slot, true)) {
+                glDeleteSync(fences[slot]);
+                fences[slot] = nullptr;
+                stats.droppedBusy++;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finishing = true;
+        }
+        queued.notify_all();
+        encoder.join();
+        stats.written = encodedFrames;
+        stats.encodeMs = encodedMs;
+        std::fclose(file);
+        file = nullptr;
+        recording = false;
+    }
+
+    bool active() const { return recording; }
+    const std::string& path() const { return outputPath; }
+
+    // Al final del frame (antes del swap): lee 'framebuffer' (0 = el de la
+    // ventana) si su tamaño sigue siendo el de start(); si no, deja de grabar.
+    void capture(GLuint framebuffer, int width, int height) {
+        if (!recording) return;
+        if (width != w || height != h) {
+            std::cout << "CAPTURE::STOPPED framebuffer resized to " << width << "x" << height << std::endl;
+            stop();
+            return;
+        }
+        auto begin = std::chrono::steady_clock::now();
+
+        // Los frames que la GPU ya terminó pasan al codificador, del más viejo
+        // ('next', el que se va a reutilizar) al más nuevo
+        for (int i = 0; i < CAPTURE_PBO_RING; i++) {
+            int slot = (next + i) % CAPTURE_PBO_RING;
+            if (fences[slot] && !collect(slot, false)) break;
+        }
+
+        if (fences[next]) {
+            stats.droppedBusy++;
+        }
+        else {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+            glReadBuffer(framebuffer ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[next]);
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            fences[next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            next = (next + 1) % CAPTURE_PBO_RING;
+        }
+        stats.readbackMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+private:
+    GLuint pbos[CAPTURE_PBO_RING] = {};
+    GLsync fences[CAPTURE_PBO_RING] = {};
+    int next = 0;                           // PBO del próximo frame (el más viejo en vuelo)
+    int w = 0, h = 0;
+    bool y4m = false;
+    bool recording = false;
+    std::string outputPath;
+    FILE* file = nullptr;
+
+    std::thread encoder;
+    std::mutex mutex;
+    std::condition_variable queued, released;
+    std::deque<std::vector<uint8_t>> queue;             // RGBA de abajo hacia arriba, como glReadPixels
+    std::vector<std::vector<uint8_t>> freeFrames;
+    uint64_t encodedFrames = 0;
+    double encodedMs = 0.0;
+    bool finishing = false;
+
+    // Pasa el PBO 'slot' al codificador si su fence ya pasó (o esperando, si
+    // 'wait'). Devuelve false si todavía está en vuelo.
+    bool collect(int slot, bool wait) {
+        GLenum state = glClientWaitSync(fences[slot], wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                        wait ? (GLuint64)1000000000 : 0);
+        if (state == GL_TIMEOUT_EXPIRED) return false;
+        glDeleteSync(fences[slot]);
+        fences[slot] = nullptr;
+
+        std::vector<uint8_t> pixels;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // Al cerrar se espera lugar en la cola; grabando, nunca
+            if (wait) released.wait(lock, [&] { return !freeFrames.empty(); });
+            if (freeFrames.empty()) {
+                stats.droppedQueue++;
+                return true;
+            }
+            pixels.swap(freeFrames.back());
+            freeFrames.pop_back();
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+        if (const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)pixels.size(), GL_MAP_READ_BIT)) {
+            std::memcpy(pixels.data(), mapped, pixels.size());
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(pixels));
+            stats.captured++;
+        }
+        queued.notify_one();
+        return true;
+    }
+
+    void encodeLoop() {
+        std::vector<uint8_t> converted;
+        for (;;) {
+            std::vector<uint8_t> frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queued.wait(lock, [&] { return finishing || !queue.empty(); });
+                if (queue.empty()) return;
+                frame = std::move(queue.front());
+                queue.pop_front();
+            }
+            auto begin = std::chrono::steady_clock::now();
+            if (y4m) toYuv420(frame, converted);
+            else toRgb(frame, converted);
+            if (y4m) std::fputs("FRAME\n", file);
+            std::fwrite(converted.data(), 1, converted.size(), file);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                freeFrames.push_back(std::move(frame));
+                encodedFrames++;
+                encodedMs += ms;
+            }
+            released.notify_one();
+        }
+    }
+
+    // RGB24 de arriba hacia abajo.
+    void toRgb(const std::vector<uint8_t>& rgba, std::vector<uint8_t>& out) const {
+        out.resize((size_t)w * h * 3);
+        for (int y = 0; y < h; y++) {
+            const uint8_t* src = &rgba[(size_t)(h - 1 - y) * w * 4];
+            uint8_t* dst = &out[(size_t)y * w * 3];
+            for (int x = 0; x < w; x++) {
+                dst[x * 3 + 0] = src[x * 4 + 0];
+                dst[x * 3 + 1] = src[x * 4 + 1];
+                dst[x * 3 + 2] = src[x * 4 + 2];
+            }
+        }
+    }
+
+    // Planos Y, U, V (4:2:0, cada muestra de croma promedia 2x2 píxeles), de arriba hacia abajo.
+    void toYuv420(const std::vector<uint8_t>& rgba, std::vector<uint8_t>& out) const {
+        const int cw = (w + 1) / 2, ch = (h + 1) / 2;
+        out.resize((size_t)w * h + 2 * (size_t)cw * ch);
+        uint8_t* yPlane = out.data();
+        uint8_t* uPlane = yPlane + (size_t)w * h;
+        uint8_t* vPlane = uPlane + (size_t)cw * ch;
+        auto pixel = [&](int x, int y) { return &rgba[((size_t)(h - 1 - y) * w + x) * 4]; };
+
+        for (int y = 0; y < h; y++)
+            for (int x = 0; x < w; x++) {
+                const uint8_t* p = pixel(x, y);
+                yPlane[(size_t)y * w + x] = (uint8_t)((66 * p[0] + 129 * p[1] + 25 * p[2] + 128 + 4096) >> 8);
+            }
+        for (int cy = 0; cy < ch; cy++)
+            for (int cx = 0; cx < cw; cx++) {
+                int r = 0, g = 0, b = 0;
+                for (int dy = 0; dy < 2; dy++)
+                    for (int dx = 0; dx < 2; dx++) {
+                        const uint8_t* p = pixel(std::min(cx * 2 + dx, w - 1), std::min(cy * 2 + dy, h - 1));
+                        r += p[0];
+                        g += p[1];
+                        b += p[2];
+                    }
+                // Promedio de 4 dentro de la fórmula: (x / 4 * k) >> 8 == (x * k) >> 10
+                uPlane[(size_t)cy * cw + cx] = (uint8_t)((-38 * r - 74 * g + 112 * b + 512 + 131072) >> 10);
+                vPlane[(size_t)cy * cw + cx] = (uint8_t)((112 * r - 94 * g - 18 * b + 512 + 131072) >> 10);
+            }
+    }
+};
+
+#endif
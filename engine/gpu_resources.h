@@ -0,0 +1,311 @@
+#ifndef GPU_RESOURCES_H
+#define GPU_RESOURCES_H
+
+#include <glad/glad.h>
+#include <learnopengl/model.h>
+
+#include "texture_streamer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Recursos de GPU compartidos entre modelos: texturas y geometría. Cada
+// textura se identifica al pedirla por su ruta canónica, sin leer el archivo
+// en el hilo de GL. Las copias iguales con otra ruta se descubren después,
+// cuando el streamer las decodifica (hash de contenido en sus hilos): la
+// copia no se sube y sus usuarios pasan a la original (mergeDuplicates). La
+// geometría se identifica por el hash de sus vértices e índices. Todo lleva
+// cuenta de referencias; lo que queda sin referencias sigue cargado hasta que
+// trim() lo necesita para bajar de un presupuesto de memoria.
+
+// Ruta absoluta y sin "..", con '/' (y en minúsculas en Windows, donde el
+// sistema de archivos no distingue). Si el archivo no existe se deja igual.
+inline std::string canonicalAssetPath(const std::string& path) {
+    std::string result = path;
+#ifdef _WIN32
+    char full[_MAX_PATH];
+    if (_fullpath(full, path.c_str(), _MAX_PATH)) result = full;
+    for (char& c : result) {
+        if (c == '\\') c = '/';
+        else if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+    }
+#else
+    char* real = realpath(path.c_str(), nullptr);
+    if (real) {
+        result = real;
+        std::free(real);
+    }
+#endif
+    return result;
+}
+
+// Guarda nombres de textura de GpuResources (pedidos con 'mergeable') y
+// acepta que se cambien cuando resultan duplicados de otra.
+class TextureHolder {
+public:
+    // Devuelve cuántas referencias a 'from' tenía (las que pasan a 'to').
+    virtual int replaceTexture(unsigned int from, unsigned int to) = 0;
+
+protected:
+    ~TextureHolder() = default;
+};
+
+class GpuResources {
+public:
+    explicit GpuResources(TextureStreamer* streamer = nullptr) : streamer(streamer) {}
+
+    ~GpuResources() {
+        for (const auto& entry : textures) freeTexture(entry.first);
+        for (const auto& entry : meshes) freeMesh(entry.second);
+    }
+    GpuResources(const GpuResources&) = delete;
+    GpuResources& operator=(const GpuResources&) = delete;
+
+    // --- TEXTURAS ---
+    // Devuelve la textura ya cargada si la ruta coincide con otra pedida con
+    // las mismas opciones; si no, la pide al streamer. Con 'mergeable' el que
+    // pide es un TextureHolder registrado (addHolder): si el contenido resulta
+    // igual al de otra textura, mergeDuplicates() le cambia el nombre.
+    unsigned int acquireTexture(const std::string& path, bool flipVertically = false, GLint wrap = GL_REPEAT,
+                                bool mergeable = false) {
+        const std::string options = std::string(flipVertically ? "|flip|" : "|") + std::to_string(wrap);
+        const std::string pathKey = canonicalAssetPath(path) + options;
+        auto byPath = texturePaths.find(pathKey);
+        if (byPath != texturePaths.end()) return reuse(byPath->second);
+
+        TextureEntry entry;
+        entry.path = path;
+        if (streamer) {
+            entry.id = streamer->request(path, flipVertically, wrap, mergeable);
+        }
+        else {
+            size_t slash = path.find_last_of("/\\");
+            std::string file = slash == std::string::npos ? path : path.substr(slash + 1);
+            std::string dir = slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+            entry.id = TextureFromFile(file.c_str(), dir);
+            entry.bytes = queryTextureBytes(entry.id);
+        }
+        entry.refs = 1;
+        texturePaths[pathKey] = entry.id;
+        textures[entry.id] = entry;
+        return entry.id;
+    }
+
+    void releaseTexture(unsigned int texture) {
+        auto it = textures.find(texture);
+        if (it == textures.end() || it->second.refs == 0) return;
+        if (it->second.aliasOf) {
+            // Alguien que no se registró como holder sigue con el duplicado
+            unsigned int original = it->second.aliasOf;
+            dropAlias(it, 1);
+            releaseTexture(original);
+            return;
+        }
+        if (--it->second.refs == 0) it->second.lastUse = ++clock;
+    }
+
+    void addHolder(TextureHolder* holder) { holders.push_back(holder); }
+    void removeHolder(TextureHolder* holder) { holders.erase(std::remove(holders.begin(), holders.end(), holder), holders.end()); }
+
+    // Después de TextureStreamer::pump(): cada textura que resultó igual a
+    // otra ya subida se reemplaza por la original en los holders, sus
+    // referencias pasan a la original y su nombre se libera. Si queda alguien
+    // sin registrar con el nombre viejo, este sigue vivo (con el placeholder)
+    // como alias hasta su releaseTexture.
+    void mergeDuplicates() {
+        if (!streamer) return;
+        for (const auto& merge : streamer->takeMerges()) {
+            auto dup = textures.find(merge.first), original = textures.find(merge.second);
+            if (dup == textures.end() || original == textures.end()) continue;
+            original->second.refs += dup->second.refs;
+            dup->second.aliasOf = merge.second;
+            for (auto& path : texturePaths)
+                if (path.second == merge.first) path.second = merge.second;
+            textureHits++;
+            texturesMerged++;
+
+            int moved = 0;
+            for (TextureHolder* holder : holders) moved += holder->replaceTexture(merge.first, merge.second);
+            dropAlias(dup, moved);
+        }
+    }
+
+    // --- GEOMETRÍA ---
+    // Si ya hay una malla con ese contenido devuelve su VAO y suma una referencia.
+    bool acquireMesh(uint64_t hash, unsigned int& vao) {
+        auto it = meshes.find(hash);
+        if (it == meshes.end()) return false;
+        it->second.refs++;
+        meshHits++;
+        vao = it->second.vao;
+        return true;
+    }
+
+    // Registra una malla recién subida (con una referencia); los buffers pasan a ser del registro.
+    void addMesh(uint64_t hash, unsigned int vao, unsigned int vbo, unsigned int ebo, size_t bytes) {
+        MeshEntry entry;
+        entry.vao = vao;
+        entry.vbo = vbo;
+        entry.ebo = ebo;
+        entry.bytes = bytes;
+        entry.refs = 1;
+        meshes[hash] = entry;
+    }
+
+    void releaseMesh(uint64_t hash) {
+        auto it = meshes.find(hash);
+        if (it == meshes.end() || it->second.refs == 0) return;
+        if (--it->second.refs == 0) it->second.lastUse = ++clock;
+    }
+
+    // --- MEMORIA ---
+    // Bytes de las texturas (con mipmaps) que ya tienen sus píxeles; las que
+    // aún se decodifican cuentan cuando llegan.
+    size_t textureBytes() {
+        size_t total = 0;
+        for (auto& entry : textures) total += textureSize(entry.second);
+        return total;
+    }
+
+    size_t meshBytes() const {
+        size_t total = 0;
+        for (const auto& entry : meshes) total += entry.second.bytes;
+        return total;
+    }
+
+    size_t totalBytes() { return textureBytes() + meshBytes(); }
+    size_t textureCount() const { return textures.size(); }
+    size_t meshCount() const { return meshes.size(); }
+    uint64_t textureReuses() const { return textureHits; }
+    uint64_t texturesMergedByContent() const { return texturesMerged; }
+    uint64_t meshReuses() const { return meshHits; }
+
+    // Libera recursos sin referencias, el que lleva más tiempo sin usarse
+    // primero, hasta bajar de 'targetBytes'. Devuelve los bytes liberados.
+    size_t trim(size_t targetBytes) {
+        size_t total = totalBytes(), freed = 0;
+        while (total > targetBytes) {
+            uint64_t oldest = UINT64_MAX;
+            unsigned int texture = 0;
+            uint64_t mesh = 0;
+            bool isMesh = false, found = false;
+            for (const auto& entry : textures)
+                if (entry.second.refs == 0 && entry.second.lastUse < oldest) {
+                    oldest = entry.second.lastUse; texture = entry.first; isMesh = false; found = true;
+                }
+            for (const auto& entry : meshes)
+                if (entry.second.refs == 0 && entry.second.lastUse < oldest) {
+                    oldest = entry.second.lastUse; mesh = entry.first; isMesh = true; found = true;
+                }
+            if (!found) break;
+
+            size_t bytes;
+            if (isMesh) {
+                bytes = meshes[mesh].bytes;
+                freeMesh(meshes[mesh]);
+                meshes.erase(mesh);
+            }
+            else {
+                bytes = textureSize(textures[texture]);
+                freeTexture(texture);
+                eraseTexture(texture);
+            }
+            total -= bytes;
+            freed += bytes;
+        }
+        return freed;
+    }
+
+    // Una línea por recurso: referencias, tamaño y origen.
+    void report(std::ostream& out) {
+        out << "Texturas: " << textures.size() << " (" << textureBytes() / (1024 * 1024) << " MB, "
+            << textureHits << " reutilizadas, " << texturesMerged << " iguales a otra)" << std::endl;
+        for (auto& entry : textures)
+            out << "  [" << entry.second.refs << "] " << textureSize(entry.second) / 1024 << " KB  " << entry.second.path << std::endl;
+        out << "Mallas: " << meshes.size() << " (" << meshBytes() / (1024 * 1024) << " MB, "
+            << meshHits << " reutilizadas)" << std::endl;
+    }
+
+private:
+    struct TextureEntry {
+        unsigned int id = 0;
+        std::string path;
+        int refs = 0;
+        uint64_t lastUse = 0;
+        size_t bytes = 0;           // 0 mientras el streamer no la haya subido
+        unsigned int aliasOf = 0;   // != 0: duplicado sin píxeles de esa textura
+    };
+
+    struct MeshEntry {
+        unsigned int vao = 0, vbo = 0, ebo = 0;
+        size_t bytes = 0;
+        int refs = 0;
+        uint64_t lastUse = 0;
+    };
+
+    TextureStreamer* streamer;
+    std::unordered_map<unsigned int, TextureEntry> textures;
+    std::unordered_map<std::string, unsigned int> texturePaths;    // ruta canónica + opciones
+    std::vector<TextureHolder*> holders;
+    std::unordered_map<uint64_t, MeshEntry> meshes;
+    uint64_t clock = 0;
+    uint64_t textureHits = 0, meshHits = 0, texturesMerged = 0;
+
+    // Las referencias 'count' del alias ya están en la original: al llegar a
+    // cero se borra el nombre duplicado.
+    void dropAlias(std::unordered_map<unsigned int, TextureEntry>::iterator alias, int count) {
+        alias->second.refs -= std::min(count, alias->second.refs);
+        if (alias->second.refs > 0) return;
+        freeTexture(alias->first);
+        textures.erase(alias);
+    }
+
+    unsigned int reuse(unsigned int texture) {
+        textures[texture].refs++;
+        textureHits++;
+        return texture;
+    }
+
+    size_t textureSize(TextureEntry& entry) {
+        if (entry.bytes == 0 && streamer) entry.bytes = streamer->residentBytes(entry.id);
+        return entry.bytes;
+    }
+
+    // Nivel 0 más un tercio por los mipmaps.
+    static size_t queryTextureBytes(unsigned int texture) {
+        GLint w = 0, h = 0, format = 0;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        size_t texel = format == GL_RED ? 1 : format == GL_RGB ? 3 : 4;
+        return (size_t)w * h * texel * 4 / 3;
+    }
+
+    void freeTexture(unsigned int texture) {
+        if (streamer) streamer->release(texture);
+        else glDeleteTextures(1, &texture);
+    }
+
+    void eraseTexture(unsigned int texture) {
+        textures.erase(texture);
+        for (auto it = texturePaths.begin(); it != texturePaths.end();)
+            it = it->second == texture ? texturePaths.erase(it) : std::next(it);
+    }
+
+    static void freeMesh(const MeshEntry& entry) {
+        glDeleteVertexArrays(1, &entry.vao);
+        glDeleteBuffers(1, &entry.vbo);
+        glDeleteBuffers(1, &entry.ebo);
+    }
+};
+
+#endif
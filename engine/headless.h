@@ -0,0 +1,163 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Modo sin ventana: contexto GL 3.3 core sin servidor gráfico (EGL u OSMesa,
+// que en una máquina sin GPU terminan en Mesa llvmpipe) y un framebuffer
+// propio donde se dibuja en lugar de la ventana.
+
+// Crea el contexto y lo deja actual. Con GLFW 3.4 se usa la plataforma nula
+// (no hace falta DISPLAY) con OSMesa; si no, una ventana oculta con EGL y,
+// como último recurso, con la API nativa (GLX/WGL, p. ej. bajo Xvfb).
+inline GLFWwindow* createHeadlessContext() {
+#ifdef GLFW_PLATFORM_NULL
+    if (glfwPlatformSupported(GLFW_PLATFORM_NULL))
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+    if (!glfwInit()) {
+        std::cout << "Failed to initialize GLFW" << std::endl;
+        return nullptr;
+    }
+
+    std::vector<int> apis;
+#ifdef GLFW_PLATFORM_NULL
+    if (glfwGetPlatform() == GLFW_PLATFORM_NULL) apis.push_back(GLFW_OSMESA_CONTEXT_API);
+#endif
+    apis.push_back(GLFW_EGL_CONTEXT_API);
+    apis.push_back(GLFW_NATIVE_CONTEXT_API);
+
+    GLFWwindow* window = nullptr;
+    for (int api : apis) {
+        glfwDefaultWindowHints();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, 0);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, api);
+        window = glfwCreateWindow(16, 16, "Drone Simulation (headless)", nullptr, nullptr);
+        if (window) break;
+    }
+    if (!window) {
+        std::cout << "Failed to create headless GL context" << std::endl;
+        glfwTerminate();
+        return nullptr;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return nullptr;
+    }
+    std::cout << "Headless: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+    return window;
+}
+
+// --- FRAMEBUFFER FUERA DE PANTALLA ---
+// Color RGBA8 y profundidad de 24 bits en renderbuffers del tamaño pedido.
+class OffscreenTarget {
+public:
+    OffscreenTarget(int width, int height) : w(width), h(height) {
+        glGenFramebuffers(1, &fbo);
+        glGenRenderbuffers(2, renderbuffers);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+        complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) std::cout << "Offscreen framebuffer incomplete" << std::endl;
+    }
+
+    ~OffscreenTarget() {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(2, renderbuffers);
+    }
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+    // Hay que llamarlo cada frame: los blits del lote estático dejan el FBO 0.
+    void bind() const {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, w, h);
+    }
+
+    bool valid() const { return complete; }
+    GLuint framebuffer() const { return fbo; }
+    int width() const { return w; }
+    int height() const { return h; }
+
+private:
+    GLuint fbo = 0;
+    GLuint renderbuffers[2] = { 0, 0 };
+    int w, h;
+    bool complete = false;
+};
+
+// --- RECORRIDO DE CÁMARA ---
+// Puntos de paso (posición y punto al que mira) interpolados con Catmull-Rom.
+// El recorrido entero se reparte uniformemente entre los frames pedidos.
+class CameraPath {
+public:
+    void add(const glm::vec3& position, const glm::vec3& target) {
+        keys.push_back({ position, target });
+    }
+
+    size_t size() const { return keys.size(); }
+
+    // 't' en [0, 1]; devuelve yaw y pitch en grados, como los usa Camera.
+    void sample(float t, glm::vec3& position, float& yaw, float& pitch) const {
+        if (keys.empty()) { position = glm::vec3(0.0f); yaw = -90.0f; pitch = 0.0f; return; }
+
+        float u = std::min(std::max(t, 0.0f), 1.0f) * (float)(keys.size() - 1);
+        int i = std::min((int)u, (int)keys.size() - 2);
+        if (i < 0) i = 0;
+        float f = keys.size() > 1 ? u - (float)i : 0.0f;
+
+        position = spline(i, f, &Key::position);
+        glm::vec3 target = spline(i, f, &Key::target);
+        glm::vec3 dir = target - position;
+        float len = glm::length(dir);
+        dir = len > 1e-5f ? dir / len : glm::vec3(0.0f, 0.0f, -1.0f);
+        yaw = glm::degrees(std::atan2(dir.z, dir.x));
+        pitch = glm::degrees(std::asin(std::min(std::max(dir.y, -1.0f), 1.0f)));
+    }
+
+private:
+    struct Key {
+        glm::vec3 position;
+        glm::vec3 target;
+    };
+    std::vector<Key> keys;
+
+    const glm::vec3& at(int i, glm::vec3 Key::* field) const {
+        i = std::min(std::max(i, 0), (int)keys.size() - 1);
+        return keys[i].*field;
+    }
+
+    glm::vec3 spline(int i, float f, glm::vec3 Key::* field) const {
+        const glm::vec3& p0 = at(i - 1, field);
+        const glm::vec3& p1 = at(i, field);
+        const glm::vec3& p2 = at(i + 1, field);
+        const glm::vec3& p3 = at(i + 2, field);
+        float f2 = f * f, f3 = f2 * f;
+        return 0.5f * ((2.0f * p1) + (p2 - p0) * f +
+                       (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * f2 +
+                       (3.0f * p1 - p0 - 3.0f * p2 + p3) * f3);
+    }
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef HUD_WIDGET_H
+#define HUD_WIDGET_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <vector>
+
+// Widget de HUD con geometría que cambia (timer, batería). El VAO y el VBO se
+// crean una sola vez con capacidad fija; cada actualización reescribe una de
+// dos mitades del buffer (alternando, así no se pisa la que la GPU puede
+// estar leyendo todavía) con glBufferSubData. El vector de staging se reutiliza,
+// de modo que en régimen estable no hay ninguna reserva de memoria ni objetos GL nuevos.
+
+class HudWidget {
+public:
+    static const int FLOATS_PER_VERTEX = 3;
+
+    explicit HudWidget(GLsizei maxVertices) : capacity(maxVertices) {
+        staging.reserve((size_t)maxVertices * FLOATS_PER_VERTEX);
+
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, 2 * slotBytes(), nullptr, GL_DYNAMIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    ~HudWidget() {
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+    }
+    HudWidget(const HudWidget&) = delete;
+    HudWidget& operator=(const HudWidget&) = delete;
+
+    // Devuelve el staging vacío para escribir los vértices nuevos (x, y, z).
+    std::vector<float>& begin() {
+        staging.clear();
+        return staging;
+    }
+
+    // Sube lo escrito desde begin(). Lo que pase de la capacidad se descarta.
+    void commit() {
+        GLsizei vertices = std::min((GLsizei)(staging.size() / FLOATS_PER_VERTEX), capacity);
+        slot ^= 1;
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, slot * slotBytes(),
+                        (GLsizeiptr)vertices * FLOATS_PER_VERTEX * sizeof(float), staging.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        count = vertices;
+    }
+
+    void draw(GLenum mode) const {
+        if (count == 0) return;
+        glBindVertexArray(vao);
+        glDrawArrays(mode, slot * capacity, count);
+    }
+
+    GLsizei vertexCount() const { return count; }
+
+private:
+    GLuint vao = 0, vbo = 0;
+    GLsizei capacity;
+    GLsizei count = 0;
+    int slot = 1;       // el primer commit() escribe en la mitad 0
+    std::vector<float> staging;
+
+    GLsizeiptr slotBytes() const { return (GLsizeiptr)capacity * FLOATS_PER_VERTEX * sizeof(float); }
+};
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Lector de JSON mínimo para archivos de configuración (manifiestos de
+// escena): arma un árbol de valores y reporta el primer error con su línea.
+// No escribe JSON ni intenta ser rápido; los archivos son de pocos KB.
+
+class JsonValue {
+public:
+    enum Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> items;                               // Array
+    std::vector<std::pair<std::string, JsonValue>> members;     // Object, en el orden del archivo
+
+    bool isNumber() const { return type == Number; }
+    bool isString() const { return type == String; }
+    bool isBool() const { return type == Bool; }
+    bool isArray() const { return type == Array; }
+    bool isObject() const { return type == Object; }
+
+    const JsonValue* find(const std::string& key) const {
+        for (const auto& member : members)
+            if (member.first == key) return &member.second;
+        return nullptr;
+    }
+};
+
+class JsonReader {
+public:
+    // Devuelve false y deja en 'error' algo como "line 12: expected ':'".
+    static bool parse(const std::string& text, JsonValue& out, std::string& error) {
+        JsonReader reader(text);
+        bool ok = reader.value(out, 0);
+        if (ok) {
+            reader.skipSpace();
+            if (reader.pos != text.size()) ok = reader.fail("trailing characters");
+        }
+        if (!ok) error = reader.error;
+        return ok;
+    }
+
+private:
+    static const int MAX_DEPTH = 64;
+
+    const std::string& text;
+    size_t pos = 0;
+    std::string error;
+
+    explicit JsonReader(const std::string& text) : text(text) {}
+
+    bool fail(const char* message) {
+        if (error.empty()) {
+            int line = 1;
+            for (size_t i = 0; i < pos && i < text.size(); i++)
+                if (text[i] == '\n') line++;
+            error = "line " + std::to_string(line) + ": " + message;
+        }
+        return false;
+    }
+
+    void skipSpace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) pos++;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c) { pos++; return true; }
+        return false;
+    }
+
+    bool literal(const char* word) {
+        size_t n = std::char_traits<char>::length(word);
+        if (text.compare(pos, n, word) != 0) return false;
+        pos += n;
+        return true;
+    }
+
+    bool value(JsonValue& out, int depth) {
+        if (depth > MAX_DEPTH) return fail("nesting too deep");
+        skipSpace();
+        if (pos >= text.size()) return fail("unexpected end of file");
+        char c = text[pos];
+        if (c == '{') return object(out, depth);
+        if (c == '[') return array(out, depth);
+        if (c == '"') { out.type = JsonValue::String; return string(out.string); }
+        if (literal("true")) { out.type = JsonValue::Bool; out.boolean = true; return true; }
+        if (literal("false")) { out.type = JsonValue::Bool; out.boolean = false; return true; }
+        if (literal("null")) { out.type = JsonValue::Null; return true; }
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            const char* begin = text.c_str() + pos;
+            char* end = nullptr;
+            out.number = std::strtod(begin, &end);
+            if (end == begin) return fail("invalid number");
+            out.type = JsonValue::Number;
+            pos += (size_t)(end - begin);
+            return true;
+        }
+        return fail("unexpected character");
+    }
+
+    bool object(JsonValue& out, int depth) {
+        out.type = JsonValue::Object;
+        pos++;
+        if (consume('}')) return true;
+        do {
+            skipSpace();
+            std::pair<std::string, JsonValue> member;
+            if (pos >= text.size() || text[pos] != '"') return fail("expected a quoted key");
+            if (!string(member.first)) return false;
+            if (!consume(':')) return fail("expected ':'");
+            if (!value(member.second, depth + 1)) return false;
+            out.members.push_back(std::move(member));
+        } while (consume(','));
+        return consume('}') || fail("expected ',' or '}'");
+    }
+
+    bool array(JsonValue& out, int depth) {
+        out.type = JsonValue::Array;
+        pos++;
+        if (consume(']')) return true;
+        do {
+            out.items.emplace_back();
+            if (!value(out.items.back(), depth + 1)) return false;
+        } while (consume(','));
+        return consume(']') || fail("expected ',' or ']'");
+    }
+
+    // Cadena con escapes; \uXXXX fuera de ASCII se guarda en UTF-8.
+    bool string(std::string& out) {
+        pos++;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') { out += c; continue; }
+            if (pos >= text.size()) break;
+            char e = text[pos++];
+            switch (e) {
+            case '"': case '\\': case '/': out += e; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                if (pos + 4 > text.size()) return fail("invalid \\u escape");
+                unsigned code = (unsigned)std::strtoul(text.substr(pos, 4).c_str(), nullptr, 16);
+                pos += 4;
+                if (code < 0x80) out += (char)code;
+                else if (code < 0x800) { out += (char)(0xC0 | (code >> 6)); out += (char)(0x80 | (code & 0x3F)); }
+                else { out += (char)(0xE0 | (code >> 12)); out += (char)(0x80 | ((code >> 6) & 0x3F)); out += (char)(0x80 | (code & 0x3F)); }
+                break;
+            }
+            default: return fail("invalid escape");
+            }
+        }
+        if (pos >= text.size()) return fail("unterminated string");
+        pos++;
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,415 @@
+#ifndef LIDAR_SENSOR_H
+#define LIDAR_SENSOR_H
+
+#include <glm/glm.hpp>
+
+#include "collision_bvh.h"
+#include "thread_pool.h"
+#include "triple_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LIDAR_SSE 1
+#include <emmintrin.h>
+#endif
+
+// LiDAR simulado: 'beams' haces en elevación por 'azimuthSteps' pasos en una
+// vuelta completa, lanzados desde la posición del dron contra la BVH de
+// colisión (los mismos triángulos con los que choca). Los rayos de un mismo
+// haz se trazan de a 4 (paquetes SSE: caja contra 4 rayos y Möller-Trumbore
+// contra 4 rayos, todos con el mismo origen) y los paquetes se reparten entre
+// los hilos de un pool propio, así que el hilo de render solo publica la pose.
+//
+// Cada barrido queda en un triple buffer (el lector lo usa en su lugar, sin
+// copiarlo) y, si se pidió, se agrega a un archivo binario:
+//   LidarFileHeader, y por barrido LidarScanHeader + beams * azimuthSteps LidarPoint
+// Los puntos van en el marco del sensor (x adelante, y izquierda, z arriba),
+// ordenados por haz y después por azimut; range == 0 es un rayo sin retorno.
+
+struct LidarSettings {
+    int beams = 64;
+    int azimuthSteps = 1024;            // se redondea a múltiplo de 4 (un paquete)
+    float minElevation = -25.0f;        // grados
+    float maxElevation = 15.0f;
+    float range = 100.0f;               // alcance máximo en metros
+    float rate = 10.0f;                 // barridos por segundo
+};
+
+// Posición y rumbo del sensor (yaw en grados, como Camera::Yaw).
+struct LidarPose {
+    glm::vec3 position = glm::vec3(0.0f);
+    float yaw = 0.0f;
+    double time = 0.0;
+};
+
+struct LidarPoint {
+    float x, y, z;
+    float range;
+};
+
+struct LidarScan {
+    uint64_t sequence = 0;
+    LidarPose pose;
+    uint32_t hits = 0;
+    uint32_t overruns = 0;              // barridos que no llegaron a tiempo desde el arranque
+    double milliseconds = 0.0;          // tiempo de trazado de este barrido
+    std::vector<LidarPoint> points;
+};
+
+#pragma pack(push, 1)
+struct LidarFileHeader {
+    char magic[4];                      // "LDR1"
+    uint32_t beams;
+    uint32_t azimuthSteps;
+    float minElevation, maxElevation;
+    float range;
+};
+
+struct LidarScanHeader {
+    uint64_t sequence;
+    double time;
+    float position[3];
+    float yaw;
+};
+#pragma pack(pop)
+
+class LidarScanner {
+public:
+    explicit LidarScanner(const LidarSettings& settings) : settings(settings) {
+        this->settings.beams = std::max(this->settings.beams, 1);
+        this->settings.azimuthSteps = (std::max(this->settings.azimuthSteps, 4) + 3) / 4 * 4;
+        const float pi = 3.14159265f;
+        for (int b = 0; b < this->settings.beams; b++) {
+            float t = this->settings.beams > 1 ? (float)b / (float)(this->settings.beams - 1) : 0.5f;
+            float elevation = glm::radians(settings.minElevation + (settings.maxElevation - settings.minElevation) * t);
+            cosElevation.push_back(std::cos(elevation));
+            sinElevation.push_back(std::sin(elevation));
+        }
+        for (int a = 0; a < this->settings.azimuthSteps; a++) {
+            float azimuth = 2.0f * pi * (float)a / (float)this->settings.azimuthSteps;
+            cosAzimuth.push_back(std::cos(azimuth));
+            sinAzimuth.push_back(std::sin(azimuth));
+        }
+    }
+
+    const LidarSettings& config() const { return settings; }
+    size_t pointCount() const { return (size_t)settings.beams * (size_t)settings.azimuthSteps; }
+
+    // Un barrido completo en 'out' (pointCount() puntos); devuelve los impactos.
+    // 'packets' en false traza rayo por rayo (referencia para el benchmark).
+    uint32_t scan(const CollisionBVH& bvh, const LidarPose& pose, ThreadPool& pool, LidarPoint* out, bool packets = true) const {
+        const glm::vec3 forward(std::cos(glm::radians(pose.yaw)), 0.0f, std::sin(glm::radians(pose.yaw)));
+        const glm::vec3 left(forward.z, 0.0f, -forward.x);
+        const size_t packetCount = pointCount() / 4;
+        std::atomic<uint32_t> hits{ 0 };
+        pool.parallelFor(packetCount, [&](size_t begin, size_t end) {
+            uint32_t localHits = 0;
+            for (size_t p = begin; p < end; p++) {
+                const size_t first = p * 4;
+                const int beam = (int)(first / settings.azimuthSteps);
+                const int azimuth = (int)(first % settings.azimuthSteps);
+                glm::vec3 dirs[4];
+                for (int k = 0; k < 4; k++)
+                    dirs[k] = direction(beam, azimuth + k, forward, left);
+                float t[4];
+                if (packets) tracePacket(bvh, pose.position, dirs, t);
+                else
+                    for (int k = 0; k < 4; k++) t[k] = traceRay(bvh, pose.position, dirs[k]);
+                for (int k = 0; k < 4; k++) {
+                    LidarPoint& point = out[first + k];
+                    if (t[k] < settings.range) {
+                        // Al marco del sensor: x adelante, y izquierda, z arriba
+                        glm::vec3 d = dirs[k] * t[k];
+                        point.x = glm::dot(d, forward);
+                        point.y = glm::dot(d, left);
+                        point.z = d.y;
+                        point.range = t[k];
+                        localHits++;
+                    }
+                    else {
+                        point.x = point.y = point.z = point.range = 0.0f;
+                    }
+                }
+            }
+            hits += localHits;
+        }, PACKETS_PER_CHUNK);
+        return hits;
+    }
+
+    // Distancia al primer triángulo en la dirección 'dir' (unitaria); >= range si no hay.
+    float traceRay(const CollisionBVH& bvh, const glm::vec3& origin, const glm::vec3& dir) const {
+        float best = settings.range;
+        if (bvh.nodes.empty()) return best;
+        const glm::vec3 inv(safeInverse(dir.x), safeInverse(dir.y), safeInverse(dir.z));
+        uint32_t stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const BvhNode& node = bvh.nodes[stack[--top]];
+            if (!rayBox(origin, inv, node.boundsMin, node.boundsMax, best)) continue;
+            if (node.isLeaf()) {
+                for (uint32_t i = 0; i < node.count; i++)
+                    rayTriangle(origin, dir, bvh.triangles[node.leftFirst + i], best);
+            }
+            else {
+                pushChildren(bvh, node, origin, dir, stack, top);
+            }
+        }
+        return best;
+    }
+
+private:
+    static const size_t PACKETS_PER_CHUNK = 64;
+    static constexpr float TRIANGLE_EPSILON = 1e-7f;
+    static constexpr float MIN_DISTANCE = 1e-3f;
+
+    LidarSettings settings;
+    std::vector<float> cosElevation, sinElevation, cosAzimuth, sinAzimuth;
+
+    glm::vec3 direction(int beam, int azimuth, const glm::vec3& forward, const glm::vec3& left) const {
+        glm::vec3 horizontal = forward * cosAzimuth[azimuth] + left * sinAzimuth[azimuth];
+        return horizontal * cosElevation[beam] + glm::vec3(0.0f, sinElevation[beam], 0.0f);
+    }
+
+    // 1/d sin infinitos: un componente nulo se trata como uno diminuto.
+    static float safeInverse(float d) {
+        const float tiny = 1e-12f;
+        return 1.0f / (std::fabs(d) > tiny ? d : (d < 0.0f ? -tiny : tiny));
+    }
+
+    // Primero el hijo más cercano en la dirección del rayo (queda arriba en la pila).
+    static void pushChildren(const CollisionBVH& bvh, const BvhNode& node, const glm::vec3& origin, const glm::vec3& dir,
+                             uint32_t* stack, int& top) {
+        const BvhNode& a = bvh.nodes[node.leftFirst];
+        const BvhNode& b = bvh.nodes[node.leftFirst + 1];
+        float da = glm::dot((a.boundsMin + a.boundsMax) * 0.5f - origin, dir);
+        float db = glm::dot((b.boundsMin + b.boundsMax) * 0.5f - origin, dir);
+        bool leftFirst = da <= db;
+        stack[top++] = leftFirst ? node.leftFirst + 1 : node.leftFirst;
+        stack[top++] = leftFirst ? node.leftFirst : node.leftFirst + 1;
+    }
+
+    static bool rayBox(const glm::vec3& origin, const glm::vec3& inv, const glm::vec3& bmin, const glm::vec3& bmax, float tMax) {
+        glm::vec3 t1 = (bmin - origin) * inv, t2 = (bmax - origin) * inv;
+        glm::vec3 lo = glm::min(t1, t2), hi = glm::max(t1, t2);
+        float enter = std::max(std::max(lo.x, lo.y), std::max(lo.z, 0.0f));
+        float exit = std::min(std::min(hi.x, hi.y), hi.z);
+        return enter <= exit && enter < tMax;
+    }
+
+    // Möller-Trumbore de doble cara; actualiza 'best' si hay un impacto más cercano.
+    static void rayTriangle(const glm::vec3& origin, const glm::vec3& dir, const CollisionTriangle& tri, float& best) {
+        glm::vec3 e1 = tri.v1 - tri.v0, e2 = tri.v2 - tri.v0;
+        glm::vec3 p = glm::cross(dir, e2);
+        float det = glm::dot(e1, p);
+        if (std::fabs(det) < TRIANGLE_EPSILON) return;
+        float inv = 1.0f / det;
+        glm::vec3 s = origin - tri.v0;
+        float u = glm::dot(s, p) * inv;
+        if (u < 0.0f || u > 1.0f) return;
+        glm::vec3 q = glm::cross(s, e1);
+        float v = glm::dot(dir, q) * inv;
+        if (v < 0.0f || u + v > 1.0f) return;
+        float t = glm::dot(e2, q) * inv;
+        if (t > MIN_DISTANCE && t < best) best = t;
+    }
+
+    // Cuatro rayos con el mismo origen; t[k] >= range si el rayo k no toca nada.
+    void tracePacket(const CollisionBVH& bvh, const glm::vec3& origin, const glm::vec3* dirs, float* t) const {
+#ifdef LIDAR_SSE
+        const __m128 dx = _mm_setr_ps(dirs[0].x, dirs[1].x, dirs[2].x, dirs[3].x);
+        const __m128 dy = _mm_setr_ps(dirs[0].y, dirs[1].y, dirs[2].y, dirs[3].y);
+        const __m128 dz = _mm_setr_ps(dirs[0].z, dirs[1].z, dirs[2].z, dirs[3].z);
+        const __m128 ix = _mm_setr_ps(safeInverse(dirs[0].x), safeInverse(dirs[1].x), safeInverse(dirs[2].x), safeInverse(dirs[3].x));
+        const __m128 iy = _mm_setr_ps(safeInverse(dirs[0].y), safeInverse(dirs[1].y), safeInverse(dirs[2].y), safeInverse(dirs[3].y));
+        const __m128 iz = _mm_setr_ps(safeInverse(dirs[0].z), safeInverse(dirs[1].z), safeInverse(dirs[2].z), safeInverse(dirs[3].z));
+        const __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+        const __m128 epsilon = _mm_set1_ps(TRIANGLE_EPSILON), minDistance = _mm_set1_ps(MIN_DISTANCE);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128 best = _mm_set1_ps(settings.range);
+
+        if (!bvh.nodes.empty()) {
+            uint32_t stack[64];
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0) {
+                const BvhNode& node = bvh.nodes[stack[--top]];
+
+                // Caja contra los 4 rayos: basta con que uno entre antes de su impacto actual
+                __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.x), ox), ix);
+                __m128 t2x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.x), ox), ix);
+                __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.y), oy), iy);
+                __m128 t2y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.y), oy), iy);
+                __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.z), oz), iz);
+                __m128 t2z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.z), oz), iz);
+                __m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(t1x, t2x), _mm_min_ps(t1y, t2y)),
+                                          _mm_max_ps(_mm_min_ps(t1z, t2z), zero));
+                __m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t1x, t2x), _mm_max_ps(t1y, t2y)), _mm_max_ps(t1z, t2z));
+                __m128 boxHit = _mm_and_ps(_mm_cmple_ps(enter, exit), _mm_cmplt_ps(enter, best));
+                if (_mm_movemask_ps(boxHit) == 0) continue;
+
+                if (!node.isLeaf()) {
+                    pushChildren(bvh, node, origin, dirs[0], stack, top);
+                    continue;
+                }
+                for (uint32_t i = 0; i < node.count; i++) {
+                    const CollisionTriangle& tri = bvh.triangles[node.leftFirst + i];
+                    const glm::vec3 e1 = tri.v1 - tri.v0, e2 = tri.v2 - tri.v0;
+                    const glm::vec3 s = origin - tri.v0;
+                    const glm::vec3 q = glm::cross(s, e1);     // no depende del rayo: mismo origen
+                    const __m128 e1x = _mm_set1_ps(e1.x), e1y = _mm_set1_ps(e1.y), e1z = _mm_set1_ps(e1.z);
+                    const __m128 e2x = _mm_set1_ps(e2.x), e2y = _mm_set1_ps(e2.y), e2z = _mm_set1_ps(e2.z);
+
+                    // p = cross(dir, e2)
+                    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+                    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+                    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+                    __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+                    __m128 valid = _mm_cmpge_ps(_mm_and_ps(det, absMask), epsilon);
+                    if (_mm_movemask_ps(valid) == 0) continue;
+                    __m128 inv = _mm_div_ps(one, det);
+
+                    __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s.x), px), _mm_mul_ps(_mm_set1_ps(s.y), py)),
+                                                     _mm_mul_ps(_mm_set1_ps(s.z), pz)), inv);
+                    __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_set1_ps(q.x)), _mm_mul_ps(dy, _mm_set1_ps(q.y))),
+                                                     _mm_mul_ps(dz, _mm_set1_ps(q.z))), inv);
+                    __m128 t = _mm_mul_ps(_mm_set1_ps(glm::dot(e2, q)), inv);
+                    valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+                    valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+                    valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpgt_ps(t, minDistance), _mm_cmplt_ps(t, best)));
+                    best = _mm_or_ps(_mm_and_ps(valid, t), _mm_andnot_ps(valid, best));
+                }
+            }
+        }
+        _mm_storeu_ps(t, best);
+#else
+        for (int k = 0; k < 4; k++) t[k] = traceRay(bvh, origin, dirs[k]);
+#endif
+    }
+};
+
+// --- HILO DEL SENSOR ---
+class LidarSensor {
+public:
+    // 'threads': hilos de trazado además del propio del sensor.
+    explicit LidarSensor(const LidarSettings& settings, unsigned int threads = std::max(1u, defaultWorkerThreads() / 2))
+        : scanner(settings), pool(threads) {}
+
+    ~LidarSensor() { stop(); }
+    LidarSensor(const LidarSensor&) = delete;
+    LidarSensor& operator=(const LidarSensor&) = delete;
+
+    // Agrega cada barrido a 'path' (ver el formato arriba). Antes de start().
+    bool record(const std::string& path) {
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        const LidarSettings& s = scanner.config();
+        LidarFileHeader header = { { 'L', 'D', 'R', '1' }, (uint32_t)s.beams, (uint32_t)s.azimuthSteps,
+                                   s.minElevation, s.maxElevation, s.range };
+        file.write((const char*)&header, sizeof(header));
+        return (bool)file;
+    }
+
+    void start() {
+        stop();
+        running = true;
+        worker = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        running = false;
+        if (worker.joinable()) worker.join();
+        if (file.is_open()) file.flush();
+    }
+
+    // Hilo de render: pose del frame actual.
+    void submitPose(const LidarPose& pose) {
+        poses.back() = pose;
+        poses.publish();
+    }
+
+    // Cualquier hilo: geometría contra la que se traza (como DronePhysics::setCollision).
+    void setGeometry(std::shared_ptr<const CollisionBVH> bvh) {
+        std::atomic_store(&geometry, std::move(bvh));
+    }
+
+    // Lector: último barrido completo; nullptr antes del primero. Sigue
+    // válido hasta la siguiente llamada.
+    const LidarScan* latest() {
+        scans.update();
+        return scans.front().sequence > 0 ? &scans.front() : nullptr;
+    }
+
+    uint64_t scanCount() const { return completed; }
+    double tracedMilliseconds() const { return totalMs; }
+    size_t pointsPerScan() const { return scanner.pointCount(); }
+
+private:
+    LidarScanner scanner;
+    ThreadPool pool;
+    std::shared_ptr<const CollisionBVH> geometry;       // se lee y escribe con atomic_load/atomic_store
+    TripleBuffer<LidarPose> poses;
+    TripleBuffer<LidarScan> scans;
+    std::ofstream file;
+    std::atomic<bool> running{ false };
+    std::atomic<uint64_t> completed{ 0 };
+    std::atomic<double> totalMs{ 0.0 };
+    std::thread worker;
+
+    void run() {
+        using Clock = std::chrono::steady_clock;
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / scanner.config().rate));
+        uint64_t sequence = 0;
+        uint32_t overruns = 0;
+        auto next = Clock::now();
+
+        while (running) {
+            poses.update();
+            const LidarPose pose = poses.front();
+            std::shared_ptr<const CollisionBVH> bvh = std::atomic_load(&geometry);
+
+            LidarScan& scan = scans.back();
+            auto start = Clock::now();
+            scan.points.resize(scanner.pointCount());       // solo reserva la primera vez por buffer
+            scan.hits = bvh ? scanner.scan(*bvh, pose, pool, scan.points.data()) : 0;
+            if (!bvh) std::fill(scan.points.begin(), scan.points.end(), LidarPoint{ 0.0f, 0.0f, 0.0f, 0.0f });
+            scan.milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            scan.sequence = ++sequence;
+            scan.pose = pose;
+            scan.overruns = overruns;
+            if (file.is_open()) write(scan);
+            scans.publish();
+            completed = sequence;
+            totalMs = totalMs + scan.milliseconds;
+
+            // A ritmo fijo; si un barrido se pasó del período, el siguiente sale ya
+            next += period;
+            auto now = Clock::now();
+            if (next < now) {
+                overruns++;
+                next = now;
+            }
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    void write(const LidarScan& scan) {
+        LidarScanHeader header = { scan.sequence, scan.pose.time,
+                                   { scan.pose.position.x, scan.pose.position.y, scan.pose.position.z }, scan.pose.yaw };
+        file.write((const char*)&header, sizeof(header));
+        file.write((const char*)scan.points.data(), (std::streamsize)(scan.points.size() * sizeof(LidarPoint)));
+    }
+};
+
+#endif
@@ -0,0 +1,313 @@
+#ifndef LIGHT_CLUSTERS_H
+#define LIGHT_CLUSTERS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Iluminación forward por clusters: el frustum de la cámara se divide en una
+// rejilla de 16x8 tiles y 24 cortes de profundidad exponenciales. Cada frame
+// la CPU asigna cada luz a los clusters que toca su esfera de influencia y
+// sube tres buffer textures (datos de luz, rejilla offset/cantidad e índices).
+// lighting.fs solo recorre las luces de su propio cluster.
+
+const int CLUSTER_X = 16;
+const int CLUSTER_Y = 8;
+const int CLUSTER_Z = 24;
+const int CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+
+// Deben coincidir con la atenuación de lighting.fs.
+const float LIGHT_ATTEN_LINEAR = 0.7f;
+const float LIGHT_ATTEN_QUADRATIC = 1.8f;
+const float LIGHT_CUTOFF = 1.0f / 256.0f;   // aporte por debajo del cual la luz se ignora
+
+// Unidades de textura reservadas para los buffers de luces (las mallas usan las primeras).
+const int LIGHT_DATA_UNIT = 8;
+const int CLUSTER_GRID_UNIT = 9;
+const int LIGHT_INDEX_UNIT = 10;
+
+struct PointLight {
+    glm::vec3 position;
+    glm::vec3 color;
+    float intensity;
+};
+
+// Distancia a la que intensity / (1 + kl*d + kq*d^2) cae a LIGHT_CUTOFF.
+inline float lightInfluenceRadius(float intensity) {
+    float ratio = intensity / LIGHT_CUTOFF;
+    if (ratio <= 1.0f) return 0.0f;
+    float disc = LIGHT_ATTEN_LINEAR * LIGHT_ATTEN_LINEAR + 4.0f * LIGHT_ATTEN_QUADRATIC * (ratio - 1.0f);
+    return (-LIGHT_ATTEN_LINEAR + std::sqrt(disc)) / (2.0f * LIGHT_ATTEN_QUADRATIC);
+}
+
+struct ClusterStats {
+    int lights = 0;          // luces con radio > 0
+    int references = 0;      // entradas totales en la lista de índices
+    int maxPerCluster = 0;
+};
+
+class LightClusters {
+public:
+    ClusterStats stats;
+
+    LightClusters() {
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+        const GLenum formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+        for (int i = 0; i < 3; i++) {
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+        }
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        grid.resize(CLUSTER_COUNT * 2);
+    }
+
+    ~LightClusters() {
+        glDeleteTextures(3, textures);
+        glDeleteBuffers(3, buffers);
+    }
+
+    LightClusters(const LightClusters&) = delete;
+    LightClusters& operator=(const LightClusters&) = delete;
+
+    // Parámetros de la proyección en perspectiva con la que se renderiza.
+    void setProjection(float fovY, float aspect, float zNear, float zFar) {
+        if (fovY == projFovY && aspect == projAspect && zNear == nearPlane && zFar == farPlane) return;
+        projFovY = fovY;
+        projAspect = aspect;
+        nearPlane = zNear;
+        farPlane = zFar;
+        tanHalfFov = std::tan(fovY * 0.5f);
+        buildClusterBounds();
+    }
+
+    // Asigna las luces a los clusters (en paralelo por bandas de profundidad) y sube los buffers.
+    void update(const std::vector<PointLight>& lights, const glm::mat4& view, ThreadPool& pool) {
+        prepareLights(lights, view);
+
+        const int bands = (int)std::min<size_t>(CLUSTER_Z, pool.size() + 1);
+        bandIndices.resize(bands);
+        bandStart.assign(bands + 1, 0);
+        for (int b = 0; b <= bands; b++) bandStart[b] = CLUSTER_Z * b / bands;
+
+        pool.parallelFor((size_t)bands, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; b++) binBand((int)b);
+        });
+
+        // Concatena las bandas; los offsets de cada banda pasan a ser absolutos.
+        indices.clear();
+        stats.references = 0;
+        stats.maxPerCluster = 0;
+        for (int b = 0; b < bands; b++) {
+            uint32_t base = (uint32_t)indices.size();
+            int firstCluster = bandStart[b] * CLUSTER_X * CLUSTER_Y;
+            int lastCluster = bandStart[b + 1] * CLUSTER_X * CLUSTER_Y;
+            for (int c = firstCluster; c < lastCluster; c++) {
+                grid[c * 2] += base;
+                stats.maxPerCluster = std::max(stats.maxPerCluster, (int)grid[c * 2 + 1]);
+            }
+            indices.insert(indices.end(), bandIndices[b].begin(), bandIndices[b].end());
+        }
+        stats.references = (int)indices.size();
+        if (indices.empty()) indices.push_back(0);   // un TBO vacío no es válido
+
+        upload();
+    }
+
+    // Una vez por programa: unidades de los samplers de lighting.fs.
+    void setSamplers(GLuint program) const {
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "lightData"), LIGHT_DATA_UNIT);
+        glUniform1i(glGetUniformLocation(program, "clusterGrid"), CLUSTER_GRID_UNIT);
+        glUniform1i(glGetUniformLocation(program, "lightIndices"), LIGHT_INDEX_UNIT);
+    }
+
+    // Cada frame: enlaza los tres buffer textures.
+    void bindBuffers() const {
+        glActiveTexture(GL_TEXTURE0 + LIGHT_DATA_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[0]);
+        glActiveTexture(GL_TEXTURE0 + CLUSTER_GRID_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[1]);
+        glActiveTexture(GL_TEXTURE0 + LIGHT_INDEX_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[2]);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // Parámetros de la rejilla para el bloque FrameData (ver render_queue.h).
+    void frameParams(int viewportWidth, int viewportHeight, glm::ivec4& dims, glm::vec4& params) const {
+        dims = glm::ivec4(CLUSTER_X, CLUSTER_Y, CLUSTER_Z, 0);
+        params = glm::vec4((float)viewportWidth, (float)viewportHeight,
+                           nearPlane, CLUSTER_Z / std::log(farPlane / nearPlane));
+    }
+
+private:
+    struct ViewLight {
+        glm::vec3 center;       // espacio de vista
+        float radius;
+        int sliceMin, sliceMax;
+        int tileMinX, tileMaxX, tileMinY, tileMaxY;
+    };
+
+    struct ClusterBounds {
+        glm::vec3 boundsMin, boundsMax;
+    };
+
+    unsigned int buffers[3];
+    unsigned int textures[3];
+    float projFovY = 0.0f, projAspect = 0.0f, nearPlane = 0.1f, farPlane = 500.0f, tanHalfFov = 1.0f;
+
+    std::vector<ClusterBounds> clusterBounds;
+    std::vector<ViewLight> viewLights;
+    std::vector<glm::vec4> lightData;
+    std::vector<uint32_t> grid;          // (offset, cantidad) por cluster
+    std::vector<uint32_t> indices;
+    std::vector<std::vector<uint32_t>> bandIndices;
+    std::vector<int> bandStart;
+
+    float sliceDepth(int slice) const {
+        return nearPlane * std::pow(farPlane / nearPlane, (float)slice / CLUSTER_Z);
+    }
+
+    int depthSlice(float depth) const {
+        if (depth <= nearPlane) return 0;
+        int s = (int)std::floor(std::log(depth / nearPlane) * CLUSTER_Z / std::log(farPlane / nearPlane));
+        return std::min(std::max(s, 0), CLUSTER_Z - 1);
+    }
+
+    // AABB en espacio de vista de cada cluster (solo cambia con la proyección).
+    void buildClusterBounds() {
+        clusterBounds.resize(CLUSTER_COUNT);
+        for (int z = 0; z < CLUSTER_Z; z++) {
+            float d0 = sliceDepth(z), d1 = sliceDepth(z + 1);
+            for (int y = 0; y < CLUSTER_Y; y++) {
+                float ny0 = -1.0f + 2.0f * y / CLUSTER_Y, ny1 = -1.0f + 2.0f * (y + 1) / CLUSTER_Y;
+                for (int x = 0; x < CLUSTER_X; x++) {
+                    float nx0 = -1.0f + 2.0f * x / CLUSTER_X, nx1 = -1.0f + 2.0f * (x + 1) / CLUSTER_X;
+                    glm::vec3 bmin(1e30f), bmax(-1e30f);
+                    for (float d : { d0, d1 }) {
+                        float hh = d * tanHalfFov, hw = hh * projAspect;
+                        for (float nx : { nx0, nx1 })
+                            for (float ny : { ny0, ny1 }) {
+                                glm::vec3 p(nx * hw, ny * hh, -d);
+                                bmin = glm::min(bmin, p);
+                                bmax = glm::max(bmax, p);
+                            }
+                    }
+                    clusterBounds[(z * CLUSTER_Y + y) * CLUSTER_X + x] = { bmin, bmax };
+                }
+            }
+        }
+    }
+
+    void prepareLights(const std::vector<PointLight>& lights, const glm::mat4& view) {
+        viewLights.clear();
+        lightData.clear();
+        stats.lights = 0;
+        const float p00 = 1.0f / (projAspect * tanHalfFov), p11 = 1.0f / tanHalfFov;
+
+        for (size_t i = 0; i < lights.size(); i++) {
+            const PointLight& light = lights[i];
+            float radius = lightInfluenceRadius(light.intensity);
+            lightData.push_back(glm::vec4(light.position, radius));
+            lightData.push_back(glm::vec4(light.color, light.intensity));
+
+            ViewLight vl;
+            vl.center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+            vl.radius = radius;
+            float zMin = -vl.center.z - radius, zMax = -vl.center.z + radius;
+            if (radius <= 0.0f || zMax < nearPlane || zMin > farPlane) {
+                vl.sliceMin = 1;
+                vl.sliceMax = 0;   // rango vacío
+                viewLights.push_back(vl);
+                continue;
+            }
+            stats.lights++;
+            vl.sliceMin = depthSlice(zMin);
+            vl.sliceMax = depthSlice(zMax);
+
+            // Rectángulo en NDC que cubre la caja de la esfera (recortada al plano cercano).
+            float ndcMinX = 1e30f, ndcMaxX = -1e30f, ndcMinY = 1e30f, ndcMaxY = -1e30f;
+            for (int c = 0; c < 8; c++) {
+                glm::vec3 corner = vl.center + glm::vec3((c & 1) ? radius : -radius,
+                                                         (c & 2) ? radius : -radius,
+                                                         (c & 4) ? radius : -radius);
+                float depth = std::max(-corner.z, nearPlane);
+                float nx = corner.x * p00 / depth, ny = corner.y * p11 / depth;
+                ndcMinX = std::min(ndcMinX, nx); ndcMaxX = std::max(ndcMaxX, nx);
+                ndcMinY = std::min(ndcMinY, ny); ndcMaxY = std::max(ndcMaxY, ny);
+            }
+            auto tile = [](float ndc, int count) {
+                return std::min(std::max((int)std::floor((ndc * 0.5f + 0.5f) * count), 0), count - 1);
+            };
+            vl.tileMinX = tile(ndcMinX, CLUSTER_X); vl.tileMaxX = tile(ndcMaxX, CLUSTER_X);
+            vl.tileMinY = tile(ndcMinY, CLUSTER_Y); vl.tileMaxY = tile(ndcMaxY, CLUSTER_Y);
+            if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f) {
+                vl.sliceMin = 1;
+                vl.sliceMax = 0;   // fuera de pantalla
+            }
+            viewLights.push_back(vl);
+        }
+        if (lightData.empty()) lightData.push_back(glm::vec4(0.0f));
+    }
+
+    bool sphereTouchesCluster(const ViewLight& light, int cluster) const {
+        const ClusterBounds& b = clusterBounds[cluster];
+        glm::vec3 q = glm::clamp(light.center, b.boundsMin, b.boundsMax);
+        glm::vec3 d = light.center - q;
+        return glm::dot(d, d) <= light.radius * light.radius;
+    }
+
+    // Dos pasadas (contar y llenar) sobre las luces para los cortes de una banda.
+    void binBand(int band) {
+        const int z0 = bandStart[band], z1 = bandStart[band + 1];
+        const int firstCluster = z0 * CLUSTER_X * CLUSTER_Y;
+        const int lastCluster = z1 * CLUSTER_X * CLUSTER_Y;
+        for (int c = firstCluster; c < lastCluster; c++) grid[c * 2 + 1] = 0;
+
+        auto forEachTouched = [&](auto&& visit) {
+            for (uint32_t li = 0; li < (uint32_t)viewLights.size(); li++) {
+                const ViewLight& light = viewLights[li];
+                int s0 = std::max(light.sliceMin, z0), s1 = std::min(light.sliceMax, z1 - 1);
+                for (int z = s0; z <= s1; z++)
+                    for (int y = light.tileMinY; y <= light.tileMaxY; y++)
+                        for (int x = light.tileMinX; x <= light.tileMaxX; x++) {
+                            int cluster = (z * CLUSTER_Y + y) * CLUSTER_X + x;
+                            if (sphereTouchesCluster(light, cluster)) visit(cluster, li);
+                        }
+            }
+        };
+
+        forEachTouched([&](int cluster, uint32_t) { grid[cluster * 2 + 1]++; });
+
+        uint32_t offset = 0;
+        for (int c = firstCluster; c < lastCluster; c++) {
+            grid[c * 2] = offset;
+            offset += grid[c * 2 + 1];
+            grid[c * 2 + 1] = 0;
+        }
+
+        std::vector<uint32_t>& out = bandIndices[band];
+        out.resize(offset);
+        forEachTouched([&](int cluster, uint32_t li) {
+            out[grid[cluster * 2] + grid[cluster * 2 + 1]++] = li;
+        });
+    }
+
+    void upload() {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[0]);
+        glBufferData(GL_TEXTURE_BUFFER, lightData.size() * sizeof(glm::vec4), lightData.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[1]);
+        glBufferData(GL_TEXTURE_BUFFER, grid.size() * sizeof(uint32_t), grid.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[2]);
+        glBufferData(GL_TEXTURE_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef LOD_SELECTION_H
+#define LOD_SELECTION_H
+
+#include <glm/glm.hpp>
+
+#include "scene_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Elección del nivel de detalle por tamaño proyectado: el error geométrico del
+// nivel (mesh_lod.h), escalado por la transformación del objeto y proyectado a
+// la distancia de la cámara, tiene que quedar por debajo de LOD_PIXEL_ERROR.
+// Para bajar de detalle el siguiente nivel debe quedar bastante por debajo
+// (LOD_HYSTERESIS), así un objeto en el límite no alterna entre dos niveles.
+
+const float LOD_PIXEL_ERROR = 1.0f;
+const float LOD_HYSTERESIS = 0.6f;
+
+class LodSelector {
+public:
+    float pixelError = LOD_PIXEL_ERROR;
+
+    // Píxeles por unidad de mundo a distancia 1 para la proyección actual.
+    void setViewport(float fovY, int heightPixels) {
+        pixelsPerUnit = (float)heightPixels / (2.0f * std::tan(fovY * 0.5f));
+    }
+
+    // 'key' identifica al objeto entre frames (p. ej. su id del SceneCuller).
+    int select(int key, const SceneModel& model, const glm::mat4& transform, const glm::vec3& cameraPos) {
+        if (key < 0) return 0;
+        if ((size_t)key >= current.size()) current.resize(key + 1, 0);
+        int levels = model.lodLevels();
+        if (levels <= 1) return current[key] = 0;
+
+        float scale = std::max(glm::length(glm::vec3(transform[0])),
+                      std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+        glm::vec3 center = glm::vec3(transform * glm::vec4((model.boundsMin + model.boundsMax) * 0.5f, 1.0f));
+        float radius = glm::length(model.boundsMax - model.boundsMin) * 0.5f * scale;
+        float distance = std::max(glm::length(center - cameraPos) - radius, 0.1f);
+        const float pixelsPerWorldUnit = pixelsPerUnit * scale / distance;
+
+        int& level = current[key];
+        level = std::min(level, levels - 1);
+        while (level > 0 && model.lodError(level) * pixelsPerWorldUnit > pixelError) level--;
+        while (level + 1 < levels && model.lodError(level + 1) * pixelsPerWorldUnit < pixelError * LOD_HYSTERESIS) level++;
+        return level;
+    }
+
+    // Sin histéresis ni estado, para muchas copias de un mismo modelo (el enjambre).
+    int levelAt(const SceneModel& model, float scale, float distance) const {
+        const float pixelsPerWorldUnit = pixelsPerUnit * scale / std::max(distance, 0.1f);
+        int level = 0;
+        while (level + 1 < model.lodLevels() && model.lodError(level + 1) * pixelsPerWorldUnit < pixelError) level++;
+        return level;
+    }
+
+private:
+    float pixelsPerUnit = 1.0f;
+    std::vector<int> current;
+};
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef MESH_ANALYSIS_H
+#define MESH_ANALYSIS_H
+
+#include <glm/glm.hpp>
+#include <learnopengl/mesh.h>
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESH_ANALYSIS_SSE 1
+#include <emmintrin.h>
+#endif
+
+// Análisis de mallas en una sola pasada: caja, centroide (promedio de los
+// vértices), esfera envolvente y cantidad de triángulos. Las posiciones se
+// copian primero a una vista SoA (x[], y[], z[] contiguos) y sobre ella corren
+// kernels SSE de mínimo/máximo/suma de 4 en 4; analyzeMeshes reparte las
+// mallas entre los hilos del pool, la más grande primero.
+
+struct MeshStats {
+    glm::vec3 boundsMin = glm::vec3(1e10f);
+    glm::vec3 boundsMax = glm::vec3(-1e10f);   // min > max si la malla no tiene vértices
+    glm::vec3 centroid = glm::vec3(0.0f);
+    glm::vec3 sphereCenter = glm::vec3(0.0f);  // centro de la caja
+    float sphereRadius = 0.0f;
+    uint32_t vertexCount = 0;
+    uint32_t triangleCount = 0;
+};
+
+// Vista SoA de las posiciones; se reutiliza entre mallas para no reservar cada vez.
+struct PositionView {
+    std::vector<float> x, y, z;
+
+    void assign(const Vertex* vertices, size_t count) {
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            const glm::vec3& p = vertices[i].Position;
+            x[i] = p.x;
+            y[i] = p.y;
+            z[i] = p.z;
+        }
+    }
+};
+
+namespace analysis_detail {
+
+// Mínimo, máximo y suma de un arreglo de floats.
+inline void minMaxSum(const float* v, size_t n, float& mn, float& mx, float& sum) {
+    size_t i = 0;
+    mn = 1e10f;
+    mx = -1e10f;
+    sum = 0.0f;
+#ifdef MESH_ANALYSIS_SSE
+    if (n >= 8) {
+        // Dos acumuladores por operación para no encadenar cada suma con la anterior
+        __m128 mn0 = _mm_loadu_ps(v), mn1 = _mm_loadu_ps(v + 4);
+        __m128 mx0 = mn0, mx1 = mn1;
+        __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+        for (; i + 8 <= n; i += 8) {
+            __m128 a = _mm_loadu_ps(v + i), b = _mm_loadu_ps(v + i + 4);
+            mn0 = _mm_min_ps(mn0, a); mn1 = _mm_min_ps(mn1, b);
+            mx0 = _mm_max_ps(mx0, a); mx1 = _mm_max_ps(mx1, b);
+            s0 = _mm_add_ps(s0, a); s1 = _mm_add_ps(s1, b);
+        }
+        alignas(16) float lanesMin[4], lanesMax[4], lanesSum[4];
+        _mm_store_ps(lanesMin, _mm_min_ps(mn0, mn1));
+        _mm_store_ps(lanesMax, _mm_max_ps(mx0, mx1));
+        _mm_store_ps(lanesSum, _mm_add_ps(s0, s1));
+        for (int k = 0; k < 4; k++) {
+            mn = std::min(mn, lanesMin[k]);
+            mx = std::max(mx, lanesMax[k]);
+            sum += lanesSum[k];
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        mn = std::min(mn, v[i]);
+        mx = std::max(mx, v[i]);
+        sum += v[i];
+    }
+}
+
+// Mayor distancia al cuadrado desde 'c' a los puntos (x[i], y[i], z[i]).
+inline float maxDistance2(const float* x, const float* y, const float* z, size_t n, const glm::vec3& c) {
+    size_t i = 0;
+    float best = 0.0f;
+#ifdef MESH_ANALYSIS_SSE
+    if (n >= 4) {
+        const __m128 cx = _mm_set1_ps(c.x), cy = _mm_set1_ps(c.y), cz = _mm_set1_ps(c.z);
+        __m128 acc = _mm_setzero_ps();
+        for (; i + 4 <= n; i += 4) {
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), cx);
+            __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), cy);
+            __m128 dz = _mm_sub_ps(_mm_loadu_ps(z + i), cz);
+            __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            acc = _mm_max_ps(acc, d2);
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, acc);
+        best = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    }
+#endif
+    for (; i < n; i++) {
+        float dx = x[i] - c.x, dy = y[i] - c.y, dz = z[i] - c.z;
+        best = std::max(best, dx * dx + dy * dy + dz * dz);
+    }
+    return best;
+}
+
+} // namespace analysis_detail
+
+// Una malla, en el hilo que llama.
+inline MeshStats analyzeMesh(const Vertex* vertices, size_t vertexCount, size_t indexCount, PositionView& view) {
+    MeshStats stats;
+    stats.vertexCount = (uint32_t)vertexCount;
+    stats.triangleCount = (uint32_t)(indexCount / 3);
+    if (vertexCount == 0) return stats;
+
+    view.assign(vertices, vertexCount);
+    glm::vec3 sum;
+    analysis_detail::minMaxSum(view.x.data(), vertexCount, stats.boundsMin.x, stats.boundsMax.x, sum.x);
+    analysis_detail::minMaxSum(view.y.data(), vertexCount, stats.boundsMin.y, stats.boundsMax.y, sum.y);
+    analysis_detail::minMaxSum(view.z.data(), vertexCount, stats.boundsMin.z, stats.boundsMax.z, sum.z);
+    stats.centroid = sum / (float)vertexCount;
+    stats.sphereCenter = (stats.boundsMin + stats.boundsMax) * 0.5f;
+    stats.sphereRadius = std::sqrt(analysis_detail::maxDistance2(view.x.data(), view.y.data(), view.z.data(),
+                                                                 vertexCount, stats.sphereCenter));
+    return stats;
+}
+
+template <typename MeshT>
+MeshStats analyzeMesh(const MeshT& mesh) {
+    thread_local PositionView view;
+    return analyzeMesh(mesh.vertices.data(), mesh.vertices.size(), mesh.indices.size(), view);
+}
+
+// Todas las mallas, repartidas entre los hilos del pool. Cada hilo toma la
+// siguiente malla libre empezando por las más grandes, así una malla enorme
+// no queda para el final en un solo hilo.
+template <typename MeshT>
+std::vector<MeshStats> analyzeMeshes(const std::vector<MeshT>& meshes, ThreadPool& pool) {
+    std::vector<MeshStats> stats(meshes.size());
+    std::vector<uint32_t> order(meshes.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t a, uint32_t b) { return meshes[a].vertices.size() > meshes[b].vertices.size(); });
+
+    std::atomic<size_t> next{ 0 };
+    pool.parallelFor(std::min<size_t>(meshes.size(), pool.size() + 1), [&](size_t, size_t) {
+        for (size_t i = next++; i < order.size(); i = next++)
+            stats[order[i]] = analyzeMesh(meshes[order[i]]);
+    });
+    return stats;
+}
+
+#endif
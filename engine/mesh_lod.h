@@ -0,0 +1,244 @@
+#ifndef MESH_LOD_H
+#define MESH_LOD_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/mesh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+// Niveles de detalle por simplificación con error cuádrico (Garland-Heckbert).
+// Se usa colapso de media arista: un vértice se funde con un vecino que ya
+// existe, así los vértices no cambian y cada nivel es solo otra lista de
+// índices sobre el mismo VBO. Los bordes (incluidas las costuras de UV, que en
+// el espacio de índices son bordes) quedan fijos, de modo que no se abren grietas.
+
+const int MESH_LOD_MAX = 4;                 // nivel 0 (completo) + 3 simplificados
+const size_t MESH_LOD_MIN_TRIANGLES = 256;  // por debajo no vale la pena
+const float MESH_LOD_RATIO = 0.5f;          // triángulos de cada nivel respecto al anterior
+
+struct MeshLod {
+    GLuint firstIndex = 0;      // en el EBO de la malla
+    GLsizei count = 0;
+    float error = 0.0f;         // desviación geométrica aproximada, en unidades del modelo
+};
+
+namespace lod_detail {
+
+// Cuádrica simétrica 4x4: a00 a01 a02 a03 a11 a12 a13 a22 a23 a33
+struct Quadric {
+    double a[10] = {};
+
+    void addPlane(const glm::vec3& n, double d) {
+        a[0] += n.x * n.x; a[1] += n.x * n.y; a[2] += n.x * n.z; a[3] += n.x * d;
+        a[4] += n.y * n.y; a[5] += n.y * n.z; a[6] += n.y * d;
+        a[7] += n.z * n.z; a[8] += n.z * d;
+        a[9] += d * d;
+    }
+
+    void add(const Quadric& o) {
+        for (int i = 0; i < 10; i++) a[i] += o.a[i];
+    }
+
+    double eval(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double e = a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x
+                 + a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+                 + a[7] * z * z + 2.0 * a[8] * z + a[9];
+        return std::max(e, 0.0);
+    }
+};
+
+struct Collapse {
+    double cost;
+    uint32_t from, to;
+    uint32_t stampFrom, stampTo;
+    bool operator<(const Collapse& o) const { return cost > o.cost; }   // min-heap
+};
+
+}
+
+// Genera hasta MESH_LOD_MAX - 1 niveles. 'lodIndices' recibe los índices de
+// los niveles 1.. uno detrás de otro; 'lods' queda con el nivel 0 (los
+// índices originales) y los generados, con firstIndex contado desde el inicio
+// de 'indices', como si ambos arreglos fueran un único EBO.
+inline void generateMeshLods(const Vertex* vertices, size_t vertexCount,
+                             const unsigned int* indices, size_t indexCount,
+                             std::vector<unsigned int>& lodIndices, std::vector<MeshLod>& lods) {
+    using namespace lod_detail;
+    lodIndices.clear();
+    lods.clear();
+    size_t triCount = indexCount / 3;
+    if (triCount < MESH_LOD_MIN_TRIANGLES) return;
+
+    MeshLod full;
+    full.count = (GLsizei)indexCount;
+    lods.push_back(full);
+
+    // Triángulos, adyacencia y cuádricas
+    std::vector<uint32_t> tris(indices, indices + triCount * 3);
+    std::vector<bool> triAlive(triCount, true);
+    std::vector<std::vector<uint32_t>> vertexTris(vertexCount);
+    std::vector<Quadric> quadrics(vertexCount);
+    size_t aliveTris = 0;
+    for (size_t t = 0; t < triCount; t++) {
+        uint32_t a = tris[t * 3], b = tris[t * 3 + 1], c = tris[t * 3 + 2];
+        if (a >= vertexCount || b >= vertexCount || c >= vertexCount || a == b || b == c || a == c) {
+            triAlive[t] = false;
+            continue;
+        }
+        const glm::vec3& p0 = vertices[a].Position;
+        glm::vec3 n = glm::cross(vertices[b].Position - p0, vertices[c].Position - p0);
+        float len = glm::length(n);
+        if (len > 0.0f) {
+            n = n / len;
+            double d = -(double)glm::dot(n, p0);
+            quadrics[a].addPlane(n, d);
+            quadrics[b].addPlane(n, d);
+            quadrics[c].addPlane(n, d);
+        }
+        vertexTris[a].push_back((uint32_t)t);
+        vertexTris[b].push_back((uint32_t)t);
+        vertexTris[c].push_back((uint32_t)t);
+        aliveTris++;
+    }
+
+    // Aristas de borde o no manifold: sus vértices no se mueven
+    std::unordered_map<uint64_t, int> edgeUses;
+    edgeUses.reserve(triCount * 3);
+    auto edgeKey = [](uint32_t a, uint32_t b) {
+        return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+    };
+    for (size_t t = 0; t < triCount; t++) {
+        if (!triAlive[t]) continue;
+        for (int e = 0; e < 3; e++) edgeUses[edgeKey(tris[t * 3 + e], tris[t * 3 + (e + 1) % 3])]++;
+    }
+    std::vector<bool> locked(vertexCount, false);
+    for (const auto& edge : edgeUses) {
+        if (edge.second == 2) continue;
+        locked[(uint32_t)(edge.first >> 32)] = true;
+        locked[(uint32_t)(edge.first & 0xFFFFFFFFu)] = true;
+    }
+
+    std::vector<bool> vertexAlive(vertexCount, true);
+    std::vector<uint32_t> stamp(vertexCount, 0);
+    std::priority_queue<Collapse> heap;
+
+    auto push = [&](uint32_t from, uint32_t to) {
+        if (locked[from]) return;
+        Quadric q = quadrics[from];
+        q.add(quadrics[to]);
+        heap.push({ q.eval(vertices[to].Position), from, to, stamp[from], stamp[to] });
+    };
+    for (size_t t = 0; t < triCount; t++) {
+        if (!triAlive[t]) continue;
+        for (int e = 0; e < 3; e++) {
+            uint32_t a = tris[t * 3 + e], b = tris[t * 3 + (e + 1) % 3];
+            push(a, b);
+            push(b, a);
+        }
+    }
+
+    std::vector<uint32_t> neighborsFrom, neighborsTo;
+    auto gatherNeighbors = [&](uint32_t v, std::vector<uint32_t>& out) {
+        out.clear();
+        for (uint32_t t : vertexTris[v]) {
+            if (!triAlive[t]) continue;
+            for (int k = 0; k < 3; k++)
+                if (tris[t * 3 + k] != v) out.push_back(tris[t * 3 + k]);
+        }
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    };
+
+    // Rechaza colapsos que voltean triángulos o rompen la topología
+    auto valid = [&](uint32_t from, uint32_t to) {
+        gatherNeighbors(from, neighborsFrom);
+        gatherNeighbors(to, neighborsTo);
+        int shared = 0;
+        for (uint32_t n : neighborsFrom)
+            if (std::binary_search(neighborsTo.begin(), neighborsTo.end(), n)) shared++;
+        if (shared > 2) return false;
+
+        const glm::vec3& target = vertices[to].Position;
+        for (uint32_t t : vertexTris[from]) {
+            if (!triAlive[t]) continue;
+            const uint32_t* tri = &tris[t * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to) continue;
+            glm::vec3 p[3], q[3];
+            for (int k = 0; k < 3; k++) {
+                p[k] = vertices[tri[k]].Position;
+                q[k] = tri[k] == from ? target : p[k];
+            }
+            glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+            float lb = glm::length(before), la = glm::length(after);
+            if (la < 1e-12f) return false;
+            if (lb > 1e-12f && glm::dot(before, after) < 0.2f * lb * la) return false;
+        }
+        return true;
+    };
+
+    double maxCost = 0.0;
+    for (int level = 1; level < MESH_LOD_MAX; level++) {
+        size_t target = (size_t)((float)aliveTris * MESH_LOD_RATIO);
+        size_t startTris = aliveTris;
+
+        while (aliveTris > target && !heap.empty()) {
+            Collapse c = heap.top();
+            heap.pop();
+            if (!vertexAlive[c.from] || !vertexAlive[c.to]) continue;
+            if (stamp[c.from] != c.stampFrom || stamp[c.to] != c.stampTo) continue;
+            if (!valid(c.from, c.to)) continue;
+
+            for (uint32_t t : vertexTris[c.from]) {
+                if (!triAlive[t]) continue;
+                uint32_t* tri = &tris[t * 3];
+                if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+                    triAlive[t] = false;
+                    aliveTris--;
+                    continue;
+                }
+                for (int k = 0; k < 3; k++)
+                    if (tri[k] == c.from) tri[k] = c.to;
+                vertexTris[c.to].push_back(t);
+            }
+            vertexTris[c.from].clear();
+            vertexAlive[c.from] = false;
+            quadrics[c.to].add(quadrics[c.from]);
+            maxCost = std::max(maxCost, c.cost);
+
+            // Solo cambió la cuádrica del vértice que queda: se invalidan sus
+            // aristas (las de los vecinos entre sí siguen en la cola) y se reencolan
+            gatherNeighbors(c.to, neighborsTo);
+            stamp[c.to]++;
+            for (uint32_t n : neighborsTo) {
+                push(n, c.to);
+                push(c.to, n);
+            }
+        }
+
+        // Sin una reducción real no tiene sentido otro nivel
+        if (aliveTris * 10 > startTris * 9 || aliveTris == 0) break;
+
+        MeshLod lod;
+        lod.firstIndex = (GLuint)(indexCount + lodIndices.size());
+        for (size_t t = 0; t < triCount; t++) {
+            if (!triAlive[t]) continue;
+            lodIndices.insert(lodIndices.end(), &tris[t * 3], &tris[t * 3] + 3);
+        }
+        lod.count = (GLsizei)(indexCount + lodIndices.size() - lod.firstIndex);
+        lod.error = (float)std::sqrt(maxCost);
+        lods.push_back(lod);
+    }
+
+    if (lods.size() == 1) lods.clear();
+}
+
+#endif
@@ -0,0 +1,291 @@
+#ifndef OCCLUSION_CULLING_H
+#define OCCLUSION_CULLING_H
+
+#include <glm/glm.hpp>
+
+#include "scene_cache.h"
+#include "scene_culling.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_SSE 1
+#include <emmintrin.h>
+#endif
+
+// Oclusión en CPU para los interiores: unas pocas mallas grandes y de pocos
+// triángulos (paredes, pisos) de los modelos marcados como "occluder" se
+// rasterizan cada frame en un búfer de profundidad chico, repartido en franjas
+// de filas entre los hilos del pool. Después cada malla que pasó el frustum
+// proyecta su caja y se descarta si en todo su rectángulo hay un oclusor más
+// cerca que el punto más cercano de la caja. No usa la GPU, así que también
+// corre en el modo sin ventana.
+//
+// El búfer guarda 1/w (0 = nada), que sí es lineal en pantalla; más grande es
+// más cerca. Los píxeles se cubren por su centro, como en los rasterizadores
+// de oclusión habituales: un hueco más fino que un píxel del búfer puede
+// quedar tapado.
+
+const int OCCLUSION_WIDTH = 256;
+const int OCCLUSION_HEIGHT = 128;
+const int OCCLUSION_BAND_ROWS = 16;                 // filas por tarea del pool
+const float OCCLUSION_NEAR_W = 0.1f;                // plano cercano de la cámara
+const float OCCLUSION_DEPTH_BIAS = 1e-3f;           // margen relativo a favor de "visible"
+
+// Qué mallas de un modelo marcado sirven de oclusor
+const float OCCLUDER_MIN_EXTENT = 2.0f;             // las dos dimensiones mayores de su caja
+const size_t OCCLUDER_MAX_TRIANGLES = 512;          // paredes y pisos tienen pocos triángulos
+const size_t OCCLUDER_TRIANGLE_BUDGET = 8192;       // total, las de mayor área primero
+
+struct OcclusionStats {
+    int occluderMeshes = 0;
+    int occluderTriangles = 0;      // en mundo, tras la selección
+    int rasterTriangles = 0;        // en pantalla en el último frame (tras el recorte cercano)
+};
+
+class OcclusionCuller {
+public:
+    OcclusionStats stats;
+
+    OcclusionCuller() : depth((size_t)OCCLUSION_WIDTH * OCCLUSION_HEIGHT, 0.0f) {}
+
+    // Propone como oclusores las mallas grandes de un modelo inmóvil. 'accept'
+    // deja afuera las que no tapan de verdad (p. ej. texturas con recortes alfa).
+    void addOccluderModel(const SceneModel& model, const glm::mat4& transform,
+                          const std::function<bool(const SceneMesh&)>& accept) {
+        for (const auto& mesh : model.meshes) {
+            size_t triangles = mesh.indices.size() / 3;
+            if (triangles == 0 || triangles > OCCLUDER_MAX_TRIANGLES) continue;
+            glm::vec3 mn, mx;
+            transformBounds(transform, mesh.boundsMin, mesh.boundsMax, mn, mx);
+            glm::vec3 size = mx - mn;
+            float a = size.x, b = size.y, c = size.z;
+            if (a < b) std::swap(a, b);
+            if (b < c) std::swap(b, c);
+            if (a < b) std::swap(a, b);
+            if (b < OCCLUDER_MIN_EXTENT || !accept(mesh)) continue;
+            candidates.push_back({ &mesh, transform, a * b });
+        }
+    }
+
+    // Elige los candidatos de mayor área hasta el presupuesto de triángulos y
+    // copia sus triángulos en mundo (los modelos oclusores no se mueven).
+    void build() {
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [](const Candidate& x, const Candidate& y) { return x.area > y.area; });
+        triangles.clear();
+        stats = OcclusionStats();
+        for (const auto& c : candidates) {
+            const SceneMesh& mesh = *c.mesh;
+            if (triangles.size() / 3 + mesh.indices.size() / 3 > OCCLUDER_TRIANGLE_BUDGET) continue;
+            for (unsigned int index : mesh.indices)
+                triangles.push_back(glm::vec3(c.transform * glm::vec4(mesh.vertices[index].Position, 1.0f)));
+            stats.occluderMeshes++;
+        }
+        candidates.clear();
+        stats.occluderTriangles = (int)(triangles.size() / 3);
+        screen.resize(triangles.size() / 3 * 2);    // el recorte cercano parte un triángulo en dos como mucho
+    }
+
+    bool empty() const { return triangles.empty(); }
+
+    // Rasteriza los oclusores vistos desde 'viewProjection'.
+    void render(const glm::mat4& viewProjection, ThreadPool& pool) {
+        this->viewProjection = viewProjection;
+        std::fill(depth.begin(), depth.end(), 0.0f);
+        stats.rasterTriangles = 0;
+        if (triangles.empty()) return;
+
+        // 1. Triángulos a pantalla, repartidos por bloques
+        const size_t count = triangles.size() / 3;
+        pool.parallelFor(count, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; t++) setupTriangle(t);
+        }, 256);
+        for (const auto& tri : screen)
+            if (tri.valid) stats.rasterTriangles++;
+
+        // 2. Cada franja de filas la pinta un solo hilo: sin escrituras compartidas
+        const int bands = (OCCLUSION_HEIGHT + OCCLUSION_BAND_ROWS - 1) / OCCLUSION_BAND_ROWS;
+        pool.parallelFor((size_t)bands, [&](size_t begin, size_t end) {
+            for (size_t band = begin; band < end; band++) {
+                int y0 = (int)band * OCCLUSION_BAND_ROWS;
+                int y1 = std::min(y0 + OCCLUSION_BAND_ROWS, OCCLUSION_HEIGHT);
+                for (const auto& tri : screen)
+                    if (tri.valid && tri.maxY >= y0 && tri.minY < y1) rasterize(tri, y0, y1);
+            }
+        });
+    }
+
+    // false si la caja en mundo queda entera detrás de los oclusores.
+    bool visible(const glm::vec3& mn, const glm::vec3& mx) const {
+        if (stats.rasterTriangles == 0) return true;
+        float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, nearest = 0.0f;
+        for (int corner = 0; corner < 8; corner++) {
+            glm::vec4 p = viewProjection * glm::vec4(corner & 1 ? mx.x : mn.x, corner & 2 ? mx.y : mn.y,
+                                                     corner & 4 ? mx.z : mn.z, 1.0f);
+            if (!(p.w > OCCLUSION_NEAR_W)) return true;     // la caja cruza el plano cercano
+            float invW = 1.0f / p.w;
+            float x = (p.x * invW * 0.5f + 0.5f) * OCCLUSION_WIDTH;
+            float y = (p.y * invW * 0.5f + 0.5f) * OCCLUSION_HEIGHT;
+            minX = std::min(minX, x); maxX = std::max(maxX, x);
+            minY = std::min(minY, y); maxY = std::max(maxY, y);
+            nearest = std::max(nearest, invW);      // w es lineal: el punto más cercano es un vértice
+        }
+        // Todos los píxeles que toca el rectángulo
+        int x0, x1, y0, y1;
+        pixelRange(minX, maxX, OCCLUSION_WIDTH, false, x0, x1);
+        pixelRange(minY, maxY, OCCLUSION_HEIGHT, false, y0, y1);
+        if (x0 > x1 || y0 > y1) return true;        // fuera del búfer: lo decide el frustum
+
+        const float threshold = nearest * (1.0f + OCCLUSION_DEPTH_BIAS);
+        for (int y = y0; y <= y1; y++) {
+            const float* row = depth.data() + (size_t)y * OCCLUSION_WIDTH;
+            int x = x0;
+#ifdef OCCLUSION_SSE
+            const __m128 limit = _mm_set1_ps(threshold);
+            for (; x + 4 <= x1 + 1; x += 4)
+                if (_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(row + x), limit))) return true;
+#endif
+            for (; x <= x1; x++)
+                if (row[x] < threshold) return true;
+        }
+        return false;
+    }
+
+    // Para depurar: OCCLUSION_WIDTH x OCCLUSION_HEIGHT valores de 1/w, fila 0 abajo.
+    const std::vector<float>& depthBuffer() const { return depth; }
+
+private:
+    struct Candidate {
+        const SceneMesh* mesh;
+        glm::mat4 transform;
+        float area;
+    };
+
+    struct ScreenTriangle {
+        glm::vec2 v[3];
+        float invW[3];
+        int minX, maxX, minY, maxY;
+        bool valid = false;
+    };
+
+    std::vector<Candidate> candidates;
+    std::vector<glm::vec3> triangles;           // 3 vértices en mundo por triángulo
+    std::vector<ScreenTriangle> screen;         // 2 por triángulo de 'triangles'
+    std::vector<float> depth;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+
+    // Píxeles [first, last] de [0, size) entre 'lo' y 'hi': con 'centers' solo
+    // los que tienen el centro adentro, si no todos los que toca.
+    static void pixelRange(float lo, float hi, int size, bool centers, int& first, int& last) {
+        lo = std::min(std::max(lo, -1.0f), (float)size + 1.0f);     // sin desbordar el int
+        hi = std::min(std::max(hi, -1.0f), (float)size + 1.0f);
+        first = std::max(0, centers ? (int)std::ceil(lo - 0.5f) : (int)std::floor(lo));
+        last = std::min(size - 1, (int)std::floor(centers ? hi - 0.5f : hi));
+    }
+
+    // Recorta contra w = OCCLUSION_NEAR_W (quedan 0, 3 o 4 vértices) y pasa a píxeles.
+    void setupTriangle(size_t t) {
+        ScreenTriangle* out = &screen[t * 2];
+        out[0].valid = out[1].valid = false;
+
+        glm::vec4 in[3], poly[4];
+        int n = 0;
+        for (int k = 0; k < 3; k++) in[k] = viewProjection * glm::vec4(triangles[t * 3 + k], 1.0f);
+        for (int k = 0; k < 3; k++) {
+            const glm::vec4& a = in[k];
+            const glm::vec4& b = in[(k + 1) % 3];
+            bool aIn = a.w >= OCCLUSION_NEAR_W, bIn = b.w >= OCCLUSION_NEAR_W;
+            if (aIn) poly[n++] = a;
+            if (aIn != bIn) poly[n++] = a + (b - a) * ((OCCLUSION_NEAR_W - a.w) / (b.w - a.w));
+        }
+        if (n < 3) return;
+
+        glm::vec2 v[4];
+        float invW[4];
+        for (int k = 0; k < n; k++) {
+            invW[k] = 1.0f / poly[k].w;
+            v[k] = glm::vec2((poly[k].x * invW[k] * 0.5f + 0.5f) * OCCLUSION_WIDTH,
+                             (poly[k].y * invW[k] * 0.5f + 0.5f) * OCCLUSION_HEIGHT);
+        }
+        makeTriangle(out[0], v[0], v[1], v[2], invW[0], invW[1], invW[2]);
+        if (n == 4) makeTriangle(out[1], v[0], v[2], v[3], invW[0], invW[2], invW[3]);
+    }
+
+    static void makeTriangle(ScreenTriangle& tri, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c,
+                             float wa, float wb, float wc) {
+        float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (!(std::fabs(area) > 1e-6f)) return;     // degenerado (o NaN)
+        // Caja en píxeles cuyos centros (x + 0.5) pueden caer adentro
+        float minX = std::min(a.x, std::min(b.x, c.x)), maxX = std::max(a.x, std::max(b.x, c.x));
+        float minY = std::min(a.y, std::min(b.y, c.y)), maxY = std::max(a.y, std::max(b.y, c.y));
+        pixelRange(minX, maxX, OCCLUSION_WIDTH, true, tri.minX, tri.maxX);
+        pixelRange(minY, maxY, OCCLUSION_HEIGHT, true, tri.minY, tri.maxY);
+        if (tri.minX > tri.maxX || tri.minY > tri.maxY) return;
+        // Sentido antihorario siempre, así las funciones de arista son >= 0 adentro
+        tri.v[0] = a;
+        tri.invW[0] = wa;
+        if (area > 0.0f) { tri.v[1] = b; tri.v[2] = c; tri.invW[1] = wb; tri.invW[2] = wc; }
+        else { tri.v[1] = c; tri.v[2] = b; tri.invW[1] = wc; tri.invW[2] = wb; }
+        tri.valid = true;
+    }
+
+    // Funciones de arista en los centros de píxel, de 4 en 4 con SSE.
+    void rasterize(const ScreenTriangle& tri, int bandY0, int bandY1) {
+        const glm::vec2* v = tri.v;
+        float ex[3], ey[3], ec[3];                  // E(x, y) = ex * x + ey * y + ec
+        for (int k = 0; k < 3; k++) {
+            const glm::vec2& a = v[k];
+            const glm::vec2& b = v[(k + 1) % 3];
+            ex[k] = a.y - b.y;
+            ey[k] = b.x - a.x;
+            ec[k] = a.x * b.y - a.y * b.x;
+        }
+        // 1/w como plano: z = z0 + dzdx * (x - v0.x) + dzdy * (y - v0.y)
+        const float area = ec[0] + ec[1] + ec[2];  // doble del área, > 0
+        const float dzdx = (ex[1] * tri.invW[0] + ex[2] * tri.invW[1] + ex[0] * tri.invW[2]) / area;
+        const float dzdy = (ey[1] * tri.invW[0] + ey[2] * tri.invW[1] + ey[0] * tri.invW[2]) / area;
+        const float zc = tri.invW[0] - dzdx * v[0].x - dzdy * v[0].y;
+
+        const int y0 = std::max(tri.minY, bandY0), y1 = std::min(tri.maxY, bandY1 - 1);
+        const int x0 = tri.minX, x1 = tri.maxX;
+        for (int y = y0; y <= y1; y++) {
+            const float py = (float)y + 0.5f;
+            float* row = depth.data() + (size_t)y * OCCLUSION_WIDTH;
+            // Misma asociación en SSE y escalar: cubren exactamente los mismos píxeles
+            const float e0 = ey[0] * py + ec[0], e1 = ey[1] * py + ec[1], e2 = ey[2] * py + ec[2];
+            const float zy = dzdy * py + zc;
+            int x = x0;
+#ifdef OCCLUSION_SSE
+            const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            const __m128 rowE[3] = { _mm_set1_ps(e0), _mm_set1_ps(e1), _mm_set1_ps(e2) };
+            const __m128 stepE[3] = { _mm_set1_ps(ex[0]), _mm_set1_ps(ex[1]), _mm_set1_ps(ex[2]) };
+            const __m128 zRow = _mm_set1_ps(zy), zStep = _mm_set1_ps(dzdx);
+            const __m128 zero = _mm_setzero_ps();
+            for (; x + 4 <= x1 + 1; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(rowE[0], _mm_mul_ps(stepE[0], px)), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(rowE[1], _mm_mul_ps(stepE[1], px)), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(rowE[2], _mm_mul_ps(stepE[2], px)), zero));
+                if (!_mm_movemask_ps(inside)) continue;
+                __m128 z = _mm_add_ps(zRow, _mm_mul_ps(zStep, px));
+                __m128 old = _mm_loadu_ps(row + x);
+                __m128 merged = _mm_max_ps(old, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, merged), _mm_andnot_ps(inside, old)));
+            }
+#endif
+            for (; x <= x1; x++) {
+                const float px = (float)x + 0.5f;
+                if (e0 + ex[0] * px < 0.0f || e1 + ex[1] * px < 0.0f || e2 + ex[2] * px < 0.0f) continue;
+                row[x] = std::max(row[x], zy + dzdx * px);
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,273 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Profiler por zonas. Cada zona se marca con un ProfileZone (RAII) que guarda
+// el tiempo de CPU y, si la zona lo pide, dos marcas de GPU con glQueryCounter.
+// Las consultas de un frame se leen PROFILER_FRAME_LATENCY frames después; si
+// todavía no están listas se descartan en vez de esperar, así que medir nunca
+// detiene la tubería. Apagado, una zona cuesta una comparación.
+
+const int PROFILER_MAX_ZONES = 32;
+const int PROFILER_MAX_RECORDS = 64;        // zonas medidas por frame
+const int PROFILER_FRAME_LATENCY = 4;       // frames en vuelo antes de leer sus consultas
+const int PROFILER_HISTORY = 120;           // frames del promedio móvil
+const size_t PROFILER_TRACE_EVENTS = 1 << 17;
+
+class Profiler {
+public:
+    // La zona 0 es el frame completo, medida por beginFrame()/endFrame().
+    Profiler() {
+        addZone("FRAME", true);
+        for (auto& f : frames) f.records.reserve(PROFILER_MAX_RECORDS);
+        trace.resize(PROFILER_TRACE_EVENTS);
+        clock0 = std::chrono::steady_clock::now();
+    }
+
+    ~Profiler() {
+        if (!queries.empty()) glDeleteQueries((GLsizei)queries.size(), queries.data());
+    }
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // 'name' debe vivir tanto como el profiler (literal). Devuelve el id de la zona.
+    int addZone(const char* name, bool gpu = true) {
+        if (zones.size() >= (size_t)PROFILER_MAX_ZONES) return -1;
+        Zone z;
+        z.name = name;
+        z.gpu = gpu;
+        zones.push_back(z);
+        return (int)zones.size() - 1;
+    }
+
+    // Se aplica al empezar el frame siguiente, nunca a mitad de uno.
+    void setEnabled(bool on) { wantEnabled = on; }
+    bool enabled() const { return wantEnabled; }
+    bool active() const { return recording; }
+
+    void beginFrame() {
+        if (wantEnabled && !recording) start();
+        if (!wantEnabled && recording) stop();
+        if (!recording) return;
+
+        slot = (slot + 1) % PROFILER_FRAME_LATENCY;
+        collect(frames[slot]);          // el frame que usó este hueco hace LATENCY frames
+        frames[slot].records.clear();
+        frameRecord = beginZone(0);
+    }
+
+    void endFrame() {
+        if (!recording) return;
+        endZone(frameRecord);
+        frameIndex++;
+    }
+
+    // Para ProfileZone; devuelve el registro que hay que cerrar con endZone.
+    int beginZone(int zone) {
+        FrameData& f = frames[slot];
+        if (zone < 0 || f.records.size() >= (size_t)PROFILER_MAX_RECORDS) return -1;
+        Record r;
+        r.zone = zone;
+        r.cpuStart = nowNs();
+        f.records.push_back(r);
+        int index = (int)f.records.size() - 1;
+        if (zones[zone].gpu) glQueryCounter(queryFor(slot, index, 0), GL_TIMESTAMP);
+        return index;
+    }
+
+    void endZone(int record) {
+        if (record < 0) return;
+        Record& r = frames[slot].records[record];
+        r.cpuEnd = nowNs();
+        if (zones[r.zone].gpu) glQueryCounter(queryFor(slot, record, 1), GL_TIMESTAMP);
+    }
+
+    // Promedios (ms por frame) de los últimos PROFILER_HISTORY frames leídos.
+    // gpuMs es -1 si la zona no mide GPU o no hay resultados todavía.
+    void averages(int zone, double& cpuMs, double& gpuMs) const {
+        const Zone& z = zones[zone];
+        int n = std::min(historyCount, PROFILER_HISTORY);
+        double cpu = 0.0, gpu = 0.0;
+        int gpuSamples = 0;
+        for (int i = 0; i < n; i++) {
+            cpu += z.cpuHistory[i];
+            if (z.gpuHistory[i] >= 0.0) { gpu += z.gpuHistory[i]; gpuSamples++; }
+        }
+        cpuMs = n > 0 ? cpu / n : 0.0;
+        gpuMs = gpuSamples > 0 ? gpu / gpuSamples : -1.0;
+    }
+
+    int zoneCount() const { return (int)zones.size(); }
+    const char* zoneName(int zone) const { return zones[zone].name; }
+    uint64_t droppedFrames() const { return dropped; }
+
+    // Últimos eventos en el formato de chrome://tracing (y Perfetto). La CPU va
+    // en el hilo 1 y la GPU en el 2, con su reloj alineado al de la CPU.
+    bool writeChromeTrace(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"CPU\"}},\n";
+        out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 2, \"args\": {\"name\": \"GPU\"}}";
+        size_t count = std::min(traceCount, trace.size());
+        size_t first = (traceHead + trace.size() - count) % trace.size();
+        for (size_t i = 0; i < count; i++) {
+            const TraceEvent& e = trace[(first + i) % trace.size()];
+            out << ",\n{\"name\": \"" << zones[e.zone].name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.thread
+                << ", \"ts\": " << (double)e.startNs / 1000.0 << ", \"dur\": " << (double)e.durationNs / 1000.0
+                << ", \"args\": {\"frame\": " << e.frame << "}}";
+        }
+        out << "\n]}\n";
+        return (bool)out;
+    }
+
+private:
+    struct Zone {
+        const char* name;
+        bool gpu;
+        double cpuHistory[PROFILER_HISTORY] = {};
+        double gpuHistory[PROFILER_HISTORY] = {};
+    };
+
+    struct Record {
+        int zone;
+        int64_t cpuStart = 0, cpuEnd = 0;
+    };
+
+    struct FrameData {
+        std::vector<Record> records;
+        uint64_t frame = 0;
+    };
+
+    struct TraceEvent {
+        int zone;
+        int thread;
+        int64_t startNs;
+        int64_t durationNs;
+        uint64_t frame;
+    };
+
+    std::vector<Zone> zones;
+    FrameData frames[PROFILER_FRAME_LATENCY];
+    std::vector<GLuint> queries;        // LATENCY * MAX_RECORDS * 2, se crean al activar
+    std::vector<TraceEvent> trace;      // anillo
+    size_t traceHead = 0, traceCount = 0;
+
+    bool wantEnabled = false;
+    bool recording = false;
+    int slot = 0;
+    int frameRecord = -1;
+    uint64_t frameIndex = 0;
+    int historyHead = 0, historyCount = 0;
+    uint64_t dropped = 0;
+    int64_t gpuToCpuNs = 0;
+    std::chrono::steady_clock::time_point clock0;
+
+    int64_t nowNs() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - clock0).count();
+    }
+
+    GLuint queryFor(int frameSlot, int record, int end) const {
+        return queries[((size_t)frameSlot * PROFILER_MAX_RECORDS + record) * 2 + end];
+    }
+
+    void start() {
+        if (queries.empty()) {
+            queries.resize((size_t)PROFILER_FRAME_LATENCY * PROFILER_MAX_RECORDS * 2);
+            glGenQueries((GLsizei)queries.size(), queries.data());
+        }
+        // Alinea el reloj de la GPU con el de la CPU para la traza
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpuToCpuNs = nowNs() - (int64_t)gpuNow;
+        for (auto& f : frames) f.records.clear();
+        historyHead = historyCount = 0;
+        recording = true;
+    }
+
+    void stop() {
+        for (auto& f : frames) f.records.clear();
+        recording = false;
+    }
+
+    void collect(FrameData& f) {
+        if (f.records.empty()) {
+            f.frame = frameIndex;
+            return;
+        }
+
+        // Las marcas terminan en orden: si la última está lista, lo están todas
+        bool gpuReady = true;
+        for (int i = (int)f.records.size() - 1; i >= 0; i--) {
+            if (!zones[f.records[i].zone].gpu) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(queryFor(slot, i, 1), GL_QUERY_RESULT_AVAILABLE, &available);
+            gpuReady = available != 0;
+            break;
+        }
+        if (!gpuReady) dropped++;
+
+        double cpuMs[PROFILER_MAX_ZONES] = {};
+        double gpuMs[PROFILER_MAX_ZONES];
+        std::fill(gpuMs, gpuMs + PROFILER_MAX_ZONES, -1.0);
+        for (size_t i = 0; i < f.records.size(); i++) {
+            const Record& r = f.records[i];
+            cpuMs[r.zone] += (double)(r.cpuEnd - r.cpuStart) / 1.0e6;
+            record({ r.zone, 1, r.cpuStart, r.cpuEnd - r.cpuStart, f.frame });
+
+            if (!zones[r.zone].gpu || !gpuReady) continue;
+            GLuint64 t0 = 0, t1 = 0;
+            glGetQueryObjectui64v(queryFor(slot, (int)i, 0), GL_QUERY_RESULT, &t0);
+            glGetQueryObjectui64v(queryFor(slot, (int)i, 1), GL_QUERY_RESULT, &t1);
+            double ms = (double)(t1 - t0) / 1.0e6;
+            gpuMs[r.zone] = std::max(gpuMs[r.zone], 0.0) + ms;
+            record({ r.zone, 2, (int64_t)t0 + gpuToCpuNs, (int64_t)(t1 - t0), f.frame });
+        }
+
+        for (size_t z = 0; z < zones.size(); z++) {
+            zones[z].cpuHistory[historyHead] = cpuMs[z];
+            zones[z].gpuHistory[historyHead] = gpuMs[z];
+        }
+        historyHead = (historyHead + 1) % PROFILER_HISTORY;
+        historyCount++;
+        f.frame = frameIndex;
+    }
+
+    void record(const TraceEvent& e) {
+        trace[traceHead] = e;
+        traceHead = (traceHead + 1) % trace.size();
+        traceCount = std::min(traceCount + 1, trace.size());
+    }
+};
+
+// Mide desde su construcción hasta el final del bloque.
+class ProfileZone {
+public:
+    ProfileZone(Profiler& profiler, int zone)
+        : profiler(profiler.active() ? &profiler : nullptr) {
+        if (this->profiler) record = this->profiler->beginZone(zone);
+    }
+    ~ProfileZone() { end(); }
+
+    // Cierra la zona antes del final del bloque.
+    void end() {
+        if (profiler) profiler->endZone(record);
+        profiler = nullptr;
+    }
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    Profiler* profiler;
+    int record = -1;
+};
+
+#endif
@@ -0,0 +1,451 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "scene_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// Cola de dibujo: en vez de que cada modelo dibuje sus mallas en el orden del
+// archivo (bind de texturas, VAO y uniforms por malla), se recogen todos los
+// elementos visibles del frame, se ordenan por shader -> conjunto de texturas
+// -> VAO -> objeto y se envían evitando cambios de estado repetidos. Los datos
+// por frame (matrices, cámara, clusters) y por objeto (textura array, primera
+// instancia) van en uniform buffers, no en glUniform por dibujo; la visión
+// nocturna y lo emisivo no son datos sino variantes del programa
+// (shader_variants.h), que el llamador elige en submit(). Las matrices
+// model y normal se calculan una vez por objeto en la CPU y el shader las lee
+// de un buffer de instancias, así un objeto repetido es una sola llamada.
+
+const GLuint FRAME_UBO_BINDING = 0;
+const GLuint OBJECT_UBO_BINDING = 1;
+
+// Unidad del sampler2DArray de la geometría estática agrupada (static_batch.h).
+const int MATERIAL_ARRAY_UNIT = 11;
+
+// Unidad del samplerBuffer con las matrices por instancia (lighting.vs). Cada
+// instancia ocupa INSTANCE_TEXELS texels RGBA32F: las 4 columnas de model y
+// las 3 de la matriz normal.
+const int INSTANCE_TRANSFORM_UNIT = 12;
+const int INSTANCE_TEXELS = 7;
+
+// Conjuntos de texturas distintos que se recuerdan entre frames; pasado este
+// número (nombres de modelos ya descargados) se empieza de cero en begin().
+const size_t RENDER_QUEUE_MAX_TEXTURE_SETS = 4096;
+
+// Deben coincidir con los bloques std140 de lighting.vs / lighting.fs.
+struct FrameUniforms {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec4 viewPos;          // xyz
+    glm::ivec4 clusterDims;     // xyz
+    glm::vec4 clusterParams;    // xy = viewport, z = clusterNear, w = clusterLogScale
+};
+
+struct ObjectUniforms {
+    int32_t useTextureArray;    // textura desde materialLayers + capa por vértice
+    int32_t instanceBase;       // primera instancia del objeto en instanceTransforms
+    int32_t pad[2];
+};
+
+// Varios rangos del mismo VAO en una sola llamada. Si indirectBuffer != 0 los
+// comandos ya están en GPU (glMultiDrawElementsIndirect, GL 4.3); si no, se
+// usan los arrays con glMultiDrawElementsBaseVertex (GL 3.2).
+struct MultiDraw {
+    std::vector<GLsizei> counts;
+    std::vector<const void*> offsets;       // en bytes dentro del EBO
+    std::vector<GLint> baseVertices;
+    GLuint indirectBuffer = 0;
+    GLintptr indirectOffset = 0;
+
+    void clear() {
+        counts.clear();
+        offsets.clear();
+        baseVertices.clear();
+        indirectBuffer = 0;
+        indirectOffset = 0;
+    }
+    GLsizei size() const { return (GLsizei)counts.size(); }
+};
+
+static_assert(sizeof(FrameUniforms) == 176, "FrameUniforms no coincide con std140");
+static_assert(sizeof(ObjectUniforms) == 16, "ObjectUniforms no coincide con std140");
+
+// Columnas de la matriz normal: cofactores de la parte 3x3 de 'model', que son
+// transpose(inverse()) multiplicada por el determinante. lighting.fs normaliza
+// la normal, así que la escala sobra; solo se corrige el signo (espejos).
+inline void normalMatrixColumns(const glm::mat4& model, glm::vec3 out[3]) {
+    glm::vec3 c0(model[0]), c1(model[1]), c2(model[2]);
+    out[0] = glm::cross(c1, c2);
+    out[1] = glm::cross(c2, c0);
+    out[2] = glm::cross(c0, c1);
+    if (glm::dot(c0, out[0]) < 0.0f)
+        for (int i = 0; i < 3; i++) out[i] = -out[i];
+}
+
+// Llamadas de estado emitidas en un frame. 'stateChanges' suma cambios de
+// programa, texturas, VAO, uniforms y rangos de UBO.
+struct RenderStats {
+    int drawCalls = 0;
+    int programBinds = 0;
+    int textureBinds = 0;
+    int vaoBinds = 0;
+    int uniformCalls = 0;
+    int bufferBinds = 0;
+    long long triangles = 0;
+
+    int stateChanges() const {
+        return programBinds + textureBinds + vaoBinds + uniformCalls + bufferBinds;
+    }
+};
+
+class RenderQueue {
+public:
+    RenderStats stats;          // lo que emitió realmente flush()
+    RenderStats legacyStats;    // lo que habría emitido Model::Draw con los mismos elementos
+
+    RenderQueue() {
+        GLint align = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+        objectStride = ((GLsizeiptr)sizeof(ObjectUniforms) + align - 1) / align * align;
+
+        glGenBuffers(1, &frameUbo);
+        glBindBuffer(GL_UNIFORM_BUFFER, frameUbo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+        glGenBuffers(1, &objectUbo);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UBO_BINDING, frameUbo);
+
+        glGenBuffers(1, &instanceBuffer);
+        glGenTextures(1, &instanceTexture);
+        glBindBuffer(GL_TEXTURE_BUFFER, instanceBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, INSTANCE_TEXELS * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, instanceTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, instanceBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    ~RenderQueue() {
+        glDeleteBuffers(1, &frameUbo);
+        glDeleteBuffers(1, &objectUbo);
+        glDeleteTextures(1, &instanceTexture);
+        glDeleteBuffers(1, &instanceBuffer);
+    }
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    // Una vez por programa: conecta sus bloques a los puntos de enlace.
+    void attach(GLuint program) {
+        GLuint frameIndex = glGetUniformBlockIndex(program, "FrameData");
+        if (frameIndex != GL_INVALID_INDEX) glUniformBlockBinding(program, frameIndex, FRAME_UBO_BINDING);
+        GLuint objectIndex = glGetUniformBlockIndex(program, "ObjectData");
+        if (objectIndex != GL_INVALID_INDEX) glUniformBlockBinding(program, objectIndex, OBJECT_UBO_BINDING);
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "instanceTransforms"), INSTANCE_TRANSFORM_UNIT);
+    }
+
+    // --- Por frame ---
+    void begin(const FrameUniforms& frame) {
+        items.clear();
+        objects.clear();
+        objectInstances.clear();
+        instanceData.clear();
+        legacyStats = RenderStats();
+        if (textureSets.size() > RENDER_QUEUE_MAX_TEXTURE_SETS) {
+            textureSetIds.clear();
+            textureSets.clear();
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, frameUbo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frame);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        // Antes: projection, view, viewPos, thermalVision y 4 uniforms de clusters.
+        legacyStats.uniformCalls += 8;
+    }
+
+    // Datos de un objeto (matriz y banderas); devuelve su índice para submit().
+    int addObject(const glm::mat4& model, bool textureArray = false) {
+        return addInstances(&model, 1, textureArray);
+    }
+
+    // Varias copias de un mismo modelo: cada malla encolada con este índice se
+    // dibuja una sola vez con glDrawElementsInstanced, una instancia por matriz.
+    int addInstances(const glm::mat4* models, int count, bool textureArray = false) {
+        ObjectUniforms obj;
+        obj.useTextureArray = textureArray ? 1 : 0;
+        obj.instanceBase = (int32_t)(instanceData.size() / INSTANCE_TEXELS);
+        obj.pad[0] = obj.pad[1] = 0;
+        for (int i = 0; i < count; i++) appendInstance(models[i]);
+        objects.push_back(obj);
+        objectInstances.push_back(count);
+        legacyStats.uniformCalls += 2 * count;    // setMat4("model") + setBool("isEmissive")
+        return (int)objects.size() - 1;
+    }
+
+    // Encola las mallas 'visible' (índices en model.meshes) del objeto 'object'.
+    // 'lod' elige el rango de índices de cada malla (ver lod_selection.h).
+    void submit(GLuint shader, const SceneModel& model, const std::vector<uint32_t>& visible, int object, int lod = 0) {
+        uint32_t program = programIndex(shader);
+        int copies = objectInstances[object];
+        if (copies == 0) return;
+        for (uint32_t i : visible) {
+            const SceneMesh& mesh = model.meshes[i];
+            if (mesh.indices.size() == 0) continue;
+            DrawItem item;
+            item.program = shader;
+            item.vao = mesh.VAO;
+            item.textureSet = textureSetOf(mesh);
+            item.object = (uint32_t)object;
+            item.count = (GLsizei)mesh.indices.size();
+            if (lod > 0 && !mesh.lods.empty()) {
+                const MeshLod& level = mesh.lods[std::min((size_t)lod, mesh.lods.size() - 1)];
+                item.firstIndex = level.firstIndex;
+                item.count = level.count;
+            }
+            item.instances = copies;
+            item.key = makeKey(program, item.textureSet, vaoIndex(mesh.VAO));
+            items.push_back(item);
+
+            // Mesh::Draw: por textura activeTexture + getUniformLocation + uniform1i + bind;
+            // después bind y unbind del VAO y el dibujo.
+            // Cada copia habría sido un Model::Draw aparte.
+            int textures = (int)mesh.textures.size();
+            legacyStats.textureBinds += textures * copies;
+            legacyStats.uniformCalls += textures * copies;
+            legacyStats.vaoBinds += 2 * copies;
+            legacyStats.drawCalls += copies;
+        }
+    }
+
+    // Encola un grupo de rangos que comparten VAO y textura array. 'draw' debe
+    // seguir vivo hasta flush().
+    void submitMultiDraw(GLuint shader, GLuint vao, GLuint arrayTexture, const MultiDraw& draw, int object) {
+        if (draw.size() == 0) return;
+        DrawItem item;
+        item.program = shader;
+        item.vao = vao;
+        item.textureSet = textureSetOf(std::vector<GLuint>{ arrayTexture });
+        item.arrayTexture = arrayTexture;
+        item.object = (uint32_t)object;
+        item.count = 0;
+        item.multi = &draw;
+        item.key = makeKey(programIndex(shader), item.textureSet, vaoIndex(vao));
+        items.push_back(item);
+
+        // Sin agrupar habría sido un dibujo por malla, cada uno con su VAO y su textura.
+        legacyStats.textureBinds += draw.size();
+        legacyStats.uniformCalls += draw.size();
+        legacyStats.vaoBinds += 2 * draw.size();
+        legacyStats.drawCalls += draw.size();
+    }
+
+    // Ordena y dibuja todo lo encolado.
+    void flush() {
+        stats = RenderStats();
+        if (items.empty()) return;
+
+        // El objeto desempata fuera de la clave: no se recorta, así no se
+        // mezclan objetos aunque haya miles (enjambre, zonas del streamer)
+        std::sort(items.begin(), items.end(), [](const DrawItem& a, const DrawItem& b) {
+            return a.key != b.key ? a.key < b.key : a.object < b.object;
+        });
+
+        uploadObjects();
+
+        GLuint program = 0, vao = 0, arrayTexture = 0;
+        uint32_t textureSet = UINT32_MAX, object = UINT32_MAX;
+        std::vector<GLuint> bound(MAX_MATERIAL_UNITS, 0);
+        for (const DrawItem& item : items) {
+            if (item.program != program) {
+                glUseProgram(item.program);
+                program = item.program;
+                stats.programBinds++;
+            }
+            if (item.multi) {
+                if (item.arrayTexture != arrayTexture) {
+                    glActiveTexture(GL_TEXTURE0 + MATERIAL_ARRAY_UNIT);
+                    glBindTexture(GL_TEXTURE_2D_ARRAY, item.arrayTexture);
+                    arrayTexture = item.arrayTexture;
+                    stats.textureBinds++;
+                }
+                textureSet = item.textureSet;
+            }
+            else if (item.textureSet != textureSet) {
+                // Solo se cambian las unidades que difieren del conjunto anterior
+                const std::vector<GLuint>& set = textureSets[item.textureSet];
+                for (size_t unit = 0; unit < set.size() && unit < bound.size(); unit++) {
+                    if (bound[unit] == set[unit]) continue;
+                    glActiveTexture(GL_TEXTURE0 + (GLenum)unit);
+                    glBindTexture(GL_TEXTURE_2D, set[unit]);
+                    bound[unit] = set[unit];
+                    stats.textureBinds++;
+                }
+                textureSet = item.textureSet;
+            }
+            if (item.vao != vao) {
+                glBindVertexArray(item.vao);
+                vao = item.vao;
+                stats.vaoBinds++;
+            }
+            if (item.object != object) {
+                glBindBufferRange(GL_UNIFORM_BUFFER, OBJECT_UBO_BINDING, objectUbo,
+                                  item.object * objectStride, sizeof(ObjectUniforms));
+                object = item.object;
+                stats.bufferBinds++;
+            }
+            if (item.multi) {
+                drawMulti(*item.multi);
+                for (GLsizei count : item.multi->counts) stats.triangles += count / 3;
+            }
+            else if (item.instances > 1) {
+                glDrawElementsInstanced(GL_TRIANGLES, item.count, GL_UNSIGNED_INT,
+                                        (const void*)(uintptr_t)(item.firstIndex * sizeof(unsigned int)), item.instances);
+                stats.triangles += (long long)(item.count / 3) * item.instances;
+            }
+            else {
+                glDrawElements(GL_TRIANGLES, item.count, GL_UNSIGNED_INT,
+                               (const void*)(uintptr_t)(item.firstIndex * sizeof(unsigned int)));
+                stats.triangles += item.count / 3;
+            }
+            stats.drawCalls++;
+        }
+
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    size_t itemCount() const { return items.size(); }
+
+private:
+    // Unidades de material que se siguen (diffuse, specular, normal, height...).
+    static const size_t MAX_MATERIAL_UNITS = 8;
+
+    struct DrawItem {
+        uint64_t key;
+        GLuint program;
+        GLuint vao;
+        uint32_t textureSet;
+        uint32_t object;
+        GLsizei count;
+        GLuint firstIndex = 0;
+        GLsizei instances = 1;
+        GLuint arrayTexture = 0;
+        const MultiDraw* multi = nullptr;
+    };
+
+    std::vector<DrawItem> items;
+    std::vector<ObjectUniforms> objects;
+    std::vector<int> objectInstances;
+    std::vector<glm::vec4> instanceData;        // INSTANCE_TEXELS por instancia
+    std::vector<unsigned char> objectStaging;
+
+    GLuint frameUbo = 0, objectUbo = 0;
+    GLuint instanceBuffer = 0, instanceTexture = 0;
+    GLsizeiptr objectStride = 256;
+    GLsizeiptr objectCapacity = 0;
+
+    // Identificadores compactos para la clave de orden
+    std::unordered_map<GLuint, uint32_t> programs;
+    std::unordered_map<GLuint, uint32_t> vaos;
+    std::map<std::vector<GLuint>, uint32_t> textureSetIds;
+    std::vector<std::vector<GLuint>> textureSets;
+    std::vector<GLuint> scratchSet;
+
+    // programa (8 bits) | texturas (24) | VAO (32); el objeto se compara aparte en flush()
+    static uint64_t makeKey(uint32_t program, uint32_t textures, uint32_t vao) {
+        return ((uint64_t)(program & 0xFF) << 56) |
+               ((uint64_t)(textures & 0xFFFFFF) << 32) |
+               (uint64_t)vao;
+    }
+
+    uint32_t programIndex(GLuint program) {
+        auto it = programs.find(program);
+        if (it != programs.end()) return it->second;
+        uint32_t id = (uint32_t)programs.size();
+        programs.emplace(program, id);
+        return id;
+    }
+
+    uint32_t vaoIndex(GLuint vao) {
+        auto it = vaos.find(vao);
+        if (it != vaos.end()) return it->second;
+        uint32_t id = (uint32_t)vaos.size();
+        vaos.emplace(vao, id);
+        return id;
+    }
+
+    // Se busca por los nombres mismos, no por la malla: los modelos se
+    // descargan (WorldStreamer) y GpuResources puede cambiar un nombre por el
+    // de otra textura igual, así que la dirección de la malla no identifica nada.
+    uint32_t textureSetOf(const SceneMesh& mesh) {
+        scratchSet.clear();
+        for (const auto& tex : mesh.textures) scratchSet.push_back(tex.id);
+        return textureSetOf(scratchSet);
+    }
+
+    uint32_t textureSetOf(const std::vector<GLuint>& set) {
+        auto it = textureSetIds.find(set);
+        if (it != textureSetIds.end()) return it->second;
+        uint32_t id = (uint32_t)textureSets.size();
+        textureSetIds.emplace(set, id);
+        textureSets.push_back(set);
+        return id;
+    }
+
+    static void drawMulti(const MultiDraw& draw) {
+#ifdef GL_VERSION_4_3
+        if (draw.indirectBuffer) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, draw.indirectBuffer);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)draw.indirectOffset, draw.size(), 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            return;
+        }
+#endif
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, draw.counts.data(), GL_UNSIGNED_INT,
+                                      draw.offsets.data(), draw.size(), draw.baseVertices.data());
+    }
+
+    void uploadObjects() {
+        GLsizeiptr needed = (GLsizeiptr)objects.size() * objectStride;
+        objectStaging.assign((size_t)needed, 0);
+        for (size_t i = 0; i < objects.size(); i++)
+            std::copy_n(reinterpret_cast<const unsigned char*>(&objects[i]), sizeof(ObjectUniforms),
+                        objectStaging.begin() + (size_t)(i * objectStride));
+
+        glBindBuffer(GL_UNIFORM_BUFFER, objectUbo);
+        if (needed > objectCapacity) {
+            objectCapacity = needed;
+            glBufferData(GL_UNIFORM_BUFFER, objectCapacity, objectStaging.data(), GL_DYNAMIC_DRAW);
+        }
+        else {
+            glBufferData(GL_UNIFORM_BUFFER, objectCapacity, nullptr, GL_DYNAMIC_DRAW);   // huérfano
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, needed, objectStaging.data());
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        stats.bufferBinds++;
+
+        // Matrices de todas las instancias del frame en el buffer de textura
+        glBindBuffer(GL_TEXTURE_BUFFER, instanceBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, instanceData.size() * sizeof(glm::vec4), instanceData.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glActiveTexture(GL_TEXTURE0 + INSTANCE_TRANSFORM_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, instanceTexture);
+        stats.bufferBinds++;
+        stats.textureBinds++;
+    }
+
+    void appendInstance(const glm::mat4& model) {
+        glm::vec3 normal[3];
+        normalMatrixColumns(model, normal);
+        for (int c = 0; c < 4; c++) instanceData.push_back(model[c]);
+        for (int c = 0; c < 3; c++) instanceData.push_back(glm::vec4(normal[c], 0.0f));
+    }
+};
+
+#endif
@@ -0,0 +1,674 @@
+#ifndef SCENE_CACHE_H
+#define SCENE_CACHE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader.h>
+#include <learnopengl/model.h>
+
+#include "texture_streamer.h"
+#include "gpu_resources.h"
+#include "mesh_lod.h"
+#include "mesh_analysis.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Caché binaria de escenas: cada OBJ se "hornea" una sola vez en un blob
+// versionado (<archivo>.obj.cache) con los Vertex intercalados, los índices
+// (más los de sus niveles de detalle), las referencias a texturas y los
+// límites ya calculados. En tiempo de
+// ejecución el blob se mapea en memoria y los buffers se suben directamente
+// desde el mapeo, sin pasar por Assimp.
+
+const uint32_t SCENE_CACHE_VERSION = 2;
+const char SCENE_CACHE_MAGIC[8] = { 'D', 'R', 'N', 'S', 'C', 'N', 0, 0 };
+
+// --- VISTA DE ARREGLO (no es dueña de los datos) ---
+template <typename T>
+struct ArrayView {
+    const T* ptr = nullptr;
+    size_t count = 0;
+
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+    const T* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+};
+
+// --- ARCHIVO MAPEADO EN MEMORIA ---
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) { close(); return false; }
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping) { close(); return false; }
+        ptr = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!ptr) { close(); return false; }
+        length = (size_t)fileSize.QuadPart;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        ptr = (const unsigned char*)p;
+        length = (size_t)st.st_size;
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (ptr) UnmapViewOfFile(ptr);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (ptr) munmap((void*)ptr, length);
+#endif
+        ptr = nullptr;
+        length = 0;
+    }
+
+    const unsigned char* data() const { return ptr; }
+    size_t size() const { return length; }
+    bool isOpen() const { return ptr != nullptr; }
+
+private:
+    const unsigned char* ptr = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+};
+
+// --- FORMATO DEL BLOB ---
+// [CacheHeader][CacheMeshRecord x meshCount][CacheTextureRecord x textureCount]
+// [cadenas][vértices (alineados a 16)][índices]
+// Los índices de cada malla son los del nivel 0 seguidos de los de sus LOD.
+// Todos los offsets son absolutos desde el inicio del archivo.
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t vertexSize;        // sizeof(Vertex) con el que se horneó
+    uint64_t sourceSize;        // tamaño del OBJ de origen
+    int64_t sourceMTime;        // fecha de modificación del OBJ de origen
+    uint32_t meshCount;
+    uint32_t textureCount;
+    uint64_t meshTableOffset;
+    uint64_t textureTableOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct CacheLodRecord {
+    uint32_t firstIndex;
+    uint32_t count;
+    float error;
+};
+
+struct CacheMeshRecord {
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t firstTexture;
+    uint32_t textureCount;
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t lodCount;              // 0 si la malla no tiene niveles (nivel 0 incluido si no)
+    uint32_t lodIndexCount;         // índices extra tras los indexCount del nivel 0
+    CacheLodRecord lods[MESH_LOD_MAX];
+};
+
+struct CacheTextureRecord {
+    uint32_t typeOffset, typeLength;
+    uint32_t pathOffset, pathLength;
+};
+
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    bool valid = false;
+};
+
+inline SourceStamp statSource(const std::string& path) {
+    SourceStamp stamp;
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+        stamp.size = (uint64_t)st.st_size;
+        stamp.mtime = (int64_t)st.st_mtime;
+        stamp.valid = true;
+    }
+    return stamp;
+}
+
+inline std::string sceneCachePath(const std::string& objPath) {
+    return objPath + ".cache";
+}
+
+// Límites del modelo y tamaño de la caché leyendo solo la cabecera; false si
+// la caché falta, no es de esta versión o está desactualizada.
+inline bool readSceneCacheBounds(const std::string& objPath, glm::vec3& boundsMin, glm::vec3& boundsMax, uint64_t* cacheBytes = nullptr) {
+    std::ifstream in(sceneCachePath(objPath), std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    uint64_t fileSize = (uint64_t)in.tellg();
+    CacheHeader header;
+    in.seekg(0);
+    if (fileSize < sizeof(header) || !in.read((char*)&header, sizeof(header))) return false;
+    if (std::memcmp(header.magic, SCENE_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SCENE_CACHE_VERSION || header.vertexSize != sizeof(Vertex))
+        return false;
+    SourceStamp stamp = statSource(objPath);
+    if (stamp.valid && (stamp.size != header.sourceSize || stamp.mtime != header.sourceMTime)) return false;
+    boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    if (cacheBytes) *cacheBytes = fileSize;
+    return true;
+}
+
+// --- MALLA DE ESCENA ---
+// Misma interfaz que Mesh para el resto del programa (vertices/indices/textures),
+// pero los datos viven en el mapeo del blob o en el Model de respaldo.
+// Mismo layout de atributos que Mesh::setupMesh (ubicaciones 0-6), sobre el
+// GL_ARRAY_BUFFER enlazado en el VAO actual.
+inline void setupVertexAttributes() {
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
+    glEnableVertexAttribArray(5);
+    glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, m_BoneIDs));
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_Weights));
+}
+
+struct SceneMesh {
+    ArrayView<Vertex> vertices;
+    ArrayView<unsigned int> indices;        // nivel 0 (colisión, lote estático, culling)
+    ArrayView<unsigned int> lodIndices;     // niveles 1.., en el EBO a continuación de 'indices'
+    std::vector<MeshLod> lods;              // vacío si la malla solo tiene nivel 0
+    std::vector<Texture> textures;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    unsigned int VAO = 0;
+
+    // Igual que Mesh::Draw: texture_diffuseN, texture_specularN, ...
+    void Draw(Shader& shader) const {
+        unsigned int diffuseNr = 1, specularNr = 1, normalNr = 1, heightNr = 1;
+        for (unsigned int i = 0; i < textures.size(); i++) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            std::string number;
+            const std::string& name = textures[i].type;
+            if (name == "texture_diffuse") number = std::to_string(diffuseNr++);
+            else if (name == "texture_specular") number = std::to_string(specularNr++);
+            else if (name == "texture_normal") number = std::to_string(normalNr++);
+            else if (name == "texture_height") number = std::to_string(heightNr++);
+            glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), i);
+            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        }
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+};
+
+inline void computeMeshBounds(SceneMesh& mesh) {
+    MeshStats stats = analyzeMesh(mesh);
+    mesh.boundsMin = stats.boundsMin;
+    mesh.boundsMax = stats.boundsMax;
+}
+
+// --- HORNEADO ---
+inline bool writeSceneCache(const std::string& objPath, const std::vector<SceneMesh>& meshes) {
+    SourceStamp stamp = statSource(objPath);
+    if (!stamp.valid || meshes.empty()) return false;
+
+    std::string strings;
+    std::vector<CacheTextureRecord> texRecords;
+    std::vector<CacheMeshRecord> meshRecords(meshes.size());
+
+    // Niveles de detalle: se generan aquí, en el horneado, no al cargar
+    std::vector<std::vector<unsigned int>> lodIndices(meshes.size());
+    std::vector<std::vector<MeshLod>> lods(meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++)
+        generateMeshLods(meshes[i].vertices.data(), meshes[i].vertices.size(),
+                         meshes[i].indices.data(), meshes[i].indices.size(), lodIndices[i], lods[i]);
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SCENE_CACHE_MAGIC, sizeof(header.magic));
+    header.version = SCENE_CACHE_VERSION;
+    header.vertexSize = (uint32_t)sizeof(Vertex);
+    header.sourceSize = stamp.size;
+    header.sourceMTime = stamp.mtime;
+    header.meshCount = (uint32_t)meshes.size();
+
+    glm::vec3 modelMin(1e10f), modelMax(-1e10f);
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const SceneMesh& mesh = meshes[i];
+        CacheMeshRecord& rec = meshRecords[i];
+        rec.vertexCount = (uint32_t)mesh.vertices.size();
+        rec.indexCount = (uint32_t)mesh.indices.size();
+        rec.firstTexture = (uint32_t)texRecords.size();
+        rec.textureCount = (uint32_t)mesh.textures.size();
+        rec.lodCount = (uint32_t)lods[i].size();
+        rec.lodIndexCount = (uint32_t)lodIndices[i].size();
+        for (size_t l = 0; l < lods[i].size(); l++) {
+            rec.lods[l].firstIndex = lods[i][l].firstIndex;
+            rec.lods[l].count = (uint32_t)lods[i][l].count;
+            rec.lods[l].error = lods[i][l].error;
+        }
+        for (int k = 0; k < 3; k++) {
+            rec.boundsMin[k] = mesh.boundsMin[k];
+            rec.boundsMax[k] = mesh.boundsMax[k];
+        }
+        modelMin = glm::min(modelMin, mesh.boundsMin);
+        modelMax = glm::max(modelMax, mesh.boundsMax);
+
+        for (const auto& tex : mesh.textures) {
+            CacheTextureRecord t;
+            t.typeOffset = (uint32_t)strings.size(); t.typeLength = (uint32_t)tex.type.size();
+            strings += tex.type;
+            t.pathOffset = (uint32_t)strings.size(); t.pathLength = (uint32_t)tex.path.size();
+            strings += tex.path;
+            texRecords.push_back(t);
+        }
+    }
+    for (int k = 0; k < 3; k++) {
+        header.boundsMin[k] = modelMin[k];
+        header.boundsMax[k] = modelMax[k];
+    }
+    header.textureCount = (uint32_t)texRecords.size();
+
+    auto align16 = [](uint64_t x) { return (x + 15) & ~(uint64_t)15; };
+    uint64_t offset = sizeof(CacheHeader);
+    header.meshTableOffset = offset;
+    offset += sizeof(CacheMeshRecord) * meshRecords.size();
+    header.textureTableOffset = offset;
+    offset += sizeof(CacheTextureRecord) * texRecords.size();
+    header.stringsOffset = offset;
+    header.stringsSize = strings.size();
+    offset += strings.size();
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        offset = align16(offset);
+        meshRecords[i].vertexOffset = offset;
+        offset += sizeof(Vertex) * (uint64_t)meshRecords[i].vertexCount;
+    }
+    for (size_t i = 0; i < meshes.size(); i++) {
+        offset = align16(offset);
+        meshRecords[i].indexOffset = offset;
+        offset += sizeof(unsigned int) * ((uint64_t)meshRecords[i].indexCount + meshRecords[i].lodIndexCount);
+    }
+
+    // Se escribe a un temporal y se renombra para que un horneado
+    // interrumpido nunca deje un blob a medias con cabecera válida.
+    std::string cachePath = sceneCachePath(objPath);
+    std::string tmpPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        uint64_t written = 0;
+        auto put = [&](const void* p, uint64_t n) {
+            out.write((const char*)p, (std::streamsize)n);
+            written += n;
+        };
+        auto padTo = [&](uint64_t target) {
+            static const char zeros[16] = {};
+            while (written < target) put(zeros, std::min<uint64_t>(16, target - written));
+        };
+
+        put(&header, sizeof(header));
+        put(meshRecords.data(), sizeof(CacheMeshRecord) * meshRecords.size());
+        put(texRecords.data(), sizeof(CacheTextureRecord) * texRecords.size());
+        put(strings.data(), strings.size());
+        for (size_t i = 0; i < meshes.size(); i++) {
+            padTo(meshRecords[i].vertexOffset);
+            put(meshes[i].vertices.data(), sizeof(Vertex) * (uint64_t)meshRecords[i].vertexCount);
+        }
+        for (size_t i = 0; i < meshes.size(); i++) {
+            padTo(meshRecords[i].indexOffset);
+            put(meshes[i].indices.data(), sizeof(unsigned int) * (uint64_t)meshRecords[i].indexCount);
+            put(lodIndices[i].data(), sizeof(unsigned int) * (uint64_t)meshRecords[i].lodIndexCount);
+        }
+        if (!out) return false;
+    }
+    std::remove(cachePath.c_str());
+    return std::rename(tmpPath.c_str(), cachePath.c_str()) == 0;
+}
+
+// --- OPCIONES DE CARGA ---
+struct SceneLoadOptions {
+    bool useCache = true;       // intentar el blob antes que el OBJ
+    bool writeCache = true;     // regenerar el blob si falta o está desactualizado
+    bool uploadToGpu = true;    // false: solo vistas de CPU (herramientas sin ventana)
+    TextureStreamer* textures = nullptr;   // si se da, las texturas se decodifican en segundo plano
+    GpuResources* resources = nullptr;     // si se da, texturas y geometría se comparten entre modelos
+};
+
+// --- MODELO DE ESCENA ---
+// Sustituto de Model: carga desde la caché si está vigente y, si no, pasa por
+// Assimp (Model) y hornea el blob para el siguiente arranque.
+class SceneModel final : public TextureHolder {
+public:
+    std::vector<SceneMesh> meshes;
+    std::string directory;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+
+    explicit SceneModel(const std::string& path, SceneLoadOptions options = SceneLoadOptions())
+        : sourcePath(path), streamer(options.textures), resources(options.resources) {
+        directory = path.substr(0, path.find_last_of("/\\"));
+        if (options.useCache && loadFromCache(options)) return;
+        if (!options.uploadToGpu) {
+            std::cout << "SCENE_CACHE::MISSING " << sceneCachePath(path) << " (run bake_scene)" << std::endl;
+            return;
+        }
+        loadFromSource();
+        if (options.writeCache && !meshes.empty() && !writeSceneCache(sourcePath, meshes))
+            std::cout << "SCENE_CACHE::WRITE_FAILED " << sceneCachePath(path) << std::endl;
+    }
+
+    ~SceneModel() {
+        if (!cached) return;
+        if (resources) {
+            for (uint64_t hash : meshHashes) resources->releaseMesh(hash);
+            if (!texturesLoaded.empty()) resources->removeHolder(this);
+            for (const auto& tex : texturesLoaded) resources->releaseTexture(tex.id);
+            return;
+        }
+        for (unsigned int buf : ownedBuffers) glDeleteBuffers(1, &buf);
+        for (const auto& mesh : meshes)
+            if (mesh.VAO) glDeleteVertexArrays(1, &mesh.VAO);
+        for (const auto& tex : texturesLoaded) {
+            if (streamer) streamer->release(tex.id);
+            else glDeleteTextures(1, &tex.id);
+        }
+    }
+    SceneModel(const SceneModel&) = delete;
+    SceneModel& operator=(const SceneModel&) = delete;
+
+    void Draw(Shader& shader) const {
+        for (const auto& mesh : meshes) mesh.Draw(shader);
+    }
+
+    // Niveles de detalle del modelo entero: el nivel l usa en cada malla su
+    // nivel min(l, último). lodError(l) es el mayor error de esas mallas.
+    int lodLevels() const { return (int)lodErrors.size(); }
+    float lodError(int level) const { return lodErrors.empty() ? 0.0f : lodErrors[std::min(level, lodLevels() - 1)]; }
+
+    bool fromCache() const { return cached; }
+
+    // Para modelos abiertos con uploadToGpu = false (p. ej. en un hilo de
+    // fondo): sube mallas hasta pasar 'maxBytes', al menos una por llamada.
+    // Devuelve los bytes enviados; uploadComplete() dice si falta alguna.
+    size_t uploadPending(size_t maxBytes) {
+        size_t sent = 0;
+        while (!uploadComplete() && (sent == 0 || sent < maxBytes)) sent += uploadMesh(meshes[uploaded++]);
+        return sent;
+    }
+    bool uploadComplete() const { return !cached || uploaded >= meshes.size(); }
+
+    // Lee una vez cada página de vértices e índices, así la subida posterior
+    // no espera al disco. Pensado para el hilo que abrió el modelo.
+    void prefetch() const {
+        if (!mapping.isOpen()) return;
+        volatile unsigned char sink = 0;
+        for (size_t offset = 0; offset < mapping.size(); offset += 4096) sink ^= mapping.data()[offset];
+        (void)sink;
+    }
+
+    // Vértices e índices en GPU (incluidos los niveles de detalle); las mallas
+    // compartidas con otros modelos cuentan en cada uno.
+    size_t geometryBytes() const {
+        size_t total = 0;
+        for (const auto& mesh : meshes)
+            total += mesh.vertices.size() * sizeof(Vertex) + (mesh.indices.size() + mesh.lodIndices.size()) * sizeof(unsigned int);
+        return total;
+    }
+    const std::string& path() const { return sourcePath; }
+
+    // GpuResources encontró que 'from' tiene el mismo contenido que 'to'.
+    int replaceTexture(unsigned int from, unsigned int to) override {
+        int refs = 0;
+        for (auto& tex : texturesLoaded)
+            if (tex.id == from) {
+                tex.id = to;
+                refs++;
+            }
+        for (auto& mesh : meshes)
+            for (auto& tex : mesh.textures)
+                if (tex.id == from) tex.id = to;
+        return refs;
+    }
+
+private:
+    std::string sourcePath;
+    bool cached = false;
+    MappedFile mapping;
+    std::unique_ptr<Model> fallback;
+    std::vector<unsigned int> ownedBuffers;
+    std::vector<Texture> texturesLoaded;
+    TextureStreamer* streamer = nullptr;
+    GpuResources* resources = nullptr;
+    std::vector<uint64_t> meshHashes;       // con 'resources': clave de cada VAO compartido
+    std::vector<float> lodErrors;
+    size_t uploaded = 0;                    // mallas del mapeo ya subidas a la GPU
+
+    bool loadFromCache(const SceneLoadOptions& options) {
+        if (!mapping.open(sceneCachePath(sourcePath))) return false;
+        const unsigned char* base = mapping.data();
+        const uint64_t fileSize = mapping.size();
+
+        if (fileSize < sizeof(CacheHeader)) return reject("truncated header");
+        CacheHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, SCENE_CACHE_MAGIC, sizeof(header.magic)) != 0) return reject("bad magic");
+        if (header.version != SCENE_CACHE_VERSION || header.vertexSize != sizeof(Vertex)) return reject("version mismatch");
+
+        SourceStamp stamp = statSource(sourcePath);
+        if (stamp.valid && (stamp.size != header.sourceSize || stamp.mtime != header.sourceMTime))
+            return reject("stale");
+
+        auto inRange = [&](uint64_t off, uint64_t bytes) { return off <= fileSize && bytes <= fileSize - off; };
+        if (!inRange(header.meshTableOffset, sizeof(CacheMeshRecord) * (uint64_t)header.meshCount) ||
+            !inRange(header.textureTableOffset, sizeof(CacheTextureRecord) * (uint64_t)header.textureCount) ||
+            !inRange(header.stringsOffset, header.stringsSize))
+            return reject("corrupt tables");
+
+        const CacheMeshRecord* records = (const CacheMeshRecord*)(base + header.meshTableOffset);
+        const CacheTextureRecord* texRecords = (const CacheTextureRecord*)(base + header.textureTableOffset);
+        const char* strings = (const char*)(base + header.stringsOffset);
+
+        std::vector<SceneMesh> parsed(header.meshCount);
+        for (uint32_t i = 0; i < header.meshCount; i++) {
+            const CacheMeshRecord& rec = records[i];
+            const uint64_t totalIndices = (uint64_t)rec.indexCount + rec.lodIndexCount;
+            if (!inRange(rec.vertexOffset, sizeof(Vertex) * (uint64_t)rec.vertexCount) ||
+                !inRange(rec.indexOffset, sizeof(unsigned int) * totalIndices) ||
+                (uint64_t)rec.firstTexture + rec.textureCount > header.textureCount ||
+                rec.lodCount > (uint32_t)MESH_LOD_MAX)
+                return reject("corrupt mesh record");
+
+            SceneMesh& mesh = parsed[i];
+            mesh.vertices = { (const Vertex*)(base + rec.vertexOffset), rec.vertexCount };
+            mesh.indices = { (const unsigned int*)(base + rec.indexOffset), rec.indexCount };
+            mesh.lodIndices = { mesh.indices.data() + rec.indexCount, rec.lodIndexCount };
+            for (uint32_t l = 0; l < rec.lodCount; l++) {
+                if ((uint64_t)rec.lods[l].firstIndex + rec.lods[l].count > totalIndices)
+                    return reject("corrupt lod record");
+                MeshLod lod;
+                lod.firstIndex = rec.lods[l].firstIndex;
+                lod.count = (GLsizei)rec.lods[l].count;
+                lod.error = rec.lods[l].error;
+                mesh.lods.push_back(lod);
+            }
+            mesh.boundsMin = glm::vec3(rec.boundsMin[0], rec.boundsMin[1], rec.boundsMin[2]);
+            mesh.boundsMax = glm::vec3(rec.boundsMax[0], rec.boundsMax[1], rec.boundsMax[2]);
+
+            for (uint32_t t = 0; t < rec.textureCount; t++) {
+                const CacheTextureRecord& tr = texRecords[rec.firstTexture + t];
+                if ((uint64_t)tr.typeOffset + tr.typeLength > header.stringsSize ||
+                    (uint64_t)tr.pathOffset + tr.pathLength > header.stringsSize)
+                    return reject("corrupt string table");
+                Texture tex;
+                tex.id = 0;
+                tex.type.assign(strings + tr.typeOffset, tr.typeLength);
+                tex.path.assign(strings + tr.pathOffset, tr.pathLength);
+                mesh.textures.push_back(tex);
+            }
+        }
+
+        meshes = std::move(parsed);
+        size_t levels = 0;
+        for (const auto& mesh : meshes) levels = std::max(levels, mesh.lods.size());
+        lodErrors.assign(levels, 0.0f);
+        for (const auto& mesh : meshes) {
+            if (mesh.lods.empty()) continue;
+            for (size_t l = 0; l < levels; l++)
+                lodErrors[l] = std::max(lodErrors[l], mesh.lods[std::min(l, mesh.lods.size() - 1)].error);
+        }
+        boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+        boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+        cached = true;
+        if (options.uploadToGpu) uploadFromMapping();
+        return true;
+    }
+
+    bool reject(const char* reason) {
+        std::cout << "SCENE_CACHE::REJECTED " << sceneCachePath(sourcePath) << " (" << reason << ")" << std::endl;
+        mapping.close();
+        meshes.clear();
+        return false;
+    }
+
+    void uploadFromMapping() {
+        while (uploaded < meshes.size()) uploadMesh(meshes[uploaded++]);
+    }
+
+    // Igual que Mesh::setupMesh, pero el origen es el mapeo. Devuelve los
+    // bytes enviados (0 si se reutilizó una malla ya subida).
+    size_t uploadMesh(SceneMesh& mesh) {
+        // Mismo contenido que una malla ya subida (de este u otro modelo): se reutiliza su VAO
+        const size_t vertexBytes = mesh.vertices.size() * sizeof(Vertex);
+        const size_t indexBytes = (mesh.indices.size() + mesh.lodIndices.size()) * sizeof(unsigned int);
+        if (resources) {
+            uint64_t hash = hashBytes(mesh.indices.data(), indexBytes, hashBytes(mesh.vertices.data(), vertexBytes));
+            meshHashes.push_back(hash);
+            if (resources->acquireMesh(hash, mesh.VAO)) {
+                for (auto& tex : mesh.textures) tex.id = loadCachedTexture(tex.path);
+                return 0;
+            }
+        }
+
+        unsigned int VBO, EBO;
+        glGenVertexArrays(1, &mesh.VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        if (!resources) {
+            ownedBuffers.push_back(VBO);
+            ownedBuffers.push_back(EBO);
+        }
+
+        glBindVertexArray(mesh.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, mesh.vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        // En el blob los índices de los LOD van justo después del nivel 0
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, mesh.indices.data(), GL_STATIC_DRAW);
+        setupVertexAttributes();
+        glBindVertexArray(0);
+        if (resources) resources->addMesh(meshHashes.back(), mesh.VAO, VBO, EBO, vertexBytes + indexBytes);
+
+        for (auto& tex : mesh.textures) tex.id = loadCachedTexture(tex.path);
+        return vertexBytes + indexBytes;
+    }
+
+    unsigned int loadCachedTexture(const std::string& path) {
+        for (const auto& loaded : texturesLoaded)
+            if (loaded.path == path) return loaded.id;
+        Texture tex;
+        if (resources && texturesLoaded.empty()) resources->addHolder(this);
+        if (resources) tex.id = resources->acquireTexture(directory + '/' + path, false, GL_REPEAT, true);
+        else if (streamer) tex.id = streamer->request(directory + '/' + path);
+        else tex.id = TextureFromFile(path.c_str(), directory);
+        tex.path = path;
+        texturesLoaded.push_back(tex);
+        return tex.id;
+    }
+
+    void loadFromSource() {
+        fallback.reset(new Model(sourcePath));
+        meshes.clear();
+        meshes.reserve(fallback->meshes.size());
+        glm::vec3 minP(1e10f), maxP(-1e10f);
+        for (const auto& src : fallback->meshes) {
+            SceneMesh mesh;
+            mesh.vertices = { src.vertices.data(), src.vertices.size() };
+            mesh.indices = { src.indices.data(), src.indices.size() };
+            mesh.textures = src.textures;
+            mesh.VAO = src.VAO;
+            computeMeshBounds(mesh);
+            minP = glm::min(minP, mesh.boundsMin);
+            maxP = glm::max(maxP, mesh.boundsMax);
+            meshes.push_back(mesh);
+        }
+        if (!meshes.empty()) {
+            boundsMin = minP;
+            boundsMax = maxP;
+        }
+    }
+};
+
+#endif
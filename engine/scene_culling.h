@@ -0,0 +1,206 @@
+#ifndef SCENE_CULLING_H
+#define SCENE_CULLING_H
+
+#include <glm/glm.hpp>
+
+#include "scene_cache.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Culling por malla en CPU: cada malla guarda su caja en mundo (calculada al
+// cargar, o al cambiar la transformación de un objeto animado) y cada frame se
+// prueba contra el frustum de la cámara y contra el horizonte de la niebla de
+// lighting.fs (salvo con visión térmica, que no tiene niebla). El resultado es una lista compacta de mallas visibles por objeto.
+
+// Niebla de lighting.fs: fogFactor = exp(-distCam * FOG_DENSITY). Por debajo de
+// FOG_CULL_THRESHOLD el fragmento ya es indistinguible del color de la niebla
+// (el de fondo es el mismo tras la corrección pow(1/1.2) del shader, ver
+// CLEAR_COLOR en Proyecto.cpp), así que la malla no aporta nada. La variante
+// THERMAL_VISION no aplica niebla: ahí no se puede descartar por distancia.
+const float FOG_DENSITY = 0.04f;
+const float FOG_CULL_THRESHOLD = 1.0f / 256.0f;
+
+inline float fogCullDistance() {
+    return -std::log(FOG_CULL_THRESHOLD) / FOG_DENSITY;
+}
+
+// Caja envolvente de la caja 'mn'-'mx' transformada por 'm' (método de Arvo).
+inline void transformBounds(const glm::mat4& m, const glm::vec3& mn, const glm::vec3& mx,
+                            glm::vec3& outMin, glm::vec3& outMax) {
+    glm::vec3 center = glm::vec3(m * glm::vec4((mn + mx) * 0.5f, 1.0f));
+    glm::vec3 half = (mx - mn) * 0.5f;
+    glm::vec3 extent(0.0f);
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 3; col++)
+            extent[row] += std::fabs(m[col][row]) * half[col];
+    outMin = center - extent;
+    outMax = center + extent;
+}
+
+// --- FRUSTUM ---
+struct Frustum {
+    glm::vec4 planes[6];    // normal hacia adentro, normalizados
+
+    // Planos de Gribb-Hartmann a partir de projection * view.
+    void extract(const glm::mat4& viewProjection) {
+        const glm::mat4& m = viewProjection;
+        for (int i = 0; i < 3; i++) {
+            planes[i * 2]     = glm::vec4(m[0][3] + m[0][i], m[1][3] + m[1][i], m[2][3] + m[2][i], m[3][3] + m[3][i]);
+            planes[i * 2 + 1] = glm::vec4(m[0][3] - m[0][i], m[1][3] - m[1][i], m[2][3] - m[2][i], m[3][3] - m[3][i]);
+        }
+        for (auto& p : planes)
+            p = p / glm::length(glm::vec3(p));
+    }
+
+    // Conservador: solo descarta si la caja queda entera fuera de algún plano.
+    bool intersects(const glm::vec3& mn, const glm::vec3& mx) const {
+        for (const auto& p : planes) {
+            glm::vec3 positive(p.x >= 0.0f ? mx.x : mn.x,
+                               p.y >= 0.0f ? mx.y : mn.y,
+                               p.z >= 0.0f ? mx.z : mn.z);
+            if (glm::dot(glm::vec3(p), positive) + p.w < 0.0f) return false;
+        }
+        return true;
+    }
+};
+
+inline float distanceToBox2(const glm::vec3& p, const glm::vec3& mn, const glm::vec3& mx) {
+    glm::vec3 d = glm::max(glm::max(mn - p, p - mx), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
+
+struct CullStats {
+    int meshesTested = 0;
+    int meshesVisible = 0;
+    int objectsCulled = 0;   // objetos descartados enteros por su caja global
+    int meshesOccluded = 0;  // pasaron el frustum pero refine() las sacó
+
+    // De las mallas dentro del frustum, cuántas quedaron tapadas.
+    float occludedFraction() const {
+        int candidates = meshesVisible + meshesOccluded;
+        return candidates > 0 ? (float)meshesOccluded / (float)candidates : 0.0f;
+    }
+};
+
+// --- CULLER ---
+class SceneCuller {
+public:
+    CullStats stats;
+
+    // Registra un modelo; devuelve el identificador que usan setTransform y visibleMeshes.
+    // 'fogged' = false para objetos que lighting.fs no oscurece (emisivos).
+    int addObject(const SceneModel& model, const glm::mat4& transform = glm::mat4(1.0f), bool fogged = true) {
+        Object obj;
+        obj.model = &model;
+        obj.fogged = fogged;
+        obj.worldMin.resize(model.meshes.size());
+        obj.worldMax.resize(model.meshes.size());
+        int id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+            objects[id] = std::move(obj);
+        }
+        else {
+            id = (int)objects.size();
+            objects.push_back(std::move(obj));
+            objectVisible.emplace_back();
+        }
+        setTransform(id, transform);
+        return id;
+    }
+
+    // Saca un objeto (p. ej. un modelo que se descarga); su id se reutiliza.
+    void removeObject(int id) {
+        objects[id] = Object();
+        objectVisible[id].clear();
+        freeIds.push_back(id);
+    }
+
+    // Para objetos animados: recalcula las cajas en mundo de sus mallas.
+    void setTransform(int id, const glm::mat4& transform) {
+        Object& obj = objects[id];
+        obj.boundsMin = glm::vec3(1e30f);
+        obj.boundsMax = glm::vec3(-1e30f);
+        for (size_t i = 0; i < obj.model->meshes.size(); i++) {
+            const SceneMesh& mesh = obj.model->meshes[i];
+            transformBounds(transform, mesh.boundsMin, mesh.boundsMax, obj.worldMin[i], obj.worldMax[i]);
+            obj.boundsMin = glm::min(obj.boundsMin, obj.worldMin[i]);
+            obj.boundsMax = glm::max(obj.boundsMax, obj.worldMax[i]);
+        }
+    }
+
+    // 'fog' = false cuando se dibuja sin niebla (visión térmica): solo frustum.
+    void cull(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& cameraPos, bool fog = true) {
+        frustum.extract(projection * view);
+        const float fogDistance2 = fog ? fogCullDistance() * fogCullDistance() : std::numeric_limits<float>::max();
+        stats = CullStats();
+
+        for (size_t id = 0; id < objects.size(); id++) {
+            const Object& obj = objects[id];
+            std::vector<uint32_t>& visible = objectVisible[id];
+            visible.clear();
+            if (!obj.model) continue;
+
+            if (!boxVisible(obj.boundsMin, obj.boundsMax, obj.fogged, cameraPos, fogDistance2)) {
+                stats.objectsCulled++;
+                continue;
+            }
+            for (size_t i = 0; i < obj.worldMin.size(); i++) {
+                stats.meshesTested++;
+                if (boxVisible(obj.worldMin[i], obj.worldMax[i], obj.fogged, cameraPos, fogDistance2))
+                    visible.push_back((uint32_t)i);
+            }
+            stats.meshesVisible += (int)visible.size();
+        }
+    }
+
+    // Segunda pasada sobre lo que dejó cull() (p. ej. oclusión): saca las
+    // mallas cuya caja en mundo no pasa 'test(min, max)'.
+    template <typename Test>
+    void refine(const Test& test) {
+        for (size_t id = 0; id < objects.size(); id++) {
+            const Object& obj = objects[id];
+            std::vector<uint32_t>& visible = objectVisible[id];
+            size_t kept = 0;
+            for (uint32_t i : visible)
+                if (test(obj.worldMin[i], obj.worldMax[i])) visible[kept++] = i;
+            stats.meshesOccluded += (int)(visible.size() - kept);
+            stats.meshesVisible -= (int)(visible.size() - kept);
+            visible.resize(kept);
+        }
+    }
+
+    // Índices (en model.meshes) de las mallas visibles del objeto tras cull().
+    const std::vector<uint32_t>& visibleMeshes(int id) const { return objectVisible[id]; }
+
+    int totalMeshes() const {
+        int total = 0;
+        for (const auto& obj : objects) total += (int)obj.worldMin.size();
+        return total;
+    }
+
+private:
+    struct Object {
+        const SceneModel* model = nullptr;
+        bool fogged = true;
+        glm::vec3 boundsMin, boundsMax;
+        std::vector<glm::vec3> worldMin, worldMax;
+    };
+
+    std::vector<Object> objects;
+    std::vector<std::vector<uint32_t>> objectVisible;
+    std::vector<int> freeIds;
+    Frustum frustum;
+
+    bool boxVisible(const glm::vec3& mn, const glm::vec3& mx, bool fogged,
+                    const glm::vec3& cameraPos, float fogDistance2) const {
+        if (fogged && distanceToBox2(cameraPos, mn, mx) > fogDistance2) return false;
+        return frustum.intersects(mn, mx);
+    }
+};
+
+#endif
@@ -0,0 +1,350 @@
+#ifndef SCENE_MANIFEST_H
+#define SCENE_MANIFEST_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "json_reader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Manifiesto de escena: qué modelos se cargan, dónde van, cómo se animan y
+// en qué orden. Las rutas son relativas a la raíz de assets (por defecto la
+// indicada en el propio manifiesto, relativa a su carpeta).
+//
+//   {
+//     "assetRoot": "..",
+//     "hud": { "frame": "textures/marco.png" },
+//     "lights": { "color": [1, 0.9, 0.7], "intensity": 35, "positions": [[0, 3, 0]] },
+//     "models": [
+//       { "name": "house", "path": "model/scene2/Scnecp.obj", "collision": true, "static": true,
+//         "occluder": true },
+//       { "name": "moon", "path": "model/scene2/moon.obj", "priority": 2, "emissive": true, "fog": false,
+//         "position": [0, 500, -50], "scale": 0.1, "animation": { "type": "spin", "speed": 0.02 } }
+//     ]
+//   }
+//
+// Prioridad: 0 se carga antes del primer frame; el resto después, de menor a
+// mayor. Lo que participa en la colisión, el lote estático, las luces o la
+// oclusión se carga siempre al arrancar, tenga la prioridad que tenga.
+//
+// Los modelos con "stream": true no siguen la prioridad: se reparten en celdas
+// y se cargan y descargan según la distancia al dron (world_streamer.h), con
+// los radios y presupuestos de la sección "streaming".
+//
+// La sección opcional "swarm" agrega un enjambre de drones autónomos
+// (drone_swarm.h) que orbitan el punto de salida, todos con el mismo modelo:
+//   "swarm": { "model": "model/scene2/Ghost1.obj", "scale": 0.3, "count": 256,
+//              "routes": 12, "radius": [12, 60], "height": [3, 18] }
+
+enum class SceneAnimation { None, Spin, Bob };
+
+struct StreamingSettings {
+    float cellSize = 32.0f;             // lado de la celda en XZ
+    float loadRadius = 60.0f;           // se carga cada celda más cerca que esto...
+    float unloadRadius = 80.0f;         // ...y se descarga más allá de esto (histéresis)
+    float lookAhead = 1.5f;             // segundos de vuelo que se anticipan con la velocidad
+    size_t residentBytes = 256u * 1024u * 1024u;   // geometría residente de las celdas
+    size_t uploadBytes = 4u * 1024u * 1024u;       // subida a GPU por frame
+};
+
+struct SwarmDesc {
+    std::string path;                   // modelo de cada dron, ya resuelto; vacío si no hay enjambre
+    float scale = 1.0f;
+    int count = 0;                      // drones (--swarm N lo reemplaza)
+    int routes = 12;                    // órbitas distintas
+    float minRadius = 12.0f, maxRadius = 60.0f;     // radio de las órbitas alrededor del punto de salida
+    float minHeight = 3.0f, maxHeight = 18.0f;      // altura sobre el punto de salida
+};
+
+struct SceneObjectDesc {
+    std::string name;
+    std::string path;               // ya resuelta contra la raíz de assets
+    int priority = 0;
+    bool optional = false;          // si falta el archivo se omite sin error
+    bool collision = false;         // sus triángulos entran en la BVH del dron
+    bool staticBatch = false;       // se dibuja en el lote estático (sin transformación)
+    bool lamps = false;             // cada malla es una lámpara: luz puntual en su centro
+    bool emissive = false;          // ignora luces y niebla
+    bool fog = true;                // false: sin niebla en lighting.fs ni descarte por niebla en el culling
+    bool stream = false;            // se carga y descarga por distancia (no es static ni lamps)
+    bool occluder = false;          // sus paredes y pisos tapan mallas en el culling por oclusión
+
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f);      // grados, aplicados en orden Y, X, Z
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    // Spin: gira 'speed' rad/s sobre 'axis'. Bob: se desplaza sobre 'axis'
+    // amplitude * sin(speed * t + phase). Ambos en el espacio del objeto.
+    SceneAnimation animation = SceneAnimation::None;
+    glm::vec3 axis = glm::vec3(0.0f, 1.0f, 0.0f);
+    float speed = 0.0f;
+    float amplitude = 0.0f;
+    float phase = 0.0f;
+
+    bool animated() const { return animation != SceneAnimation::None; }
+    bool loadAtStartup() const { return !stream && (priority <= 0 || collision || staticBatch || lamps || occluder); }
+
+    glm::mat4 baseTransform() const {
+        glm::mat4 m = glm::translate(glm::mat4(1.0f), position);
+        m = glm::rotate(m, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+        m = glm::rotate(m, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+        m = glm::rotate(m, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        return glm::scale(m, scale);
+    }
+
+    glm::mat4 transformAt(float time) const {
+        glm::mat4 m = baseTransform();
+        if (animation == SceneAnimation::Spin)
+            m = glm::rotate(m, time * speed + phase, axis);
+        else if (animation == SceneAnimation::Bob)
+            m = glm::translate(m, axis * (std::sin(time * speed + phase) * amplitude));
+        return m;
+    }
+};
+
+struct SceneManifest {
+    std::string assetRoot;
+    std::vector<SceneObjectDesc> objects;       // ordenados por prioridad (estable)
+    std::string hudFrame;                       // textura del marco del HUD; vacía si no hay
+    glm::vec3 lightColor = glm::vec3(1.0f);
+    float lightIntensity = 35.0f;
+    std::vector<glm::vec3> lightPositions;      // además de las lámparas de los modelos
+    StreamingSettings streaming;
+    SwarmDesc swarm;
+};
+
+namespace manifest_detail {
+
+inline bool isAbsolutePath(const std::string& path) {
+    return !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+}
+
+inline std::string joinPath(const std::string& root, const std::string& path) {
+    if (root.empty() || isAbsolutePath(path)) return path;
+    char last = root.back();
+    return last == '/' || last == '\\' ? root + path : root + "/" + path;
+}
+
+inline bool readFloat(const JsonValue& v, float& out) {
+    if (!v.isNumber()) return false;
+    out = (float)v.number;
+    return true;
+}
+
+// [x, y, z]; si 'allowScalar', un número solo vale para los tres ejes.
+inline bool readVec3(const JsonValue& v, glm::vec3& out, bool allowScalar = false) {
+    if (allowScalar && v.isNumber()) {
+        out = glm::vec3((float)v.number);
+        return true;
+    }
+    if (!v.isArray() || v.items.size() != 3) return false;
+    for (int i = 0; i < 3; i++)
+        if (!readFloat(v.items[i], out[i])) return false;
+    return true;
+}
+
+// [min, max] con min <= max.
+inline bool readRange(const JsonValue& v, float& mn, float& mx) {
+    return v.isArray() && v.items.size() == 2 && readFloat(v.items[0], mn) && readFloat(v.items[1], mx) && mn <= mx;
+}
+
+inline bool readBool(const JsonValue& v, bool& out) {
+    if (!v.isBool()) return false;
+    out = v.boolean;
+    return true;
+}
+
+inline bool readAnimation(const JsonValue& v, SceneObjectDesc& desc, std::string& error) {
+    if (!v.isObject()) { error = "'animation' must be an object"; return false; }
+    for (const auto& member : v.members) {
+        const std::string& key = member.first;
+        const JsonValue& value = member.second;
+        bool ok;
+        if (key == "type") {
+            ok = value.isString() && (value.string == "spin" || value.string == "bob");
+            if (ok) desc.animation = value.string == "spin" ? SceneAnimation::Spin : SceneAnimation::Bob;
+        }
+        else if (key == "axis") ok = readVec3(value, desc.axis) && glm::length(desc.axis) > 0.0f;
+        else if (key == "speed") ok = readFloat(value, desc.speed);
+        else if (key == "amplitude") ok = readFloat(value, desc.amplitude);
+        else if (key == "phase") ok = readFloat(value, desc.phase);
+        else { error = "unknown animation key '" + key + "'"; return false; }
+        if (!ok) { error = "invalid animation '" + key + "'"; return false; }
+    }
+    if (desc.animation == SceneAnimation::None) { error = "animation without 'type'"; return false; }
+    desc.axis = glm::normalize(desc.axis);
+    return true;
+}
+
+inline bool readObject(const JsonValue& v, const std::string& root, SceneObjectDesc& desc, std::string& error) {
+    if (!v.isObject()) { error = "every model must be an object"; return false; }
+    bool moved = false;
+    for (const auto& member : v.members) {
+        const std::string& key = member.first;
+        const JsonValue& value = member.second;
+        bool ok;
+        if (key == "name") { ok = value.isString(); desc.name = value.string; }
+        else if (key == "path") { ok = value.isString() && !value.string.empty(); desc.path = joinPath(root, value.string); }
+        else if (key == "priority") { ok = value.isNumber(); desc.priority = (int)value.number; }
+        else if (key == "optional") ok = readBool(value, desc.optional);
+        else if (key == "collision") ok = readBool(value, desc.collision);
+        else if (key == "static") ok = readBool(value, desc.staticBatch);
+        else if (key == "lamps") ok = readBool(value, desc.lamps);
+        else if (key == "emissive") ok = readBool(value, desc.emissive);
+        else if (key == "fog") ok = readBool(value, desc.fog);
+        else if (key == "stream") ok = readBool(value, desc.stream);
+        else if (key == "occluder") ok = readBool(value, desc.occluder);
+        else if (key == "position") { ok = readVec3(value, desc.position); moved = true; }
+        else if (key == "rotation") { ok = readVec3(value, desc.rotation); moved = true; }
+        else if (key == "scale") { ok = readVec3(value, desc.scale, true); moved = true; }
+        else if (key == "animation") {
+            if (!readAnimation(value, desc, error)) { error = "model '" + desc.name + "': " + error; return false; }
+            ok = moved = true;
+        }
+        else { error = "model '" + desc.name + "': unknown key '" + key + "'"; return false; }
+        if (!ok) { error = "model '" + desc.name + "': invalid '" + key + "'"; return false; }
+    }
+    if (desc.path.empty()) { error = "model '" + desc.name + "' without 'path'"; return false; }
+    if (desc.name.empty()) desc.name = desc.path.substr(desc.path.find_last_of("/\\") + 1);
+    // El lote estático y la BVH usan los vértices tal cual, sin transformación
+    if (moved && (desc.staticBatch || desc.collision)) {
+        error = "model '" + desc.name + "': static and collision models cannot be moved or animated";
+        return false;
+    }
+    // El lote estático y las luces se arman una sola vez al arrancar
+    if (desc.stream && (desc.staticBatch || desc.lamps)) {
+        error = "model '" + desc.name + "': streamed models cannot be static or lamps";
+        return false;
+    }
+    // Los triángulos de los oclusores se pasan a mundo una sola vez
+    if (desc.occluder && (desc.stream || desc.animated())) {
+        error = "model '" + desc.name + "': occluders cannot be streamed or animated";
+        return false;
+    }
+    return true;
+}
+
+inline bool readStreaming(const JsonValue& v, StreamingSettings& out, std::string& error) {
+    if (!v.isObject()) { error = "'streaming' must be an object"; return false; }
+    for (const auto& member : v.members) {
+        const std::string& key = member.first;
+        const JsonValue& value = member.second;
+        float number = 0.0f;
+        if (!readFloat(value, number) || number <= 0.0f) { error = "invalid streaming '" + key + "'"; return false; }
+        if (key == "cellSize") out.cellSize = number;
+        else if (key == "loadRadius") out.loadRadius = number;
+        else if (key == "unloadRadius") out.unloadRadius = number;
+        else if (key == "lookAhead") out.lookAhead = number;
+        else if (key == "residentMB") out.residentBytes = (size_t)(number * 1024.0f * 1024.0f);
+        else if (key == "uploadKBPerFrame") out.uploadBytes = (size_t)(number * 1024.0f);
+        else { error = "unknown streaming key '" + key + "'"; return false; }
+    }
+    if (out.unloadRadius < out.loadRadius) { error = "streaming 'unloadRadius' must not be below 'loadRadius'"; return false; }
+    return true;
+}
+
+inline bool readSwarm(const JsonValue& v, const std::string& root, SwarmDesc& out, std::string& error) {
+    if (!v.isObject()) { error = "'swarm' must be an object"; return false; }
+    for (const auto& member : v.members) {
+        const std::string& key = member.first;
+        const JsonValue& value = member.second;
+        float number = 0.0f;
+        bool ok = true;
+        if (key == "model") {
+            ok = value.isString();
+            if (ok) out.path = joinPath(root, value.string);
+        }
+        else if (key == "scale") ok = readFloat(value, out.scale) && out.scale > 0.0f;
+        else if (key == "count") { ok = readFloat(value, number) && number >= 0.0f; out.count = (int)number; }
+        else if (key == "routes") { ok = readFloat(value, number) && number >= 1.0f; out.routes = (int)number; }
+        else if (key == "radius") ok = readRange(value, out.minRadius, out.maxRadius) && out.minRadius >= 0.0f;
+        else if (key == "height") ok = readRange(value, out.minHeight, out.maxHeight);
+        else { error = "unknown swarm key '" + key + "'"; return false; }
+        if (!ok) { error = "invalid swarm '" + key + "'"; return false; }
+    }
+    if (out.path.empty()) { error = "'swarm' needs a 'model'"; return false; }
+    return true;
+}
+
+} // namespace manifest_detail
+
+// Lee el manifiesto de 'path'. Si 'assetRootOverride' no está vacío reemplaza
+// al "assetRoot" del archivo (y es relativo al directorio de trabajo).
+inline bool loadSceneManifest(const std::string& path, const std::string& assetRootOverride,
+                              SceneManifest& out, std::string& error) {
+    using namespace manifest_detail;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) { error = "cannot open " + path; return false; }
+    std::stringstream text;
+    text << in.rdbuf();
+
+    JsonValue root;
+    if (!JsonReader::parse(text.str(), root, error)) { error = path + ": " + error; return false; }
+    if (!root.isObject()) { error = path + ": the manifest must be an object"; return false; }
+
+    out = SceneManifest();
+    size_t slash = path.find_last_of("/\\");
+    std::string manifestDir = slash == std::string::npos ? std::string() : path.substr(0, slash);
+    const JsonValue* rootValue = root.find("assetRoot");
+    if (!assetRootOverride.empty()) out.assetRoot = assetRootOverride;
+    else if (rootValue && rootValue->isString()) out.assetRoot = joinPath(manifestDir, rootValue->string);
+    else out.assetRoot = manifestDir;
+
+    for (const auto& member : root.members) {
+        const std::string& key = member.first;
+        const JsonValue& value = member.second;
+        bool ok = true;
+        if (key == "assetRoot") ok = value.isString();
+        else if (key == "hud") {
+            const JsonValue* frame = value.find("frame");
+            ok = value.isObject() && frame && frame->isString();
+            if (ok) out.hudFrame = joinPath(out.assetRoot, frame->string);
+        }
+        else if (key == "lights") {
+            ok = value.isObject();
+            for (const auto& light : value.members) {
+                if (!ok) break;
+                if (light.first == "color") ok = readVec3(light.second, out.lightColor);
+                else if (light.first == "intensity") ok = readFloat(light.second, out.lightIntensity);
+                else if (light.first == "positions") {
+                    ok = light.second.isArray();
+                    for (const auto& p : light.second.items) {
+                        glm::vec3 position;
+                        ok = ok && readVec3(p, position);
+                        out.lightPositions.push_back(position);
+                    }
+                }
+                else ok = false;
+            }
+        }
+        else if (key == "streaming") {
+            if (!readStreaming(value, out.streaming, error)) { error = path + ": " + error; return false; }
+        }
+        else if (key == "swarm") {
+            if (!readSwarm(value, out.assetRoot, out.swarm, error)) { error = path + ": " + error; return false; }
+        }
+        else if (key == "models") {
+            ok = value.isArray();
+            for (const auto& item : value.items) {
+                if (!ok) break;
+                SceneObjectDesc desc;
+                if (!readObject(item, out.assetRoot, desc, error)) { error = path + ": " + error; return false; }
+                out.objects.push_back(desc);
+            }
+        }
+        else { error = path + ": unknown key '" + key + "'"; return false; }
+        if (!ok) { error = path + ": invalid '" + key + "'"; return false; }
+    }
+
+    std::stable_sort(out.objects.begin(), out.objects.end(),
+                     [](const SceneObjectDesc& a, const SceneObjectDesc& b) { return a.priority < b.priority; });
+    return true;
+}
+
+#endif
@@ -0,0 +1,276 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <glad/glad.h>
+
+#include "gpu_resources.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+// Permutaciones de un shader en tiempo de compilación: cada bit de la máscara
+// es un #define que se inserta después de la línea #version, así el programa
+// de cada combinación no tiene ramas por uniform y el compilador elimina lo
+// que esa combinación no usa. El llamador elige la máscara por dibujo.
+//
+// Los programas enlazados se guardan con glGetProgramBinary en
+// <cacheDir>/<nombre>-<máscara>.bin; en el siguiente arranque se cargan con
+// glProgramBinary sin compilar ni enlazar. El archivo lleva el hash del código
+// fuente (con los #define) y del driver (GL_VENDOR, GL_RENDERER, GL_VERSION):
+// si algo cambia, o el driver rechaza el binario, se vuelve a compilar.
+// glGetProgramBinary es del núcleo 4.1; con el contexto 3.3 de la aplicación
+// llega por GL_ARB_get_program_binary, que tiene las mismas funciones.
+
+#if defined(GL_VERSION_4_1) || defined(GL_ARB_get_program_binary)
+#define SHADER_PROGRAM_BINARIES
+#endif
+
+struct ShaderDefine {
+    uint32_t bit;
+    const char* name;
+};
+
+struct ShaderVariantStats {
+    int compiled = 0;
+    int loadedFromDisk = 0;
+    double milliseconds = 0.0;
+};
+
+// Lee un archivo de shader entero; vacío si no existe.
+inline std::string readShaderFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cout << "SHADER::MISSING " << path << std::endl;
+        return std::string();
+    }
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+class ShaderVariants {
+public:
+    ShaderVariantStats stats;
+
+    ShaderVariants(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource,
+                   const std::vector<ShaderDefine>& defines, const std::string& cacheDir = "shader_cache")
+        : name(name), vertexSource(vertexSource), fragmentSource(fragmentSource), defines(defines), cacheDir(cacheDir) {
+#ifdef SHADER_PROGRAM_BINARIES
+        bool supported = false;
+#ifdef GL_VERSION_4_1
+        supported = supported || GLAD_GL_VERSION_4_1;
+#endif
+#ifdef GL_ARB_get_program_binary
+        supported = supported || GLAD_GL_ARB_get_program_binary;
+#endif
+        GLint formats = 0;
+        if (supported) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        binaries = formats > 0;
+#endif
+        if (!binaries)
+            std::cout << "SHADER::CACHE " << name << ": el driver no ofrece binarios de programa, se compila en cada arranque" << std::endl;
+        std::string driver;
+        for (GLenum e : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const char* s = (const char*)glGetString(e);
+            driver += s ? s : "";
+            driver += '\n';
+        }
+        driverHash = hashBytes(driver.data(), driver.size());
+    }
+
+    ~ShaderVariants() {
+        for (const auto& entry : programs) glDeleteProgram(entry.second);
+    }
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // Se llama con cada programa recién creado (compilado o cargado del disco):
+    // samplers y bloques de uniforms, que un binario no conserva.
+    void setProgramSetup(std::function<void(GLuint)> setup) { programSetup = std::move(setup); }
+
+    // Crea de una vez las combinaciones que se van a usar, para no compilar en medio de un frame.
+    void prepare(const std::vector<uint32_t>& masks) {
+        for (uint32_t mask : masks) program(mask);
+    }
+
+    // Programa de la combinación 'mask'; 0 si no compila.
+    GLuint program(uint32_t mask) {
+        auto it = programs.find(mask);
+        if (it != programs.end()) return it->second;
+
+        auto start = std::chrono::steady_clock::now();
+        std::string vs = withDefines(vertexSource, mask), fs = withDefines(fragmentSource, mask);
+        uint64_t sourceHash = hashBytes(fs.data(), fs.size(), hashBytes(vs.data(), vs.size()));
+        const std::string path = binaryPath(mask);
+
+        GLuint id = loadBinary(path, sourceHash);
+        if (id) stats.loadedFromDisk++;
+        else {
+            id = compile(vs, fs, mask);
+            if (id) {
+                stats.compiled++;
+                saveBinary(id, path, sourceHash);
+            }
+        }
+        if (id && programSetup) programSetup(id);
+        stats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        programs[mask] = id;
+        return id;
+    }
+
+private:
+    static const uint32_t BINARY_MAGIC = 0x4E425053;    // "SPBN"
+    static const uint32_t BINARY_VERSION = 1;
+
+    struct BinaryHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+        uint64_t driverHash;
+        uint32_t format;
+        uint32_t size;
+    };
+
+    std::string name, vertexSource, fragmentSource;
+    std::vector<ShaderDefine> defines;
+    std::string cacheDir;
+    std::map<uint32_t, GLuint> programs;
+    std::function<void(GLuint)> programSetup;
+    uint64_t driverHash = 0;
+    bool binaries = false;
+
+    std::string binaryPath(uint32_t mask) const {
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "-%02x.bin", mask);
+        return cacheDir + '/' + name + suffix;
+    }
+
+    // Los #define van justo después de #version (que tiene que ser la primera directiva).
+    std::string withDefines(const std::string& source, uint32_t mask) const {
+        std::string block;
+        for (const auto& d : defines)
+            if (mask & d.bit) block += std::string("#define ") + d.name + " 1\n";
+        size_t version = source.find("#version");
+        size_t insert = version == std::string::npos ? 0 : source.find('\n', version);
+        if (insert == std::string::npos) return source + '\n' + block;
+        if (version != std::string::npos) insert++;
+        return source.substr(0, insert) + block + source.substr(insert);
+    }
+
+    std::string describe(uint32_t mask) const {
+        std::string text = name;
+        for (const auto& d : defines)
+            if (mask & d.bit) text += std::string(" ") + d.name;
+        return text;
+    }
+
+    GLuint compileStage(GLenum type, const std::string& source, uint32_t mask) const {
+        GLuint shader = glCreateShader(type);
+        const char* text = source.c_str();
+        glShaderSource(shader, 1, &text, NULL);
+        glCompileShader(shader);
+        GLint ok = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+            std::cout << "SHADER::COMPILE " << describe(mask) << (type == GL_VERTEX_SHADER ? " (vertex)\n" : " (fragment)\n")
+                      << log << std::endl;
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    GLuint compile(const std::string& vs, const std::string& fs, uint32_t mask) const {
+        GLuint vertex = compileStage(GL_VERTEX_SHADER, vs, mask);
+        GLuint fragment = compileStage(GL_FRAGMENT_SHADER, fs, mask);
+        if (!vertex || !fragment) {
+            glDeleteShader(vertex);
+            glDeleteShader(fragment);
+            return 0;
+        }
+        GLuint id = glCreateProgram();
+#ifdef SHADER_PROGRAM_BINARIES
+        if (binaries) glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+        glAttachShader(id, vertex);
+        glAttachShader(id, fragment);
+        glLinkProgram(id);
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        GLint ok = 0;
+        glGetProgramiv(id, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetProgramInfoLog(id, sizeof(log), NULL, log);
+            std::cout << "SHADER::LINK " << describe(mask) << "\n" << log << std::endl;
+            glDeleteProgram(id);
+            return 0;
+        }
+        return id;
+    }
+
+    GLuint loadBinary(const std::string& path, uint64_t sourceHash) const {
+#ifdef SHADER_PROGRAM_BINARIES
+        if (!binaries) return 0;
+        std::ifstream in(path, std::ios::binary);
+        BinaryHeader header;
+        if (!in || !in.read((char*)&header, sizeof(header))) return 0;
+        if (header.magic != BINARY_MAGIC || header.version != BINARY_VERSION ||
+            header.sourceHash != sourceHash || header.driverHash != driverHash) return 0;
+        std::vector<char> data(header.size);
+        if (!in.read(data.data(), (std::streamsize)data.size())) return 0;
+
+        GLuint id = glCreateProgram();
+        glProgramBinary(id, (GLenum)header.format, data.data(), (GLsizei)data.size());
+        GLint ok = 0;
+        glGetProgramiv(id, GL_LINK_STATUS, &ok);
+        if (ok) return id;
+        glDeleteProgram(id);    // el driver no lo acepta (p. ej. se actualizó): se recompila
+#else
+        (void)path;
+        (void)sourceHash;
+#endif
+        return 0;
+    }
+
+    // Temporal + rename, como la caché de escena: nunca queda un binario a medias.
+    void saveBinary(GLuint id, const std::string& path, uint64_t sourceHash) const {
+#ifdef SHADER_PROGRAM_BINARIES
+        if (!binaries) return;
+        GLint length = 0;
+        glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+        std::vector<char> data((size_t)length);
+        GLenum format = 0;
+        glGetProgramBinary(id, length, &length, &format, data.data());
+
+        std::error_code error;
+        std::filesystem::create_directories(cacheDir, error);
+        const std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out) return;
+            BinaryHeader header = { BINARY_MAGIC, BINARY_VERSION, sourceHash, driverHash, (uint32_t)format, (uint32_t)length };
+            out.write((const char*)&header, sizeof(header));
+            out.write(data.data(), length);
+            if (!out) return;
+        }
+        std::filesystem::rename(tmpPath, path, error);
+#else
+        (void)id;
+        (void)path;
+        (void)sourceHash;
+#endif
+    }
+};
+
+#endif
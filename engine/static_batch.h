@@ -0,0 +1,445 @@
+#ifndef STATIC_BATCH_H
+#define STATIC_BATCH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "render_queue.h"
+#include "scene_cache.h"
+#include "texture_streamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Agrupación estática: al cargar, todas las mallas de los modelos estáticos
+// (casa y lámparas, todos con matriz identidad) se copian a un único VBO/EBO,
+// ordenadas por material. La textura difusa de cada material se copia a una
+// capa de un GL_TEXTURE_2D_ARRAY (uno por tamaño) y la capa va como atributo
+// por vértice, así que cada frame basta con un glMultiDraw por array de
+// texturas, con solo los rangos que dejó pasar el culling.
+
+const GLuint TEXTURE_LAYER_ATTRIB = 7;       // layout (location = 7) en lighting.vs
+const int TEXTURE_ARRAY_MAX_SIZE = 2048;     // las texturas más grandes se reducen al copiarlas
+
+// Mismo layout que DrawElementsIndirectCommand de GL 4.3.
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+inline int nextPowerOfTwo(int v) {
+    int p = 1;
+    while (p < v && p < TEXTURE_ARRAY_MAX_SIZE) p <<= 1;
+    return p;
+}
+
+class StaticBatch {
+public:
+    struct Draw {
+        GLuint arrayTexture;
+        const MultiDraw* commands;
+    };
+
+    explicit StaticBatch(const TextureStreamer* streamer = nullptr) : streamer(streamer) {
+#ifdef GL_VERSION_4_3
+        useIndirect = GLAD_GL_VERSION_4_3 != 0;
+#endif
+    }
+
+    ~StaticBatch() {
+        if (vao) glDeleteVertexArrays(1, &vao);
+        GLuint buffers[4] = { vbo, layerVbo, ebo, indirectBuffer };
+        for (GLuint b : buffers)
+            if (b) glDeleteBuffers(1, &b);
+        for (const auto& bucket : buckets)
+            if (bucket.texture) glDeleteTextures(1, &bucket.texture);
+        if (framebuffers[0]) glDeleteFramebuffers(2, framebuffers);
+        if (copyProgram) glDeleteProgram(copyProgram);
+        if (copyVao) glDeleteVertexArrays(1, &copyVao);
+    }
+    StaticBatch(const StaticBatch&) = delete;
+    StaticBatch& operator=(const StaticBatch&) = delete;
+
+    // Antes de build(). Devuelve el índice que usa gather().
+    int add(const SceneModel& model) {
+        sources.push_back(&model);
+        return (int)sources.size() - 1;
+    }
+
+    // Copia todas las mallas a los buffers compartidos, agrupadas por material.
+    void build() {
+        struct Entry { int source; uint32_t mesh; GLuint texture; };
+        std::vector<Entry> entries;
+        for (size_t s = 0; s < sources.size(); s++)
+            for (size_t m = 0; m < sources[s]->meshes.size(); m++) {
+                const SceneMesh& mesh = sources[s]->meshes[m];
+                GLuint texture = mesh.textures.empty() ? 0 : mesh.textures[0].id;   // unidad 0 = material.diffuse
+                entries.push_back({ (int)s, (uint32_t)m, texture });
+            }
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const Entry& a, const Entry& b) { return a.texture < b.texture; });
+
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        meshRanges.assign(sources.size(), std::vector<int>());
+        for (size_t s = 0; s < sources.size(); s++)
+            meshRanges[s].assign(sources[s]->meshes.size(), -1);
+
+        std::map<GLuint, int> materialIds;
+        for (const Entry& e : entries) {
+            const SceneMesh& mesh = sources[e.source]->meshes[e.mesh];
+            auto found = materialIds.find(e.texture);
+            int material;
+            if (found == materialIds.end()) {
+                material = (int)materials.size();
+                materialIds.emplace(e.texture, material);
+                Material mat;
+                mat.source = e.texture;
+                mat.model = e.source;
+                mat.mesh = e.mesh;
+                mat.firstVertex = (uint32_t)vertices.size();
+                materials.push_back(mat);
+            }
+            else {
+                material = found->second;
+            }
+
+            Range range;
+            range.material = material;
+            range.count = (GLsizei)mesh.indices.size();
+            range.firstIndex = (GLuint)indices.size();
+            range.baseVertex = (GLint)vertices.size();
+            meshRanges[e.source][e.mesh] = (int)ranges.size();
+            ranges.push_back(range);
+
+            vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+            indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+            materials[material].vertexCount = (uint32_t)vertices.size() - materials[material].firstVertex;
+        }
+        vertexCount = vertices.size();
+        indexCount = indices.size();
+
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glGenBuffers(1, &layerVbo);
+        glGenBuffers(1, &ebo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        setupVertexAttributes();
+
+        // Capa de textura por vértice (0 = placeholder gris hasta que llegue la textura)
+        layers.assign(vertices.size(), 0.0f);
+        glBindBuffer(GL_ARRAY_BUFFER, layerVbo);
+        glBufferData(GL_ARRAY_BUFFER, layers.size() * sizeof(float), layers.data(), GL_DYNAMIC_DRAW);
+        glEnableVertexAttribArray(TEXTURE_LAYER_ATTRIB);
+        glVertexAttribPointer(TEXTURE_LAYER_ATTRIB, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        if (useIndirect) glGenBuffers(1, &indirectBuffer);
+        glGenFramebuffers(2, framebuffers);
+        createCopyProgram();
+
+        // Array 1x1 con el mismo gris que el placeholder del streamer
+        const unsigned char grey[4] = { 128, 128, 128, 255 };
+        Bucket placeholder;
+        placeholder.width = placeholder.height = 1;
+        createArray(placeholder, 4);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, placeholder.texture);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        placeholder.layers = 1;
+        buckets.push_back(placeholder);
+
+        updateTextures();
+    }
+
+    // Una vez por frame, después de TextureStreamer::pump(): copia a su capa
+    // las texturas que terminaron de subirse.
+    void updateTextures() {
+        if (streamer && streamer->completedUploads() == seenUploads && texturesChecked) return;
+        if (streamer) seenUploads = streamer->completedUploads();
+        texturesChecked = true;
+
+        bool changed = false;
+        for (Material& mat : materials) {
+            if (mat.resident || mat.source == 0) continue;
+            // Si la textura resultó igual a otra, GpuResources ya cambió el nombre en la malla
+            mat.source = sources[mat.model]->meshes[mat.mesh].textures[0].id;
+            if (streamer && !streamer->resident(mat.source)) continue;
+
+            GLint w = 1, h = 1;
+            glBindTexture(GL_TEXTURE_2D, mat.source);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h);
+
+            mat.bucket = bucketFor(nextPowerOfTwo(w), nextPowerOfTwo(h));
+            Bucket& bucket = buckets[mat.bucket];
+            if (bucket.layers == bucket.capacity) grow(bucket);
+            mat.layer = bucket.layers++;
+            copyToLayer(mat.source, w, h, bucket, mat.layer);
+            bucket.dirty = true;
+            mat.resident = true;
+
+            std::fill(layers.begin() + mat.firstVertex, layers.begin() + mat.firstVertex + mat.vertexCount, (float)mat.layer);
+            glBindBuffer(GL_ARRAY_BUFFER, layerVbo);
+            glBufferSubData(GL_ARRAY_BUFFER, mat.firstVertex * sizeof(float), mat.vertexCount * sizeof(float),
+                            layers.data() + mat.firstVertex);
+            changed = true;
+        }
+        if (!changed) return;
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        for (Bucket& bucket : buckets) {
+            if (!bucket.dirty) continue;
+            glBindTexture(GL_TEXTURE_2D_ARRAY, bucket.texture);
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+            bucket.dirty = false;
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    // --- Por frame: el culling escribe directamente los comandos ---
+    void beginFrame() {
+        commands.resize(buckets.size());
+        for (auto& c : commands) c.clear();
+        indirect.clear();
+    }
+
+    // Mallas visibles (índices en model.meshes) del modelo 'source'.
+    void gather(int source, const std::vector<uint32_t>& visible) {
+        for (uint32_t m : visible) {
+            int r = meshRanges[source][m];
+            if (r < 0 || ranges[r].count == 0) continue;
+            const Range& range = ranges[r];
+            MultiDraw& cmd = commands[materials[range.material].bucket];
+            cmd.counts.push_back(range.count);
+            cmd.offsets.push_back((const void*)(uintptr_t)(range.firstIndex * sizeof(unsigned int)));
+            cmd.baseVertices.push_back(range.baseVertex);
+        }
+    }
+
+    // Cierra el frame: con GL 4.3 sube los comandos al buffer indirecto.
+    const std::vector<Draw>& endFrame() {
+        draws.clear();
+        for (size_t b = 0; b < commands.size(); b++) {
+            MultiDraw& cmd = commands[b];
+            if (cmd.size() == 0) continue;
+            if (useIndirect) {
+                cmd.indirectBuffer = indirectBuffer;
+                cmd.indirectOffset = (GLintptr)(indirect.size() * sizeof(DrawElementsIndirectCommand));
+                for (GLsizei i = 0; i < cmd.size(); i++) {
+                    DrawElementsIndirectCommand c;
+                    c.count = (GLuint)cmd.counts[i];
+                    c.instanceCount = 1;
+                    c.firstIndex = (GLuint)((uintptr_t)cmd.offsets[i] / sizeof(unsigned int));
+                    c.baseVertex = cmd.baseVertices[i];
+                    c.baseInstance = 0;
+                    indirect.push_back(c);
+                }
+            }
+            draws.push_back({ buckets[b].texture, &cmd });
+        }
+#ifdef GL_VERSION_4_3
+        if (useIndirect && !indirect.empty()) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, indirect.size() * sizeof(DrawElementsIndirectCommand),
+                         indirect.data(), GL_STREAM_DRAW);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+#endif
+        return draws;
+    }
+
+    GLuint vertexArray() const { return vao; }
+    size_t meshCount() const { return ranges.size(); }
+    size_t materialCount() const { return materials.size(); }
+    size_t arrayCount() const { return buckets.size(); }
+    size_t triangleCount() const { return indexCount / 3; }
+    bool usesIndirect() const { return useIndirect; }
+
+private:
+    struct Material {
+        GLuint source = 0;          // textura 2D original
+        int model = 0;              // primera malla que la usa (de ahí se relee el nombre)
+        uint32_t mesh = 0;
+        int bucket = 0;             // 0 = placeholder mientras no llega
+        int layer = 0;
+        bool resident = false;
+        uint32_t firstVertex = 0;
+        uint32_t vertexCount = 0;
+    };
+
+    struct Range {
+        int material;
+        GLsizei count;
+        GLuint firstIndex;
+        GLint baseVertex;
+    };
+
+    struct Bucket {
+        int width = 0, height = 0;
+        GLuint texture = 0;
+        int layers = 0, capacity = 0;
+        bool dirty = false;
+    };
+
+    const TextureStreamer* streamer;
+    bool useIndirect = false;
+    std::vector<const SceneModel*> sources;
+    std::vector<std::vector<int>> meshRanges;   // [modelo][malla] -> ranges
+    std::vector<Range> ranges;
+    std::vector<Material> materials;
+    std::vector<Bucket> buckets;
+    std::vector<float> layers;
+    size_t vertexCount = 0, indexCount = 0;
+
+    GLuint vao = 0, vbo = 0, layerVbo = 0, ebo = 0, indirectBuffer = 0;
+    GLuint framebuffers[2] = { 0, 0 };
+    GLuint copyProgram = 0, copyVao = 0;
+    GLint copyLodLocation = -1;
+    uint64_t seenUploads = 0;
+    bool texturesChecked = false;
+
+    std::vector<MultiDraw> commands;            // uno por array de texturas
+    std::vector<DrawElementsIndirectCommand> indirect;
+    std::vector<Draw> draws;
+
+    static int mipLevels(int w, int h) {
+        int levels = 1;
+        while ((w | h) >> levels) levels++;
+        return levels;
+    }
+
+    void createArray(Bucket& bucket, int capacity) {
+        bucket.capacity = capacity;
+        glGenTextures(1, &bucket.texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, bucket.texture);
+        int levels = mipLevels(bucket.width, bucket.height);
+        for (int level = 0; level < levels; level++)
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, std::max(1, bucket.width >> level),
+                         std::max(1, bucket.height >> level), capacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    int bucketFor(int w, int h) {
+        for (size_t b = 0; b < buckets.size(); b++)
+            if (buckets[b].width == w && buckets[b].height == h) return (int)b;
+        Bucket bucket;
+        bucket.width = w;
+        bucket.height = h;
+        createArray(bucket, 4);
+        buckets.push_back(bucket);
+        return (int)buckets.size() - 1;
+    }
+
+    // Duplica la capacidad copiando las capas existentes al array nuevo.
+    void grow(Bucket& bucket) {
+        Bucket bigger = bucket;
+        createArray(bigger, bucket.capacity * 2);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[0]);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers[1]);
+        for (int layer = 0; layer < bucket.layers; layer++) {
+            glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, bucket.texture, 0, layer);
+            glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, bigger.texture, 0, layer);
+            glBlitFramebuffer(0, 0, bucket.width, bucket.height, 0, 0, bucket.width, bucket.height,
+                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteTextures(1, &bucket.texture);
+        bucket.texture = bigger.texture;
+        bucket.capacity = bigger.capacity;
+        bucket.dirty = true;
+    }
+
+    // Triángulo que cubre la capa y muestrea la textura original. Un blit no
+    // sirve: las texturas comprimidas (.ktx) no pueden ir en un framebuffer.
+    void createCopyProgram() {
+        const char* vs = R"(
+            #version 330 core
+            out vec2 uv;
+            void main() {
+                uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+                gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+            }
+        )";
+        const char* fs = R"(
+            #version 330 core
+            in vec2 uv;
+            out vec4 color;
+            uniform sampler2D source;
+            uniform float lod;
+            void main() { color = textureLod(source, uv, lod); }
+        )";
+        GLuint shaders[2] = { glCreateShader(GL_VERTEX_SHADER), glCreateShader(GL_FRAGMENT_SHADER) };
+        glShaderSource(shaders[0], 1, &vs, NULL);
+        glShaderSource(shaders[1], 1, &fs, NULL);
+        copyProgram = glCreateProgram();
+        char log[1024];
+        GLint ok = 0;
+        for (GLuint s : shaders) {
+            glCompileShader(s);
+            glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+            if (!ok) {
+                glGetShaderInfoLog(s, sizeof(log), NULL, log);
+                std::cout << "ERROR::SHADER_COMPILATION_ERROR (copia a capas)\n" << log << std::endl;
+            }
+            glAttachShader(copyProgram, s);
+        }
+        glLinkProgram(copyProgram);
+        glGetProgramiv(copyProgram, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            glGetProgramInfoLog(copyProgram, sizeof(log), NULL, log);
+            std::cout << "ERROR::PROGRAM_LINKING_ERROR (copia a capas)\n" << log << std::endl;
+        }
+        for (GLuint s : shaders) glDeleteShader(s);
+        copyLodLocation = glGetUniformLocation(copyProgram, "lod");
+        glGenVertexArrays(1, &copyVao);
+    }
+
+    // Copia (y escala) la textura 2D a la capa dibujando en ella; al reducir se
+    // lee el mipmap que corresponde. GL 3.3 no tiene glCopyImageSubData.
+    void copyToLayer(GLuint source, int w, int h, const Bucket& bucket, int layer) {
+        GLint viewport[4], program = 0;
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        const GLboolean depth = glIsEnabled(GL_DEPTH_TEST), blend = glIsEnabled(GL_BLEND);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers[1]);
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, bucket.texture, 0, layer);
+        glViewport(0, 0, bucket.width, bucket.height);
+        glUseProgram(copyProgram);
+        glUniform1f(copyLodLocation, std::max(0.0f, std::log2((float)std::max(w, h) / (float)std::max(bucket.width, bucket.height))));
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, source);
+        glBindVertexArray(copyVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        glUseProgram((GLuint)program);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        if (depth) glEnable(GL_DEPTH_TEST);
+        if (blend) glEnable(GL_BLEND);
+    }
+};
+
+#endif
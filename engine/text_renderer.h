@@ -0,0 +1,279 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Texto del HUD con un atlas de glifos: una fuente bitmap de 5x7 incluida en
+// el código se hornea una vez en una textura GL_R8, y cada glifo del frame es
+// una instancia de un quad. Todas las cadenas van en una sola llamada
+// glDrawArraysInstanced; cambiar un texto solo reescribe el buffer de
+// instancias (y solo si algo cambió), nunca la geometría.
+
+const int FONT_GLYPH_W = 5;
+const int FONT_GLYPH_H = 7;
+const int FONT_ATLAS_SCALE = 4;     // píxeles del atlas por píxel de la fuente
+const int TEXT_MAX_GLYPHS = 512;
+
+const char FONT_CHARS[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ:%.-/";
+
+// Filas de arriba a abajo; bit 4 = columna izquierda.
+const unsigned char FONT_ROWS[][FONT_GLYPH_H] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // ' '
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },   // '0'
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },   // '1'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },   // '2'
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },   // '3'
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },   // '4'
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },   // '5'
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },   // '6'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },   // '7'
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },   // '8'
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },   // '9'
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },   // 'A'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },   // 'B'
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },   // 'C'
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },   // 'D'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },   // 'E'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },   // 'F'
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },   // 'G'
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },   // 'H'
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },   // 'I'
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },   // 'J'
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },   // 'K'
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },   // 'L'
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },   // 'M'
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },   // 'N'
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },   // 'O'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },   // 'P'
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },   // 'Q'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },   // 'R'
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },   // 'S'
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },   // 'T'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },   // 'U'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },   // 'V'
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A },   // 'W'
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },   // 'X'
+    { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 },   // 'Y'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F },   // 'Z'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 },   // ':'
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },   // '%'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },   // '.'
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },   // '-'
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },   // '/'
+};
+
+const int FONT_GLYPH_COUNT = (int)(sizeof(FONT_ROWS) / sizeof(FONT_ROWS[0]));
+static_assert(FONT_GLYPH_COUNT == (int)sizeof(FONT_CHARS) - 1, "FONT_CHARS y FONT_ROWS no coinciden");
+
+class TextRenderer {
+public:
+    // Una instancia por glifo visible.
+    struct Glyph {
+        float rect[4];      // x, y (esquina inferior izquierda), ancho, alto en NDC
+        float color[4];
+        float glyph;        // índice en el atlas
+        float blink;        // velocidad de parpadeo (0 = fijo)
+    };
+
+    TextRenderer() {
+        staging.reserve(TEXT_MAX_GLYPHS);
+        uploaded.reserve(TEXT_MAX_GLYPHS);
+        for (int i = 0; i < 256; i++) glyphIndex[i] = -1;
+        for (int i = 0; i < FONT_GLYPH_COUNT; i++) glyphIndex[(unsigned char)FONT_CHARS[i]] = i;
+
+        bakeAtlas();
+        buildProgram();
+
+        // Sin VBO de vértices: el quad sale de gl_VertexID
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &instanceVbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, TEXT_MAX_GLYPHS * sizeof(Glyph), nullptr, GL_DYNAMIC_DRAW);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Glyph), (void*)offsetof(Glyph, rect));
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Glyph), (void*)offsetof(Glyph, color));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Glyph), (void*)offsetof(Glyph, glyph));
+        for (GLuint i = 0; i < 3; i++) {
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 1);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    ~TextRenderer() {
+        glDeleteBuffers(1, &instanceVbo);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteTextures(1, &atlas);
+        glDeleteProgram(program);
+    }
+    TextRenderer(const TextRenderer&) = delete;
+    TextRenderer& operator=(const TextRenderer&) = delete;
+
+    // 'aspect' = ancho / alto del framebuffer, para que los píxeles de la fuente sean cuadrados.
+    void begin(float aspect) {
+        staging.clear();
+        viewportAspect = aspect;
+    }
+
+    // Agrega una cadena con su esquina inferior izquierda en (x, y) y altura
+    // 'height', ambas en NDC. Minúsculas se dibujan como mayúsculas; lo que no
+    // está en la fuente deja un espacio.
+    void add(const char* text, float x, float y, float height, const glm::vec4& color, float blink = 0.0f) {
+        float pixel = height / FONT_GLYPH_H;
+        float glyphW = pixel * FONT_GLYPH_W / viewportAspect;
+        float advance = pixel * (FONT_GLYPH_W + 1) / viewportAspect;
+        for (const char* c = text; *c; c++) {
+            unsigned char ch = (unsigned char)*c;
+            if (ch >= 'a' && ch <= 'z') ch = (unsigned char)(ch - 'a' + 'A');
+            int index = glyphIndex[ch];
+            if (index > 0 && staging.size() < (size_t)TEXT_MAX_GLYPHS) {
+                Glyph g = { { x, y, glyphW, height }, { color.x, color.y, color.z, color.w }, (float)index, blink };
+                staging.push_back(g);
+            }
+            x += advance;
+        }
+    }
+
+    // Ancho en NDC de 'text' con la misma altura que add().
+    float measure(const char* text, float height) const {
+        size_t n = std::strlen(text);
+        if (n == 0) return 0.0f;
+        float pixel = height / FONT_GLYPH_H;
+        return pixel * ((FONT_GLYPH_W + 1) * n - 1) / viewportAspect;
+    }
+
+    // Dibuja todo lo agregado desde begin() en una sola llamada.
+    void draw(float time) {
+        if (staging.size() != uploaded.size() ||
+            std::memcmp(staging.data(), uploaded.data(), staging.size() * sizeof(Glyph)) != 0) {
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, staging.size() * sizeof(Glyph), staging.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            uploaded.assign(staging.begin(), staging.end());
+            uploads++;
+        }
+        if (staging.empty()) return;
+
+        glUseProgram(program);
+        glUniform1f(timeLoc, time);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glBindVertexArray(vao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)staging.size());
+        glBindVertexArray(0);
+    }
+
+    size_t glyphCount() const { return staging.size(); }
+    unsigned long long uploadCount() const { return uploads; }
+
+private:
+    GLuint vao = 0, instanceVbo = 0, atlas = 0, program = 0;
+    GLint timeLoc = -1;
+    int glyphIndex[256];
+    float viewportAspect = 1.0f;
+    std::vector<Glyph> staging, uploaded;
+    unsigned long long uploads = 0;
+
+    // Cada glifo ocupa una celda de 7x9 (1 píxel de margen para que el filtrado
+    // lineal no mezcle vecinos), escalada FONT_ATLAS_SCALE veces.
+    void bakeAtlas() {
+        const int cellW = (FONT_GLYPH_W + 2) * FONT_ATLAS_SCALE;
+        const int cellH = (FONT_GLYPH_H + 2) * FONT_ATLAS_SCALE;
+        const int width = cellW * FONT_GLYPH_COUNT;
+        std::vector<unsigned char> pixels((size_t)width * cellH, 0);
+        for (int g = 0; g < FONT_GLYPH_COUNT; g++)
+            for (int row = 0; row < FONT_GLYPH_H; row++)
+                for (int col = 0; col < FONT_GLYPH_W; col++) {
+                    if (!(FONT_ROWS[g][row] & (1 << (FONT_GLYPH_W - 1 - col)))) continue;
+                    for (int sy = 0; sy < FONT_ATLAS_SCALE; sy++)
+                        for (int sx = 0; sx < FONT_ATLAS_SCALE; sx++) {
+                            int px = g * cellW + (col + 1) * FONT_ATLAS_SCALE + sx;
+                            int py = (row + 1) * FONT_ATLAS_SCALE + sy;     // fila 0 = arriba del glifo
+                            pixels[(size_t)py * width + px] = 255;
+                        }
+                }
+
+        glGenTextures(1, &atlas);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, cellH, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    static GLuint compile(GLenum type, const char* source) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        GLint ok = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+            std::cout << "ERROR::SHADER_COMPILATION_ERROR (texto)\n" << log << std::endl;
+        }
+        return shader;
+    }
+
+    void buildProgram() {
+        const char* vs = R"(
+            #version 330 core
+            layout (location = 0) in vec4 aRect;
+            layout (location = 1) in vec4 aColor;
+            layout (location = 2) in vec2 aGlyph;     // x = índice, y = parpadeo
+            uniform int glyphCount;
+            uniform float time;
+            out vec2 TexCoords;
+            out vec4 Color;
+            void main() {
+                vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+                gl_Position = vec4(aRect.xy + corner * aRect.zw, 0.0, 1.0);
+                // Celda de 7x9 con el glifo en el centro; la fila 0 de la textura es la de arriba
+                float u = (aGlyph.x * 7.0 + 1.0 + corner.x * 5.0) / (float(glyphCount) * 7.0);
+                float v = (8.0 - corner.y * 7.0) / 9.0;
+                TexCoords = vec2(u, v);
+                Color = aColor;
+                if (aGlyph.y > 0.0) Color.a *= sin(time * aGlyph.y) * 0.3 + 0.7;
+            }
+        )";
+        const char* fs = R"(
+            #version 330 core
+            in vec2 TexCoords;
+            in vec4 Color;
+            out vec4 FragColor;
+            uniform sampler2D atlas;
+            void main() {
+                float coverage = texture(atlas, TexCoords).r;
+                if (coverage < 0.01) discard;
+                FragColor = vec4(Color.rgb, Color.a * coverage);
+            }
+        )";
+        GLuint v = compile(GL_VERTEX_SHADER, vs);
+        GLuint f = compile(GL_FRAGMENT_SHADER, fs);
+        program = glCreateProgram();
+        glAttachShader(program, v);
+        glAttachShader(program, f);
+        glLinkProgram(program);
+        glDeleteShader(v);
+        glDeleteShader(f);
+
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "atlas"), 0);
+        glUniform1i(glGetUniformLocation(program, "glyphCount"), FONT_GLYPH_COUNT);
+        timeLoc = glGetUniformLocation(program, "time");
+        glUseProgram(0);
+    }
+};
+
+#endif
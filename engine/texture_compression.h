@@ -0,0 +1,435 @@
+#ifndef TEXTURE_COMPRESSION_H
+#define TEXTURE_COMPRESSION_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+// Texturas comprimidas por bloques, horneadas offline (tools/compress_textures).
+// Cada imagen se guarda junto a la original como <imagen>.ktx (KTX 1.1) con
+// toda su cadena de mipmaps ya calculada: BC1 si es opaca, BC3 si tiene alfa
+// y BC5 (solo R y G) para los mapas de normales; quien muestree un BC5 tiene
+// que reconstruir z = sqrt(1 - x² - y²). El codificador es de CPU y no
+// necesita contexto GL. En ejecución el TextureStreamer sube los niveles con
+// glCompressedTexImage2D y, si el .ktx falta o está desactualizado, usa la imagen.
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+enum class BlockFormat { BC1, BC3, BC5 };
+
+struct CompressedLevel {
+    int width = 0, height = 0;
+    size_t offset = 0, size = 0;        // dentro de CompressedTexture::data
+};
+
+struct CompressedTexture {
+    GLenum internalFormat = 0;
+    int width = 0, height = 0;
+    std::vector<CompressedLevel> levels;
+    std::vector<unsigned char> data;
+
+    size_t bytes() const { return data.size(); }
+};
+
+inline std::string compressedTexturePath(const std::string& imagePath) {
+    return imagePath + ".ktx";
+}
+
+inline GLenum blockInternalFormat(BlockFormat format) {
+    switch (format) {
+    case BlockFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BlockFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    default: return GL_COMPRESSED_RG_RGTC2;
+    }
+}
+
+inline size_t blockBytes(BlockFormat format) { return format == BlockFormat::BC1 ? 8 : 16; }
+
+inline size_t compressedLevelSize(BlockFormat format, int width, int height) {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+// Normales por el nombre (Dress_normal.png), alfa si algún texel no es opaco.
+inline BlockFormat chooseBlockFormat(const std::string& path, const unsigned char* rgba, int width, int height) {
+    std::string lower = path;
+    for (char& c : lower) c = (char)std::tolower((unsigned char)c);
+    size_t slash = lower.find_last_of("/\\");
+    if (lower.find("normal", slash == std::string::npos ? 0 : slash) != std::string::npos) return BlockFormat::BC5;
+    for (size_t i = 0; i < (size_t)width * height; i++)
+        if (rgba[i * 4 + 3] != 255) return BlockFormat::BC3;
+    return BlockFormat::BC1;
+}
+
+namespace bc_detail {
+
+inline int to565(const float c[3]) {
+    int r = std::min(std::max((int)std::lround(c[0] * 31.0f / 255.0f), 0), 31);
+    int g = std::min(std::max((int)std::lround(c[1] * 63.0f / 255.0f), 0), 63);
+    int b = std::min(std::max((int)std::lround(c[2] * 31.0f / 255.0f), 0), 31);
+    return (r << 11) | (g << 5) | b;
+}
+
+inline void from565(int c, float out[3]) {
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    out[0] = (float)((r << 3) | (r >> 2));
+    out[1] = (float)((g << 2) | (g >> 4));
+    out[2] = (float)((b << 3) | (b >> 2));
+}
+
+// Índices de los 16 texeles para los extremos dados; devuelve el error cuadrático.
+inline float fitColorIndices(const float texels[16][3], int c0, int c1, int indices[16]) {
+    float palette[4][3];
+    from565(c0, palette[0]);
+    from565(c1, palette[1]);
+    for (int k = 0; k < 3; k++) {
+        palette[2][k] = (2.0f * palette[0][k] + palette[1][k]) / 3.0f;
+        palette[3][k] = (palette[0][k] + 2.0f * palette[1][k]) / 3.0f;
+    }
+    float error = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float best = 1e30f;
+        for (int p = 0; p < 4; p++) {
+            float d = 0.0f;
+            for (int k = 0; k < 3; k++) d += (texels[i][k] - palette[p][k]) * (texels[i][k] - palette[p][k]);
+            if (d < best) { best = d; indices[i] = p; }
+        }
+        error += best;
+    }
+    return error;
+}
+
+// Bloque de color de BC1/BC3 (modo de 4 colores, c0 > c1): extremos sobre el
+// eje principal de los texeles y después un ajuste por mínimos cuadrados.
+inline void encodeColorBlock(const unsigned char rgba[64], unsigned char out[8]) {
+    float texels[16][3];
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; i++)
+        for (int k = 0; k < 3; k++) {
+            texels[i][k] = rgba[i * 4 + k];
+            mean[k] += texels[i][k] / 16.0f;
+        }
+    float cov[6] = {};
+    for (int i = 0; i < 16; i++) {
+        float d[3] = { texels[i][0] - mean[0], texels[i][1] - mean[1], texels[i][2] - mean[2] };
+        cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+    }
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int iter = 0; iter < 8; iter++) {
+        float next[3] = { cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                          cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                          cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2] };
+        float len = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (len < 1e-6f) break;
+        for (int k = 0; k < 3; k++) axis[k] = next[k] / len;
+    }
+
+    float lo = 1e30f, hi = -1e30f;
+    for (int i = 0; i < 16; i++) {
+        float t = (texels[i][0] - mean[0]) * axis[0] + (texels[i][1] - mean[1]) * axis[1] + (texels[i][2] - mean[2]) * axis[2];
+        lo = std::min(lo, t);
+        hi = std::max(hi, t);
+    }
+    float end0[3], end1[3];
+    for (int k = 0; k < 3; k++) {
+        end0[k] = mean[k] + axis[k] * hi;
+        end1[k] = mean[k] + axis[k] * lo;
+    }
+
+    int c0 = to565(end0), c1 = to565(end1);
+    int indices[16], trial[16];
+    float error = fitColorIndices(texels, c0, c1, indices);
+
+    // Mínimos cuadrados: cada texel es w*e0 + (1-w)*e1 con w según su índice
+    for (int iter = 0; iter < 2 && error > 0.0f; iter++) {
+        static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        float aa = 0.0f, bb = 0.0f, ab = 0.0f, ax[3] = {}, bx[3] = {};
+        for (int i = 0; i < 16; i++) {
+            float a = weights[indices[i]], b = 1.0f - a;
+            aa += a * a; bb += b * b; ab += a * b;
+            for (int k = 0; k < 3; k++) { ax[k] += a * texels[i][k]; bx[k] += b * texels[i][k]; }
+        }
+        float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f) break;
+        for (int k = 0; k < 3; k++) {
+            end0[k] = (ax[k] * bb - bx[k] * ab) / det;
+            end1[k] = (bx[k] * aa - ax[k] * ab) / det;
+        }
+        int n0 = to565(end0), n1 = to565(end1);
+        float e = fitColorIndices(texels, n0, n1, trial);
+        if (e >= error) break;
+        error = e;
+        c0 = n0; c1 = n1;
+        std::memcpy(indices, trial, sizeof(indices));
+    }
+
+    // c0 > c1 selecciona el modo de 4 colores; al invertirlos se intercambian los índices
+    if (c0 < c1) {
+        std::swap(c0, c1);
+        static const int swapped[4] = { 1, 0, 3, 2 };
+        for (int& index : indices) index = swapped[index];
+    }
+    else if (c0 == c1) {
+        for (int& index : indices) index = 0;
+    }
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++) bits |= (uint32_t)indices[i] << (i * 2);
+    out[0] = (unsigned char)(c0 & 0xFF); out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)(c1 & 0xFF); out[3] = (unsigned char)(c1 >> 8);
+    for (int k = 0; k < 4; k++) out[4 + k] = (unsigned char)(bits >> (k * 8));
+}
+
+// Bloque de un canal (alfa de BC3, R y G de BC5) en el modo de 8 valores.
+inline void encodeChannelBlock(const unsigned char values[16], unsigned char out[8]) {
+    int hi = 0, lo = 255;
+    for (int i = 0; i < 16; i++) {
+        hi = std::max(hi, (int)values[i]);
+        lo = std::min(lo, (int)values[i]);
+    }
+    uint64_t bits = 0;
+    if (hi > lo) {
+        int palette[8] = { hi, lo };
+        for (int p = 1; p <= 6; p++) palette[p + 1] = ((7 - p) * hi + p * lo + 3) / 7;
+        for (int i = 0; i < 16; i++) {
+            int best = 0, bestError = 1 << 30;
+            for (int p = 0; p < 8; p++) {
+                int e = std::abs(palette[p] - (int)values[i]);
+                if (e < bestError) { bestError = e; best = p; }
+            }
+            bits |= (uint64_t)best << (i * 3);
+        }
+    }
+    out[0] = (unsigned char)hi;
+    out[1] = (unsigned char)lo;
+    for (int k = 0; k < 6; k++) out[2 + k] = (unsigned char)(bits >> (k * 8));
+}
+
+// Bloque de 4x4 en (bx, by); los bordes se repiten si la imagen no es múltiplo de 4.
+inline void gatherBlock(const unsigned char* rgba, int width, int height, int bx, int by, unsigned char block[64]) {
+    for (int y = 0; y < 4; y++)
+        for (int x = 0; x < 4; x++) {
+            int sx = std::min(bx * 4 + x, width - 1), sy = std::min(by * 4 + y, height - 1);
+            std::memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+        }
+}
+
+inline void encodeLevel(const unsigned char* rgba, int width, int height, BlockFormat format, unsigned char* out) {
+    const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    unsigned char block[64], channel[16];
+    for (int by = 0; by < blocksY; by++)
+        for (int bx = 0; bx < blocksX; bx++) {
+            gatherBlock(rgba, width, height, bx, by, block);
+            if (format == BlockFormat::BC1) {
+                encodeColorBlock(block, out);
+            }
+            else if (format == BlockFormat::BC3) {
+                for (int i = 0; i < 16; i++) channel[i] = block[i * 4 + 3];
+                encodeChannelBlock(channel, out);
+                encodeColorBlock(block, out + 8);
+            }
+            else {
+                for (int c = 0; c < 2; c++) {
+                    for (int i = 0; i < 16; i++) channel[i] = block[i * 4 + c];
+                    encodeChannelBlock(channel, out + c * 8);
+                }
+            }
+            out += blockBytes(format);
+        }
+}
+
+// Siguiente nivel de mipmap (promedio de 2x2). Para normales se promedian los
+// vectores y se vuelven a normalizar en vez de promediar colores.
+inline void downsample(const std::vector<unsigned char>& src, int width, int height, bool normals,
+                       std::vector<unsigned char>& dst, int& outWidth, int& outHeight) {
+    outWidth = std::max(1, width / 2);
+    outHeight = std::max(1, height / 2);
+    dst.assign((size_t)outWidth * outHeight * 4, 0);
+    for (int y = 0; y < outHeight; y++)
+        for (int x = 0; x < outWidth; x++) {
+            float sum[4] = {};
+            for (int dy = 0; dy < 2; dy++)
+                for (int dx = 0; dx < 2; dx++) {
+                    int sx = std::min(x * 2 + dx, width - 1), sy = std::min(y * 2 + dy, height - 1);
+                    const unsigned char* p = &src[((size_t)sy * width + sx) * 4];
+                    for (int k = 0; k < 4; k++) sum[k] += normals && k < 3 ? p[k] / 127.5f - 1.0f : (float)p[k];
+                }
+            unsigned char* q = &dst[((size_t)y * outWidth + x) * 4];
+            if (normals) {
+                float len = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                for (int k = 0; k < 3; k++) {
+                    float n = len > 1e-6f ? sum[k] / len : (k == 2 ? 1.0f : 0.0f);
+                    q[k] = (unsigned char)std::lround((n + 1.0f) * 127.5f);
+                }
+            }
+            else {
+                for (int k = 0; k < 3; k++) q[k] = (unsigned char)std::lround(sum[k] / 4.0f);
+            }
+            q[3] = (unsigned char)std::lround(sum[3] / 4.0f);
+        }
+}
+
+inline bool statSourceImage(const std::string& path, uint64_t& size, int64_t& mtime) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    size = (uint64_t)st.st_size;
+    mtime = (int64_t)st.st_mtime;
+    return true;
+}
+
+const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+const char KTX_SOURCE_KEY[] = "DRN.source";     // tamaño y fecha de la imagen original
+
+}
+
+// Comprime 'rgba' (RGBA8) con toda su cadena de mipmaps hasta 1x1.
+inline void compressTexture(const unsigned char* rgba, int width, int height, BlockFormat format, CompressedTexture& out) {
+    out = CompressedTexture();
+    out.internalFormat = blockInternalFormat(format);
+    out.width = width;
+    out.height = height;
+
+    std::vector<unsigned char> level(rgba, rgba + (size_t)width * height * 4), next;
+    int w = width, h = height;
+    for (;;) {
+        CompressedLevel info;
+        info.width = w;
+        info.height = h;
+        info.offset = out.data.size();
+        info.size = compressedLevelSize(format, w, h);
+        out.data.resize(info.offset + info.size);
+        bc_detail::encodeLevel(level.data(), w, h, format, out.data.data() + info.offset);
+        out.levels.push_back(info);
+        if (w == 1 && h == 1) break;
+        int nw, nh;
+        bc_detail::downsample(level, w, h, format == BlockFormat::BC5, next, nw, nh);
+        level.swap(next);
+        w = nw;
+        h = nh;
+    }
+}
+
+// --- CONTENEDOR KTX 1.1 ---
+// Cabecera estándar, un par clave/valor con el sello de la imagen original y
+// los niveles, cada uno precedido por su tamaño.
+inline bool writeKtx(const std::string& path, const CompressedTexture& texture, const std::string& sourcePath) {
+    using namespace bc_detail;
+    uint64_t sourceSize = 0;
+    int64_t sourceMTime = 0;
+    if (!statSourceImage(sourcePath, sourceSize, sourceMTime)) return false;
+
+    GLenum baseFormat = texture.internalFormat == GL_COMPRESSED_RG_RGTC2 ? GL_RG
+                      : texture.internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? GL_RGB : GL_RGBA;
+    const uint32_t keyValueSize = (uint32_t)sizeof(KTX_SOURCE_KEY) + 16;
+    const uint32_t keyValuePadded = (keyValueSize + 3) & ~3u;
+    uint32_t header[13] = { 0x04030201, 0, 1, 0, texture.internalFormat, baseFormat,
+                            (uint32_t)texture.width, (uint32_t)texture.height, 0, 0, 1,
+                            (uint32_t)texture.levels.size(), 4 + keyValuePadded };
+
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write((const char*)KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+        out.write((const char*)header, sizeof(header));
+        out.write((const char*)&keyValueSize, 4);
+        out.write(KTX_SOURCE_KEY, sizeof(KTX_SOURCE_KEY));
+        out.write((const char*)&sourceSize, 8);
+        out.write((const char*)&sourceMTime, 8);
+        const char zeros[4] = {};
+        out.write(zeros, keyValuePadded - keyValueSize);
+        for (const CompressedLevel& level : texture.levels) {
+            uint32_t size = (uint32_t)level.size;
+            out.write((const char*)&size, 4);
+            out.write((const char*)texture.data.data() + level.offset, (std::streamsize)level.size);
+        }
+        if (!out) return false;
+    }
+    std::remove(path.c_str());
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+// Lee un .ktx escrito por writeKtx. Falla (y hay que usar la imagen) si no
+// existe, está corrupto o la imagen original cambió después de hornearlo.
+inline bool readKtx(const std::string& path, const std::string& sourcePath, CompressedTexture& out) {
+    using namespace bc_detail;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    unsigned char identifier[12];
+    uint32_t header[13];
+    if (!in.read((char*)identifier, 12) || std::memcmp(identifier, KTX_IDENTIFIER, 12) != 0) return false;
+    if (!in.read((char*)header, sizeof(header)) || header[0] != 0x04030201) return false;
+
+    const GLenum format = header[4];
+    BlockFormat block;
+    if (format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) block = BlockFormat::BC1;
+    else if (format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT) block = BlockFormat::BC3;
+    else if (format == GL_COMPRESSED_RG_RGTC2) block = BlockFormat::BC5;
+    else return false;
+    const int width = (int)header[6], height = (int)header[7];
+    const uint32_t levels = header[11], keyValueBytes = header[12];
+    if (width <= 0 || height <= 0 || width > 16384 || height > 16384 || header[8] > 1 || header[9] != 0 ||
+        header[10] != 1 || levels == 0 || levels > 15 || keyValueBytes > 4096)
+        return false;
+
+    // Sello de la imagen original (si todavía existe)
+    std::vector<char> keyValues(keyValueBytes);
+    if (keyValueBytes > 0 && !in.read(keyValues.data(), keyValueBytes)) return false;
+    uint64_t sourceSize = 0;
+    int64_t sourceMTime = 0;
+    if (statSourceImage(sourcePath, sourceSize, sourceMTime)) {
+        bool fresh = false;
+        size_t pos = 0;
+        while (pos + 4 <= keyValues.size()) {
+            uint32_t size;
+            std::memcpy(&size, &keyValues[pos], 4);
+            if (size > keyValues.size() - pos - 4) break;
+            const char* pair = &keyValues[pos + 4];
+            if (size == sizeof(KTX_SOURCE_KEY) + 16 && std::memcmp(pair, KTX_SOURCE_KEY, sizeof(KTX_SOURCE_KEY)) == 0) {
+                uint64_t size0;
+                int64_t mtime0;
+                std::memcpy(&size0, pair + sizeof(KTX_SOURCE_KEY), 8);
+                std::memcpy(&mtime0, pair + sizeof(KTX_SOURCE_KEY) + 8, 8);
+                fresh = size0 == sourceSize && mtime0 == sourceMTime;
+            }
+            pos += 4 + ((size + 3) & ~3u);
+        }
+        if (!fresh) return false;
+    }
+
+    out = CompressedTexture();
+    out.internalFormat = format;
+    out.width = width;
+    out.height = height;
+    int w = width, h = height;
+    for (uint32_t l = 0; l < levels; l++) {
+        uint32_t size = 0;
+        if (!in.read((char*)&size, 4) || size != compressedLevelSize(block, w, h)) return false;
+        CompressedLevel level;
+        level.width = w;
+        level.height = h;
+        level.offset = out.data.size();
+        level.size = size;
+        out.data.resize(level.offset + size);
+        if (!in.read((char*)out.data.data() + level.offset, size)) return false;
+        out.levels.push_back(level);
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+    return true;
+}
+
+#endif
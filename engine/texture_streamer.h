@@ -0,0 +1,464 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <glad/glad.h>
+#include <learnopengl/stb_image.h>
+
+#include "texture_compression.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Streaming de texturas: los PNG/JPEG se decodifican en hilos de trabajo y
+// pasan al hilo de GL por una cola acotada. Mientras tanto la textura pedida
+// ya existe con un texel gris de 1x1, así que puede enlazarse desde el primer
+// frame; al llegar los píxeles se reemplaza su contenido con el mismo nombre.
+// Si junto a la imagen hay un <imagen>.ktx vigente (tools/compress_textures)
+// se sube ese, ya comprimido y con sus mipmaps, en lugar de decodificar.
+// Los hilos de decodificación calculan además el hash de lo que se va a
+// subir; si una textura pedida como 'mergeable' resulta igual a otra ya
+// subida, no se sube de nuevo y el par queda para takeMerges() (GpuResources).
+
+const size_t TEXTURE_READY_CAPACITY = 8;                 // imágenes decodificadas en espera
+const size_t TEXTURE_UPLOAD_BUDGET = 8u * 1024u * 1024u; // bytes subidos por frame
+
+// --- HASH DE CONTENIDO ---
+// 64 bits, de 8 en 8 bytes; no es criptográfico, solo para detectar duplicados.
+inline uint64_t hashMix(uint64_t h) {
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0x9E3779B97F4A7C15ull) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t h = seed ^ ((uint64_t)size * 0x87c37b91114253d5ull);
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w;
+        std::memcpy(&w, p + i * 8, 8);
+        h = (h ^ hashMix(w)) * 0x100000001B3ull;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, p + words * 8, size - words * 8);
+    return hashMix(h ^ tail);
+}
+
+inline unsigned int defaultDecodeThreads() {
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw > 1 ? hw - 1 : 1;
+}
+
+// --- COLA ACOTADA ---
+// push() bloquea mientras está llena; así los hilos de decodificación nunca
+// acumulan más de 'capacity' imágenes en memoria.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [&] { return closed || items.size() < capacity; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool tryPop(T& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty()) return false;
+        out = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        out = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    // Vacía lo que quede (solo tras close()).
+    std::deque<T> drain() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::deque<T> rest;
+        rest.swap(items);
+        return rest;
+    }
+
+private:
+    size_t capacity;
+    bool closed = false;
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable notFull, notEmpty;
+};
+
+// --- DECODIFICACIÓN (sin GL) ---
+struct ImageJob {
+    unsigned int texture = 0;      // nombre GL destino (0 en el benchmark)
+    uint64_t ticket = 0;           // distingue pedidos si GL reutiliza el nombre
+    std::string path;
+    bool flipVertically = false;
+    GLint wrap = GL_REPEAT;
+    bool allowCompressed = false;  // buscar antes el .ktx (no se usa si hay que voltear)
+    bool allowS3tc = false;        // BC1/BC3 necesitan GL_EXT_texture_compression_s3tc; BC5 es núcleo
+    bool mergeable = false;        // puede quedarse sin subir si otra textura tiene el mismo contenido
+};
+
+struct DecodedImage {
+    ImageJob job;
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0, channels = 0;
+    CompressedTexture compressed;   // con niveles si se cargó el .ktx (y entonces pixels es nulo)
+    uint64_t contentHash = 0;       // de lo que se sube (el .ktx si se usó); 0 si no se pudo leer
+
+    bool isCompressed() const { return !compressed.levels.empty(); }
+    size_t bytes() const { return isCompressed() ? compressed.bytes() : (size_t)width * height * channels; }
+};
+
+// stbi_set_flip_vertically_on_load es global y no es seguro entre hilos,
+// así que el volteo se hace aquí fila por fila.
+inline void flipRows(unsigned char* pixels, int width, int height, int channels) {
+    size_t stride = (size_t)width * channels;
+    std::vector<unsigned char> row(stride);
+    for (int y = 0; y < height / 2; y++) {
+        unsigned char* top = pixels + y * stride;
+        unsigned char* bottom = pixels + (height - 1 - y) * stride;
+        std::memcpy(row.data(), top, stride);
+        std::memcpy(top, bottom, stride);
+        std::memcpy(bottom, row.data(), stride);
+    }
+}
+
+// Formato y tamaño van en la semilla: los mismos bytes con otra forma son otra textura.
+inline uint64_t imageContentHash(const DecodedImage& image) {
+    uint64_t shape = ((uint64_t)image.width << 40) ^ ((uint64_t)image.height << 16) ^ (uint64_t)image.channels;
+    if (image.isCompressed())
+        return hashBytes(image.compressed.data.data(), image.compressed.bytes(),
+                         hashMix(shape ^ ((uint64_t)image.compressed.internalFormat << 32)));
+    return image.pixels ? hashBytes(image.pixels, image.bytes(), hashMix(shape)) : 0;
+}
+
+inline DecodedImage decodeImage(const ImageJob& job) {
+    DecodedImage image;
+    image.job = job;
+    if (job.allowCompressed && !job.flipVertically &&
+        readKtx(compressedTexturePath(job.path), job.path, image.compressed)) {
+        if (job.allowS3tc || image.compressed.internalFormat == GL_COMPRESSED_RG_RGTC2) {
+            image.width = image.compressed.width;
+            image.height = image.compressed.height;
+            if (job.mergeable) image.contentHash = imageContentHash(image);
+            return image;
+        }
+        image.compressed = CompressedTexture();
+    }
+    image.pixels = stbi_load(job.path.c_str(), &image.width, &image.height, &image.channels, 0);
+    if (image.pixels && job.flipVertically)
+        flipRows(image.pixels, image.width, image.height, image.channels);
+    if (job.mergeable) image.contentHash = imageContentHash(image);
+    return image;
+}
+
+class ImageDecodeQueue {
+public:
+    ImageDecodeQueue(unsigned int threads, size_t readyCapacity) : ready(readyCapacity) {
+        for (unsigned int i = 0; i < std::max(1u, threads); i++)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ImageDecodeQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobAvailable.notify_all();
+        ready.close();
+        for (auto& t : workers) t.join();
+        for (auto& image : ready.drain()) stbi_image_free(image.pixels);
+    }
+
+    ImageDecodeQueue(const ImageDecodeQueue&) = delete;
+    ImageDecodeQueue& operator=(const ImageDecodeQueue&) = delete;
+
+    void enqueue(ImageJob job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        inFlight++;
+        jobAvailable.notify_one();
+    }
+
+    bool tryPopReady(DecodedImage& out) {
+        if (!ready.tryPop(out)) return false;
+        inFlight--;
+        return true;
+    }
+
+    bool popReady(DecodedImage& out) {
+        if (inFlight.load() == 0 || !ready.pop(out)) return false;
+        inFlight--;
+        return true;
+    }
+
+    // Trabajos encolados que aún no se han retirado con popReady/tryPopReady.
+    size_t pending() const { return inFlight.load(); }
+    size_t threadCount() const { return workers.size(); }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<ImageJob> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    bool stopping = false;
+    std::atomic<size_t> inFlight{ 0 };
+    BoundedQueue<DecodedImage> ready;
+
+    void workerLoop() {
+        for (;;) {
+            ImageJob job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobAvailable.wait(lock, [&] { return stopping || !jobs.empty(); });
+                if (stopping) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            DecodedImage image = decodeImage(job);
+            unsigned char* pixels = image.pixels;
+            if (!ready.push(std::move(image))) {
+                stbi_image_free(pixels);
+                return;
+            }
+        }
+    }
+};
+
+// --- STREAMER (hilo de GL) ---
+class TextureStreamer {
+public:
+    explicit TextureStreamer(unsigned int threads = defaultDecodeThreads())
+        : decoder(threads, TEXTURE_READY_CAPACITY) {
+        glGenBuffers(2, pbos);
+        GLint extensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+        for (GLint i = 0; i < extensions; i++) {
+            const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) s3tc = true;
+        }
+    }
+
+    ~TextureStreamer() {
+        glDeleteBuffers(2, pbos);
+    }
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // Devuelve un nombre de textura válido de inmediato (placeholder 1x1). Con
+    // 'mergeable' el llamador acepta cambiar ese nombre por el de otra textura
+    // de igual contenido (ver takeMerges); mientras tanto sigue siendo válido.
+    unsigned int request(const std::string& path, bool flipVertically = false, GLint wrap = GL_REPEAT,
+                         bool mergeable = false) {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        ImageJob job;
+        job.texture = texture;
+        job.ticket = ++nextTicket;
+        job.path = path;
+        job.flipVertically = flipVertically;
+        job.wrap = wrap;
+        job.allowCompressed = useCompressed;
+        job.allowS3tc = s3tc;
+        job.mergeable = mergeable;
+        tickets[texture] = job.ticket;
+        decoder.enqueue(std::move(job));
+        return texture;
+    }
+
+    // Borra la textura; si todavía se está decodificando, su subida se descarta.
+    void release(unsigned int texture) {
+        tickets.erase(texture);
+        sizes.erase(texture);
+        auto key = contentKeys.find(texture);
+        if (key != contentKeys.end()) {
+            byContent.erase(key->second);
+            contentKeys.erase(key);
+        }
+        glDeleteTextures(1, &texture);
+    }
+
+    // Pares (duplicado, original) desde la última llamada: el duplicado se
+    // quedó con el placeholder porque 'original' ya tiene los mismos píxeles.
+    std::vector<std::pair<unsigned int, unsigned int>> takeMerges() {
+        std::vector<std::pair<unsigned int, unsigned int>> out;
+        out.swap(merges);
+        return out;
+    }
+
+    // Sube lo que ya esté decodificado, hasta 'byteBudget' por llamada (mínimo una imagen).
+    // Nunca espera a los hilos de decodificación.
+    void pump(size_t byteBudget = TEXTURE_UPLOAD_BUDGET) {
+        size_t uploaded = 0;
+        DecodedImage image;
+        while (uploaded < byteBudget && decoder.tryPopReady(image)) {
+            uploaded += image.bytes();
+            upload(image);
+        }
+    }
+
+    // Bloquea hasta que todas las texturas pedidas estén subidas.
+    void finish() {
+        DecodedImage image;
+        while (decoder.popReady(image)) upload(image);
+    }
+
+    size_t pending() const { return decoder.pending(); }
+
+    // Con false se ignoran los .ktx y siempre se decodifica la imagen (comparar calidad/memoria).
+    void setUseCompressed(bool on) { useCompressed = on; }
+
+    // true si la textura ya tiene sus píxeles definitivos (o falló y se queda
+    // con el placeholder); false mientras se decodifica.
+    bool resident(unsigned int texture) const { return tickets.find(texture) == tickets.end(); }
+
+    // Cuenta de subidas terminadas; sirve para saber si algo cambió desde la última vez.
+    uint64_t completedUploads() const { return completed; }
+
+    // Memoria de la textura ya subida (nivel 0 más mipmaps); 0 si todavía no llegó.
+    size_t residentBytes(unsigned int texture) const {
+        auto it = sizes.find(texture);
+        return it == sizes.end() ? 0 : it->second;
+    }
+
+private:
+    ImageDecodeQueue decoder;
+    unsigned int pbos[2];
+    int nextPbo = 0;
+    uint64_t nextTicket = 0;
+    uint64_t completed = 0;
+    bool s3tc = false;
+    bool useCompressed = true;
+    std::unordered_map<unsigned int, uint64_t> tickets;   // texturas a la espera de píxeles
+    std::unordered_map<unsigned int, size_t> sizes;       // bytes de las ya subidas
+    std::unordered_map<uint64_t, unsigned int> byContent; // contenido + wrap -> textura fusionable ya subida
+    std::unordered_map<unsigned int, uint64_t> contentKeys;
+    std::vector<std::pair<unsigned int, unsigned int>> merges;
+
+    void upload(DecodedImage& image) {
+        unsigned int texture = image.job.texture;
+        auto it = tickets.find(texture);
+        if (it == tickets.end() || it->second != image.job.ticket) {
+            stbi_image_free(image.pixels);
+            return;
+        }
+        tickets.erase(it);
+        completed++;
+        if (image.job.mergeable && image.contentHash != 0) {
+            const uint64_t key = hashMix(image.contentHash ^ (uint64_t)image.job.wrap);
+            auto same = byContent.find(key);
+            if (same != byContent.end()) {
+                merges.push_back({ texture, same->second });
+                stbi_image_free(image.pixels);
+                image.pixels = nullptr;
+                return;
+            }
+            byContent[key] = texture;
+            contentKeys[texture] = key;
+        }
+        if (image.isCompressed()) {
+            uploadCompressed(texture, image.compressed);
+            return;
+        }
+        if (!image.pixels) {
+            std::cout << "Texture failed to load at path: " << image.job.path << std::endl;
+            return;
+        }
+
+        GLenum format = GL_RGBA;
+        if (image.channels == 1) format = GL_RED;
+        else if (image.channels == 3) format = GL_RGB;
+
+        size_t size = image.bytes();
+        const unsigned char* src = stage(image.pixels, size);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, src);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        sizes[texture] = size * 4 / 3;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        stbi_image_free(image.pixels);
+        image.pixels = nullptr;
+    }
+
+    // Todos los niveles vienen en el .ktx: se suben tal cual, sin glGenerateMipmap.
+    void uploadCompressed(unsigned int texture, const CompressedTexture& compressed) {
+        const unsigned char* src = stage(compressed.data.data(), compressed.bytes());
+        glBindTexture(GL_TEXTURE_2D, texture);
+        for (size_t l = 0; l < compressed.levels.size(); l++) {
+            const CompressedLevel& level = compressed.levels[l];
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)l, compressed.internalFormat, level.width, level.height, 0,
+                                   (GLsizei)level.size, (const void*)((uintptr_t)src + level.offset));
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)compressed.levels.size() - 1);
+        sizes[texture] = compressed.bytes();
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // Copia al PBO (orfanado) y la subida se hace desde el buffer, de modo
+    // que el driver puede transferir sin bloquear al hilo de render. Devuelve
+    // el puntero que hay que pasar a glTex*Image: un desplazamiento dentro del
+    // PBO o, si no se pudo mapear, los datos en memoria con el PBO desenlazado.
+    const unsigned char* stage(const unsigned char* data, size_t size) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+        nextPbo = (nextPbo + 1) % 2;
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (!dst) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return data;
+        }
+        std::memcpy(dst, data, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        return nullptr;
+    }
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de hilos de trabajo compartido por las etapas de CPU (asignación de
+// luces, análisis de mallas, ...). parallelFor reparte un rango en bloques y
+// el hilo que llama también trabaja, así que nunca se queda esperando ocioso.
+
+inline unsigned int defaultWorkerThreads() {
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw > 1 ? hw - 1 : 1;
+}
+
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int threads = defaultWorkerThreads()) {
+        for (unsigned int i = 0; i < threads; i++)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        available.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Tarea suelta (sin esperar el resultado).
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        available.notify_one();
+    }
+
+    // Ejecuta fn(begin, end) sobre bloques de [0, count) y espera a que terminen.
+    // 'minChunk' evita repartir trabajos tan pequeños que no compensan.
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)>& fn, size_t minChunk = 1) {
+        if (count == 0) return;
+        size_t maxChunks = std::max<size_t>(1, count / std::max<size_t>(1, minChunk));
+        size_t chunks = std::min(maxChunks, workers.size() + 1);
+        if (chunks <= 1) {
+            fn(0, count);
+            return;
+        }
+
+        std::mutex doneMutex;
+        std::condition_variable done;
+        size_t remaining = chunks - 1;
+        auto range = [&](size_t c) {
+            return std::make_pair(count * c / chunks, count * (c + 1) / chunks);
+        };
+
+        for (size_t c = 1; c < chunks; c++) {
+            submit([&, c] {
+                auto r = range(c);
+                fn(r.first, r.second);
+                std::lock_guard<std::mutex> lock(doneMutex);
+                if (--remaining == 0) done.notify_one();
+            });
+        }
+
+        auto r = range(0);
+        fn(r.first, r.second);
+
+        // Mientras faltan bloques, se ayuda con lo que haya en la cola.
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                if (remaining == 0) return;
+            }
+            if (!runPending()) break;
+        }
+        std::unique_lock<std::mutex> lock(doneMutex);
+        done.wait(lock, [&] { return remaining == 0; });
+    }
+
+    size_t size() const { return workers.size(); }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping = false;
+
+    bool runPending() {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty()) return false;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+        return true;
+    }
+
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                available.wait(lock, [&] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Triple buffer sin bloqueos para un escritor y un lector en hilos distintos.
+// El escritor llena back() y llama publish(); el lector llama update() y lee
+// front(). Ninguno espera al otro y el lector siempre ve el último valor
+// publicado completo.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T& initial) {
+        buffers[0] = buffers[1] = buffers[2] = initial;
+    }
+
+    // --- Escritor ---
+    T& back() { return buffers[backIndex]; }
+
+    void publish() {
+        int previous = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel);
+        backIndex = previous & INDEX_MASK;
+    }
+
+    // --- Lector ---
+    // Devuelve true si había un valor nuevo desde la última llamada.
+    bool update() {
+        if ((middle.load(std::memory_order_acquire) & FRESH) == 0) return false;
+        int previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& front() const { return buffers[frontIndex]; }
+
+private:
+    static const int FRESH = 4;
+    static const int INDEX_MASK = 3;
+
+    T buffers[3];
+    std::atomic<int> middle{ 1 };
+    alignas(64) int backIndex = 0;     // solo lo toca el escritor
+    alignas(64) int frontIndex = 2;    // solo lo toca el lector
+};
+
+#endif
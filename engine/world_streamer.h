@@ -0,0 +1,382 @@
+#ifndef WORLD_STREAMER_H
+#define WORLD_STREAMER_H
+
+#include <glm/glm.hpp>
+
+#include "asset_cache.h"
+#include "collision_bvh.h"
+#include "scene_culling.h"
+#include "scene_manifest.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Streaming del mundo por zonas: los modelos del manifiesto marcados "stream"
+// se reparten en celdas de una grilla XZ según su caja en mundo. Cada frame se
+// mide la distancia de cada celda a la cámara y a la posición que tendrá en
+// 'lookAhead' segundos con la velocidad actual:
+//   - más cerca que loadRadius: se abre la caché del modelo en un hilo de
+//     fondo (mapeo, validación, lectura de páginas y triángulos de colisión)
+//     y luego se sube a la GPU de a poco, sin pasar de uploadBytes por frame;
+//   - más lejos que unloadRadius: se suelta. Sus mallas y texturas quedan en
+//     GpuResources sin referencias hasta que el presupuesto de AssetCache las
+//     necesite, así volver a una zona recién dejada no relee el disco.
+// La geometría residente de las celdas no pasa de residentBytes: si falta
+// lugar se descargan primero las celdas de la franja de histéresis.
+// La colisión de las celdas se une a la base en una BVH nueva, armada en el
+// hilo de fondo y entregada con takeCollision() para DronePhysics::setCollision.
+
+class WorldStreamer {
+public:
+    WorldStreamer(AssetCache& assets, const StreamingSettings& settings = StreamingSettings())
+        : assets(assets), settings(settings), loader(1) {}
+    WorldStreamer(const WorldStreamer&) = delete;
+    WorldStreamer& operator=(const WorldStreamer&) = delete;
+
+    // Registra un modelo en la celda de su caja en mundo. Sin caché vigente no
+    // se conocen sus límites sin abrirlo: se carga ya (lo que además hornea la
+    // caché) y queda residente hasta que la distancia diga otra cosa.
+    int add(const SceneObjectDesc& desc) {
+        Chunk chunk;
+        chunk.desc = &desc;
+        glm::vec3 localMin, localMax;
+        uint64_t cacheBytes = 0;
+        bool known = readSceneCacheBounds(desc.path, localMin, localMax, &cacheBytes);
+        if (!known) {
+            chunk.model = std::make_shared<SceneModel>(desc.path, assets.loadOptions());
+            localMin = chunk.model->boundsMin;
+            localMax = chunk.model->boundsMax;
+            if (desc.collision) chunk.triangles = collisionTriangles(*chunk.model);
+            chunk.state = State::Resident;
+            chunk.bytes = chunk.model->geometryBytes();
+        }
+        else {
+            chunk.bytes = (size_t)cacheBytes;
+        }
+        transformBounds(desc.baseTransform(), localMin, localMax, chunk.boundsMin, chunk.boundsMax);
+
+        const int index = (int)chunks.size();
+        glm::vec3 center = (chunk.boundsMin + chunk.boundsMax) * 0.5f;
+        int64_t key = cellKey((int)std::floor(center.x / settings.cellSize), (int)std::floor(center.z / settings.cellSize));
+        auto found = cellIndex.find(key);
+        if (found == cellIndex.end()) {
+            found = cellIndex.emplace(key, (int)cells.size()).first;
+            cells.emplace_back();
+            cells.back().boundsMin = chunk.boundsMin;
+            cells.back().boundsMax = chunk.boundsMax;
+        }
+        Cell& cell = cells[found->second];
+        cell.chunks.push_back(index);
+        cell.boundsMin = glm::min(cell.boundsMin, chunk.boundsMin);
+        cell.boundsMax = glm::max(cell.boundsMax, chunk.boundsMax);
+        chunk.cell = found->second;
+        if (chunk.state == State::Resident) {
+            cell.wanted = true;
+            loadedAtAdd.push_back(index);
+            if (desc.collision) collisionDirty = true;
+        }
+        chunks.push_back(std::move(chunk));
+        return index;
+    }
+
+    // Triángulos que no dependen del streaming (la BVH armada al arrancar).
+    void setBaseCollision(const CollisionBVH& base) {
+        baseTriangles = base.triangles;
+        collisionDirty = true;
+    }
+
+    // Sin ventana: las cargas se hacen dentro de update() y sin límite de
+    // subida, así cada corrida del benchmark ve lo mismo en el mismo frame.
+    void setSynchronous(bool value) { synchronous = value; }
+
+    // Una vez por frame, en el hilo de GL. Después de llamarla, loaded() y
+    // unloaded() tienen los modelos que entraron y salieron en este frame.
+    void update(const glm::vec3& position, const glm::vec3& velocity) {
+        loadedNow.swap(loadedAtAdd);
+        loadedAtAdd.clear();
+        unloadedNow.clear();
+        const glm::vec3 predicted = position + velocity * settings.lookAhead;
+
+        collectFinished();
+
+        // Qué celdas se quieren (con histéresis entre los dos radios)
+        for (Cell& cell : cells) {
+            cell.distance = std::min(distanceXZ(cell, position), distanceXZ(cell, predicted));
+            if (cell.distance < settings.loadRadius) cell.wanted = true;
+            else if (cell.distance > settings.unloadRadius) cell.wanted = false;
+        }
+        for (size_t c = 0; c < cells.size(); c++)
+            if (!cells[c].wanted) unloadCell((int)c);
+
+        requestLoads();
+        uploadPending();
+        rebuildCollision();
+    }
+
+    const std::vector<int>& loaded() const { return loadedNow; }
+    const std::vector<int>& unloaded() const { return unloadedNow; }
+    const SceneObjectDesc& desc(int chunk) const { return *chunks[chunk].desc; }
+    const ModelHandle& model(int chunk) const { return chunks[chunk].model; }
+
+    // La BVH de colisión más nueva, si hubo cambios desde la última llamada.
+    std::shared_ptr<const CollisionBVH> takeCollision() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const CollisionBVH> result = readyCollision;
+        readyCollision.reset();
+        return result;
+    }
+
+    size_t residentBytes() const {
+        size_t total = 0;
+        for (const Chunk& chunk : chunks)
+            if (chunk.state != State::Unloaded) total += chunk.bytes;
+        return total;
+    }
+    int residentCount() const {
+        int count = 0;
+        for (const Chunk& chunk : chunks) count += chunk.state == State::Resident ? 1 : 0;
+        return count;
+    }
+    int chunkCount() const { return (int)chunks.size(); }
+    int cellCount() const { return (int)cells.size(); }
+
+    void report(std::ostream& out) const {
+        out << "Streaming: " << chunks.size() << " modelos en " << cells.size() << " celdas de "
+            << settings.cellSize << " m, " << residentCount() << " residentes ("
+            << residentBytes() / (1024 * 1024) << " MB de " << settings.residentBytes / (1024 * 1024) << " MB)" << std::endl;
+    }
+
+private:
+    enum class State { Unloaded, Loading, Uploading, Resident };
+
+    struct Chunk {
+        const SceneObjectDesc* desc = nullptr;
+        glm::vec3 boundsMin = glm::vec3(0.0f), boundsMax = glm::vec3(0.0f);   // en mundo
+        size_t bytes = 0;           // tamaño de la caché hasta que se sube; luego la geometría real
+        State state = State::Unloaded;
+        ModelHandle model;
+        std::vector<CollisionTriangle> triangles;
+        int cell = -1;
+    };
+
+    struct Cell {
+        std::vector<int> chunks;
+        glm::vec3 boundsMin, boundsMax;
+        bool wanted = false;
+        float distance = 0.0f;
+    };
+
+    struct Finished {
+        int chunk;
+        ModelHandle model;
+        std::vector<CollisionTriangle> triangles;
+    };
+
+    AssetCache& assets;
+    StreamingSettings settings;
+    std::vector<Chunk> chunks;
+    std::vector<Cell> cells;
+    std::unordered_map<int64_t, int> cellIndex;
+    std::vector<int> loadedNow, unloadedNow;
+    std::vector<int> loadedAtAdd;                       // cargados en add(), se informan en el primer update()
+    std::vector<CollisionTriangle> baseTriangles;
+    bool synchronous = false;
+    bool collisionDirty = false;
+    bool collisionBuilding = false;
+    bool overBudget = false;
+
+    std::mutex mutex;                                   // protege lo que escribe el hilo de fondo
+    std::vector<Finished> finished;
+    std::shared_ptr<const CollisionBVH> readyCollision;
+    // Último miembro: se destruye primero y termina sus tareas mientras el resto sigue vivo
+    ThreadPool loader;
+
+    static int64_t cellKey(int x, int z) { return ((int64_t)x << 32) ^ (int64_t)(uint32_t)z; }
+
+    static float distanceXZ(const Cell& cell, const glm::vec3& p) {
+        float dx = std::max(std::max(cell.boundsMin.x - p.x, p.x - cell.boundsMax.x), 0.0f);
+        float dz = std::max(std::max(cell.boundsMin.z - p.z, p.z - cell.boundsMax.z), 0.0f);
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+    static std::vector<CollisionTriangle> collisionTriangles(const SceneModel& model) {
+        CollisionBVH scratch;
+        scratch.addMeshes(model.meshes);
+        return std::move(scratch.triangles);
+    }
+
+    // Hilo de fondo (o el de GL en modo síncrono): todo lo que no toca GL.
+    Finished open(int index, const std::string& path, bool collision, SceneLoadOptions options) {
+        options.uploadToGpu = false;
+        options.writeCache = false;
+        Finished result;
+        result.chunk = index;
+        result.model = std::make_shared<SceneModel>(path, options);
+        result.model->prefetch();
+        if (collision) result.triangles = collisionTriangles(*result.model);
+        return result;
+    }
+
+    void collectFinished() {
+        std::vector<Finished> done;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.swap(finished);
+        }
+        for (Finished& f : done) accept(f);
+    }
+
+    void accept(Finished& f) {
+        Chunk& chunk = chunks[f.chunk];
+        if (chunk.state != State::Loading) return;
+        if (!cells[chunk.cell].wanted || f.model->meshes.empty()) {
+            // Ya no hace falta, o la caché dejó de ser válida mientras tanto
+            if (f.model->meshes.empty()) std::cout << "STREAM::LOAD_FAILED " << chunk.desc->path << std::endl;
+            chunk.state = State::Unloaded;
+            return;
+        }
+        chunk.model = std::move(f.model);
+        chunk.triangles = std::move(f.triangles);
+        chunk.state = State::Uploading;
+    }
+
+    void unloadCell(int c) {
+        for (int index : cells[c].chunks) {
+            Chunk& chunk = chunks[index];
+            if (chunk.state == State::Resident) {
+                // Si entró en este mismo frame, para el llamador nunca estuvo
+                auto reported = std::find(loadedNow.begin(), loadedNow.end(), index);
+                if (reported != loadedNow.end()) loadedNow.erase(reported);
+                else unloadedNow.push_back(index);
+                if (chunk.desc->collision) collisionDirty = true;
+            }
+            // Lo que se está abriendo en el fondo se descarta al llegar
+            if (chunk.state == State::Loading) continue;
+            chunk.model.reset();
+            chunk.triangles.clear();
+            chunk.triangles.shrink_to_fit();
+            chunk.state = State::Unloaded;
+        }
+    }
+
+    // Celdas queridas con modelos sin cargar, la más cercana primero.
+    void requestLoads() {
+        std::vector<int> order;
+        for (size_t c = 0; c < cells.size(); c++)
+            if (cells[c].wanted) order.push_back((int)c);
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return cells[a].distance < cells[b].distance; });
+
+        size_t resident = residentBytes();
+        for (int c : order) {
+            for (int index : cells[c].chunks) {
+                Chunk& chunk = chunks[index];
+                if (chunk.state != State::Unloaded) continue;
+                if (resident + chunk.bytes > settings.residentBytes && !makeRoom(chunk.bytes, cells[c].distance, resident)) {
+                    if (!overBudget)
+                        std::cout << "STREAM::OVER_BUDGET " << resident / (1024 * 1024) << " MB de "
+                                  << settings.residentBytes / (1024 * 1024) << " MB" << std::endl;
+                    overBudget = true;
+                    return;
+                }
+                resident += chunk.bytes;
+                chunk.state = State::Loading;
+                const std::string path = chunk.desc->path;
+                const bool collision = chunk.desc->collision;
+                const SceneLoadOptions options = assets.loadOptions();
+                if (synchronous) {
+                    Finished f = open(index, path, collision, options);
+                    accept(f);
+                    continue;
+                }
+                loader.submit([this, index, path, collision, options] {
+                    Finished f = open(index, path, collision, options);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    finished.push_back(std::move(f));
+                });
+            }
+        }
+        overBudget = false;
+    }
+
+    // Descarga celdas más lejanas que 'distance' (empezando por la más lejana)
+    // hasta que entren 'bytes' más. Solo las que ya quedaron fuera de loadRadius.
+    bool makeRoom(size_t bytes, float distance, size_t& resident) {
+        while (resident + bytes > settings.residentBytes) {
+            int farthest = -1;
+            for (size_t c = 0; c < cells.size(); c++) {
+                const Cell& cell = cells[c];
+                if (!cell.wanted || cell.distance < settings.loadRadius || cell.distance <= distance) continue;
+                if (farthest < 0 || cell.distance > cells[farthest].distance) farthest = (int)c;
+            }
+            if (farthest < 0) return false;
+            cells[farthest].wanted = false;
+            unloadCell(farthest);
+            resident = residentBytes();
+        }
+        return true;
+    }
+
+    // Subida a GPU repartida entre frames, la celda más cercana primero.
+    void uploadPending() {
+        std::vector<int> order;
+        for (size_t i = 0; i < chunks.size(); i++)
+            if (chunks[i].state == State::Uploading) order.push_back((int)i);
+        std::sort(order.begin(), order.end(),
+                  [&](int a, int b) { return cells[chunks[a].cell].distance < cells[chunks[b].cell].distance; });
+
+        size_t remaining = synchronous ? std::numeric_limits<size_t>::max() : settings.uploadBytes;
+        for (int index : order) {
+            if (remaining == 0) break;
+            Chunk& chunk = chunks[index];
+            remaining -= std::min(remaining, chunk.model->uploadPending(remaining));
+            if (!chunk.model->uploadComplete()) continue;
+            chunk.state = State::Resident;
+            chunk.bytes = chunk.model->geometryBytes();
+            loadedNow.push_back(index);
+            if (chunk.desc->collision) collisionDirty = true;
+        }
+    }
+
+    // Base + celdas residentes con colisión en una BVH nueva; si ya hay una
+    // armándose, se espera a que termine y se arma otra con el estado de ese momento.
+    void rebuildCollision() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (collisionBuilding) return;
+        }
+        if (!collisionDirty) return;
+        collisionDirty = false;
+
+        std::shared_ptr<CollisionBVH> bvh = std::make_shared<CollisionBVH>();
+        bvh->triangles = baseTriangles;
+        for (const Chunk& chunk : chunks)
+            if (chunk.state == State::Resident)
+                bvh->triangles.insert(bvh->triangles.end(), chunk.triangles.begin(), chunk.triangles.end());
+        if (synchronous) {
+            bvh->build();
+            std::lock_guard<std::mutex> lock(mutex);
+            readyCollision = bvh;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            collisionBuilding = true;
+        }
+        loader.submit([this, bvh] {
+            bvh->build();
+            std::lock_guard<std::mutex> lock(mutex);
+            readyCollision = bvh;
+            collisionBuilding = false;
+        });
+    }
+};
+
+#endif
@@ -1,11 +1,16 @@
 #version 330 core
+// Variantes (engine/shader_variants.h): Proyecto.cpp compila una por
+// combinación y elige la que corresponde en cada dibujo.
+//   THERMAL_VISION  visión nocturna: solo la luminancia de la textura
+//   EMISSIVE        objetos que brillan (como la luna): sin luces ni niebla
+//   FOG             niebla según la distancia a la cámara
 out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
-
-#define MAX_LIGHTS 32
+in float ViewDepth;
+flat in float TextureLayer;
 
 struct Material {
     sampler2D diffuse;
@@ -13,26 +18,33 @@ struct Material {
     float shininess;
 };
 
-struct PointLight {
-    vec3 position;
-    vec3 color;
-    float intensity;
+// --- LUCES POR CLUSTERS (ver engine/light_clusters.h) ---
+uniform samplerBuffer lightData;      // 2 texels por luz: (posición, radio), (color, intensidad)
+uniform usamplerBuffer clusterGrid;   // (offset, cantidad) por cluster
+uniform usamplerBuffer lightIndices;  // índices de luz de todos los clusters
+
+// --- DATOS POR FRAME Y POR OBJETO (ver engine/render_queue.h) ---
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;          // xyz = cámara
+    ivec4 clusterDims;     // xyz = tiles x, tiles y, cortes
+    vec4 clusterParams;    // xy = viewport, z = clusterNear, w = clusterLogScale
 };
 
-uniform Material material;
-uniform PointLight pointLights[MAX_LIGHTS];
-uniform int numLights;
-uniform vec3 viewPos;
-uniform bool thermalVision;
+layout (std140) uniform ObjectData {
+    bool useTextureArray;  // geometría estática agrupada: textura desde materialLayers
+    int instanceBase;      // solo lo usa lighting.vs
+};
 
-// --- NUEVO: Interruptor para objetos que brillan (como la luna) ---
-uniform bool isEmissive;
-// -----------------------------------------------------------------
+uniform Material material;
+uniform sampler2DArray materialLayers;
 
 void main()
 {
     // 1. LEEMOS LA TEXTURA COMPLETA (RGBA)
-    vec4 texColor = texture(material.diffuse, TexCoords);
+    vec4 texColor = useTextureArray ? texture(materialLayers, vec3(TexCoords, TextureLayer))
+                                    : texture(material.diffuse, TexCoords);
 
     // 2. EL TRUCO MAGICO: "DISCARD"
     // Si la transparencia (alpha) es menor al 10%, descartamos el píxel.
@@ -42,66 +54,68 @@ void main()
 
     // 3. Continuamos con la lógica normal usando el RGB de la textura
     vec3 diffTex = texColor.rgb; 
-    vec3 norm = normalize(Normal);
 
-    //vec3 norm = normalize(Normal);
-    //vec3 diffTex = texture(material.diffuse, TexCoords).rgb;
+#if defined(THERMAL_VISION)
+    // --- VISIÓN NOCTURNA MILITAR OSCURA ---
+    // (Esto funcionará bien con la luna porque usa 'diffTex' directamente.
+    //  La luna se verá verde brillante, lo cual es realista para visión nocturna).
+
+    // Extraemos la luminancia
+    float grayscale = dot(diffTex, vec3(0.2126, 0.7152, 0.0722));
     
-    // 1. Iluminación normal (calculamos esto siempre, pero lo usaremos según el caso)
+    // Multiplicador de brillo (ajusta este 1.4 si lo quieres más oscuro aún)
+    float brightness = grayscale * 1.4;
+
+    // Color verde militar oscuro (Fósforo P43)
+    vec3 nightVisionColor = vec3(0.05, 0.45, 0.1); 
+    
+    // Aplicamos un contraste extra para que las sombras no se pierdan
+    vec3 finalColor = nightVisionColor * brightness;
+    finalColor = pow(finalColor, vec3(1.1)); // Oscurece los tonos medios
+
+    FragColor = vec4(finalColor, 1.0);
+#elif defined(EMISSIVE)
+    // Si es la luna (emisivo), ignoramos la niebla y las luces.
+    // Devolvemos el color puro de la textura para que brille.
+    FragColor = vec4(diffTex, 1.0); 
+#else
+    vec3 norm = normalize(Normal);
+
+    // Iluminación normal: ambiente + las luces del cluster
     vec3 lighting = 0.05 * diffTex; 
-    for (int i = 0; i < numLights; i++)
+
+    // Solo las luces asignadas al cluster de este fragmento
+    float clusterNear = clusterParams.z;
+    ivec2 tile = min(ivec2(gl_FragCoord.xy / clusterParams.xy * vec2(clusterDims.xy)), clusterDims.xy - 1);
+    int slice = clamp(int(log(max(ViewDepth, clusterNear) / clusterNear) * clusterParams.w), 0, clusterDims.z - 1);
+    uvec2 cell = texelFetch(clusterGrid, (slice * clusterDims.y + tile.y) * clusterDims.x + tile.x).rg;
+    for (uint i = 0u; i < cell.y; i++)
     {
-        vec3 lightDir = normalize(pointLights[i].position - FragPos);
-        float dist = length(pointLights[i].position - FragPos);
+        int li = int(texelFetch(lightIndices, int(cell.x + i)).r);
+        vec4 posRadius = texelFetch(lightData, li * 2);
+        vec4 colorIntensity = texelFetch(lightData, li * 2 + 1);
+
+        vec3 lightDir = normalize(posRadius.xyz - FragPos);
+        float dist = length(posRadius.xyz - FragPos);
         float atten = 1.0 / (1.0 + 0.7 * dist + 1.8 * (dist * dist));
+        // Lleva el aporte a cero en el radio de influencia para que no haya cortes visibles
+        float window = clamp(1.0 - pow(dist / posRadius.w, 4.0), 0.0, 1.0);
+        atten *= window * window;
         float diff = max(dot(norm, lightDir), 0.0);
-        lighting += diff * pointLights[i].color * diffTex * pointLights[i].intensity * atten;
+        lighting += diff * colorIntensity.rgb * diffTex * colorIntensity.a * atten;
     }
 
-    if(thermalVision)
-    {
-        // --- VISIÓN NOCTURNA MILITAR OSCURA ---
-        // (Esto funcionará bien con la luna porque usa 'diffTex' directamente.
-        //  La luna se verá verde brillante, lo cual es realista para visión nocturna).
-
-        // Extraemos la luminancia
-        float grayscale = dot(diffTex, vec3(0.2126, 0.7152, 0.0722));
-        
-        // Multiplicador de brillo (ajusta este 1.4 si lo quieres más oscuro aún)
-        float brightness = grayscale * 1.4;
-
-        // Color verde militar oscuro (Fósforo P43)
-        vec3 nightVisionColor = vec3(0.05, 0.45, 0.1); 
-        
-        // Aplicamos un contraste extra para que las sombras no se pierdan
-        vec3 finalColor = nightVisionColor * brightness;
-        finalColor = pow(finalColor, vec3(1.1)); // Oscurece los tonos medios
-
-        FragColor = vec4(finalColor, 1.0);
-    }
-    else
-    {
-        // --- MODO NORMAL ---
-
-        // --- NUEVA LÓGICA AQUÍ ---
-        if (isEmissive) 
-        {
-            // Si es la luna (emisivo), ignoramos la niebla y las luces.
-            // Devolvemos el color puro de la textura para que brille.
-            FragColor = vec4(diffTex, 1.0); 
-        }
-        else 
-        {
-            // Si es la casa o el suelo, aplicamos niebla y luz normal
-            float distCam = length(viewPos - FragPos);
-            float fogFactor = exp(-distCam * 0.04);
-            fogFactor = clamp(fogFactor, 0.0, 1.0);
-            
-            vec3 fogColor = vec3(0.01, 0.01, 0.02); 
-            vec3 finalColor = mix(fogColor, lighting, fogFactor);
-            
-            FragColor = vec4(pow(finalColor, vec3(1.0/1.2)), 1.0);
-        }
-        // -------------------------
-    }
+#ifdef FOG
+    // Si es la casa o el suelo, aplicamos niebla y luz normal
+    float distCam = length(viewPos.xyz - FragPos);
+    float fogFactor = exp(-distCam * 0.04);
+    fogFactor = clamp(fogFactor, 0.0, 1.0);
+    
+    vec3 fogColor = vec3(0.01, 0.01, 0.02); 
+    vec3 finalColor = mix(fogColor, lighting, fogFactor);
+#else
+    vec3 finalColor = lighting;
+#endif
+    FragColor = vec4(pow(finalColor, vec3(1.0/1.2)), 1.0);
+#endif
 }
\ No newline at end of file
@@ -3,20 +3,49 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+layout (location = 7) in float aTextureLayer;   // solo en la geometría agrupada (static_batch.h)
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+out float ViewDepth;
+flat out float TextureLayer;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Mismos bloques que lighting.fs (ver engine/render_queue.h)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    ivec4 clusterDims;
+    vec4 clusterParams;
+};
+
+layout (std140) uniform ObjectData {
+    bool useTextureArray;
+    int instanceBase;
+};
+
+// Matrices calculadas en la CPU, 7 texels por instancia: 4 columnas de model y
+// 3 de la matriz normal. Los objetos repetidos usan gl_InstanceID.
+uniform samplerBuffer instanceTransforms;
 
 void main()
 {
+    int texel = (instanceBase + gl_InstanceID) * 7;
+    mat4 model = mat4(texelFetch(instanceTransforms, texel),
+                      texelFetch(instanceTransforms, texel + 1),
+                      texelFetch(instanceTransforms, texel + 2),
+                      texelFetch(instanceTransforms, texel + 3));
+    mat3 normalMatrix = mat3(texelFetch(instanceTransforms, texel + 4).xyz,
+                             texelFetch(instanceTransforms, texel + 5).xyz,
+                             texelFetch(instanceTransforms, texel + 6).xyz);
+
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = normalMatrix * aNormal;
     TexCoords = aTexCoords;
+    TextureLayer = aTextureLayer;
 
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+    vec4 viewSpacePos = view * vec4(FragPos, 1.0);
+    ViewDepth = -viewSpacePos.z;
+    gl_Position = projection * viewSpacePos;
 }
@@ -0,0 +1,67 @@
+// Horneado offline de la caché binaria de escenas.
+// Uso: bake_scene [archivo.obj | directorio]...   (por defecto: model/scene2)
+#include "gl_context.h"
+#include "../engine/scene_cache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/stb_image.h>
+
+namespace fs = std::filesystem;
+
+std::vector<std::string> collectObjFiles(int argc, char** argv) {
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++) inputs.push_back(argv[i]);
+    if (inputs.empty()) inputs.push_back("model/scene2");
+
+    std::vector<std::string> files;
+    for (const auto& input : inputs) {
+        if (fs::is_directory(input)) {
+            for (const auto& entry : fs::directory_iterator(input))
+                if (entry.path().extension() == ".obj") files.push_back(entry.path().generic_string());
+        }
+        else {
+            files.push_back(input);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> files = collectObjFiles(argc, argv);
+    GLFWwindow* window = createHiddenContext();
+    if (!window) return -1;
+
+    int failures = 0;
+    for (const auto& path : files) {
+        SceneLoadOptions options;
+        options.useCache = false;
+        options.writeCache = false;
+        SceneModel model(path, options);
+
+        size_t vertices = 0, indices = 0;
+        for (const auto& mesh : model.meshes) {
+            vertices += mesh.vertices.size();
+            indices += mesh.indices.size();
+        }
+        bool ok = writeSceneCache(path, model.meshes);
+        if (!ok) failures++;
+
+        std::error_code ec;
+        auto bytes = fs::file_size(sceneCachePath(path), ec);
+        std::cout << (ok ? "BAKED  " : "FAILED ") << path
+                  << "  meshes=" << model.meshes.size()
+                  << " vertices=" << vertices
+                  << " triangles=" << indices / 3
+                  << " cache=" << (ec ? 0 : bytes / 1024) << " KiB" << std::endl;
+    }
+
+    glfwTerminate();
+    return failures == 0 ? 0 : 1;
+}
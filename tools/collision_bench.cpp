@@ -0,0 +1,124 @@
+// Reproduce posiciones aleatorias del dron contra la geometría de Scnecp y
+// compara la BVH por triángulos con la fuerza bruta y con el antiguo barrido
+// lineal de cajas por malla. También replica la escena en rejilla (1, 4, 16
+// copias) para ver cómo crece el costo por consulta.
+// Requiere la caché horneada (bake_scene); no abre ventana ni contexto GL.
+// Uso: collision_bench [modelo.obj] [--queries N]   (por defecto: model/scene2/Scnecp.obj, 200000)
+#include "../engine/collision_bvh.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/stb_image.h>
+
+const float DRONE_RADIUS = 0.3f;
+
+using Clock = std::chrono::high_resolution_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    std::string path = "model/scene2/Scnecp.obj";
+    int queries = 200000;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--queries") == 0 && i + 1 < argc) queries = std::max(1, std::atoi(argv[++i]));
+        else path = argv[i];
+    }
+
+    SceneLoadOptions options;
+    options.uploadToGpu = false;
+    options.writeCache = false;
+    SceneModel scene(path, options);
+    if (scene.meshes.empty()) return 1;
+
+    glm::vec3 extent = scene.boundsMax - scene.boundsMin;
+    std::printf("%s: %zu meshes, bounds %.1f x %.1f x %.1f\n", path.c_str(), scene.meshes.size(), extent.x, extent.y, extent.z);
+
+    std::mt19937 rng(1234);
+    std::printf("%7s %10s %9s %10s %12s %12s %8s\n", "copies", "triangles", "nodes", "build ms", "bvh ns/q", "nodes/q", "hits");
+
+    for (int grid : { 1, 2, 4 }) {
+        CollisionBVH bvh;
+        for (int gx = 0; gx < grid; gx++)
+            for (int gz = 0; gz < grid; gz++) {
+                glm::mat4 offset = glm::translate(glm::mat4(1.0f), glm::vec3(gx * extent.x, 0.0f, gz * extent.z));
+                bvh.addMeshes(scene.meshes, offset);
+            }
+        auto buildStart = Clock::now();
+        bvh.build();
+        double buildMs = elapsedMs(buildStart);
+
+        glm::vec3 lo = scene.boundsMin;
+        glm::vec3 hi = scene.boundsMin + glm::vec3(extent.x * grid, extent.y, extent.z * grid);
+        std::uniform_real_distribution<float> ux(lo.x, hi.x), uy(lo.y, hi.y), uz(lo.z, hi.z);
+        std::vector<glm::vec3> positions(queries);
+        for (auto& p : positions) p = glm::vec3(ux(rng), uy(rng), uz(rng));
+
+        long long visited = 0;
+        int hits = 0;
+        auto start = Clock::now();
+        for (const auto& p : positions) {
+            bool hit = false;
+            visited += bvh.querySphere(p, DRONE_RADIUS, [&](const CollisionTriangle& tri) {
+                glm::vec3 q = closestPointOnTriangle(p, tri.v0, tri.v1, tri.v2);
+                if (glm::dot(p - q, p - q) < DRONE_RADIUS * DRONE_RADIUS) hit = true;
+            });
+            hits += hit;
+        }
+        double ms = elapsedMs(start);
+        std::printf("%7d %10zu %9zu %10.1f %12.1f %12.1f %8d\n", grid * grid, bvh.triangleCount(), bvh.nodeCount(),
+                    buildMs, ms * 1e6 / queries, (double)visited / queries, hits);
+    }
+
+    // Referencias sobre la escena original: fuerza bruta (para validar) y cajas por malla.
+    CollisionBVH bvh;
+    bvh.addMeshes(scene.meshes);
+    bvh.build();
+
+    std::vector<std::pair<glm::vec3, glm::vec3>> boxes;
+    for (const auto& mesh : scene.meshes) boxes.push_back({ mesh.boundsMin, mesh.boundsMax });
+
+    std::uniform_real_distribution<float> ux(scene.boundsMin.x, scene.boundsMax.x);
+    std::uniform_real_distribution<float> uy(scene.boundsMin.y, scene.boundsMax.y);
+    std::uniform_real_distribution<float> uz(scene.boundsMin.z, scene.boundsMax.z);
+    int bruteQueries = std::min(queries, 2000);
+    std::vector<glm::vec3> positions(bruteQueries);
+    for (auto& p : positions) p = glm::vec3(ux(rng), uy(rng), uz(rng));
+
+    int mismatches = 0, bruteHits = 0, boxHits = 0;
+    auto bruteStart = Clock::now();
+    for (const auto& p : positions) {
+        bool hit = false;
+        for (const auto& tri : bvh.triangles) {
+            glm::vec3 q = closestPointOnTriangle(p, tri.v0, tri.v1, tri.v2);
+            if (glm::dot(p - q, p - q) < DRONE_RADIUS * DRONE_RADIUS) { hit = true; break; }
+        }
+        bruteHits += hit;
+        if (hit != bvh.overlapsSphere(p, DRONE_RADIUS)) mismatches++;
+    }
+    double bruteMs = elapsedMs(bruteStart);
+
+    auto boxStart = Clock::now();
+    for (const auto& p : positions) {
+        for (const auto& box : boxes) {
+            if (sphereBoxDistance2(p, box.first, box.second) < DRONE_RADIUS * DRONE_RADIUS) { boxHits++; break; }
+        }
+    }
+    double boxMs = elapsedMs(boxStart);
+
+    std::printf("\nbrute force: %.1f us/query, %d/%d hits, %d BVH mismatches\n", bruteMs * 1e3 / bruteQueries, bruteHits, bruteQueries, mismatches);
+    std::printf("per-mesh AABB scan: %.1f ns/query, %d/%d blocked (%.1fx more than the real triangles)\n",
+                boxMs * 1e6 / bruteQueries, boxHits, bruteQueries, bruteHits ? (double)boxHits / bruteHits : 0.0);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+// Horneado offline de texturas comprimidas: cada imagen se codifica en la CPU
+// (BC1 opaca, BC3 con alfa, BC5 normales) con su cadena de mipmaps y se
+// guarda como <imagen>.ktx al lado de la original. Reporta por textura la
+// memoria de GPU sin comprimir (RGB/RGBA8 + mipmaps), la comprimida y el PSNR
+// del nivel 0. Las que ya tienen un .ktx vigente se saltan (salvo --force).
+// Uso: compress_textures [imagen | directorio]... [--force]   (por defecto: model/scene2/textures)
+#include "../engine/texture_compression.h"
+#include "../engine/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/stb_image.h>
+
+namespace fs = std::filesystem;
+
+struct Result {
+    std::string path;
+    const char* format = "";
+    int width = 0, height = 0;
+    size_t rawBytes = 0, compressedBytes = 0;
+    double psnr = 0.0;
+    enum { Baked, Skipped, Failed } status = Failed;
+};
+
+// --- DECODIFICACIÓN (solo para medir el error) ---
+static void decodeColorBlock(const unsigned char* block, unsigned char rgba[64]) {
+    int c[2] = { block[0] | (block[1] << 8), block[2] | (block[3] << 8) };
+    float palette[4][3];
+    bc_detail::from565(c[0], palette[0]);
+    bc_detail::from565(c[1], palette[1]);
+    for (int k = 0; k < 3; k++) {
+        palette[2][k] = (2.0f * palette[0][k] + palette[1][k]) / 3.0f;
+        palette[3][k] = (palette[0][k] + 2.0f * palette[1][k]) / 3.0f;
+    }
+    uint32_t bits = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+    for (int i = 0; i < 16; i++)
+        for (int k = 0; k < 3; k++) rgba[i * 4 + k] = (unsigned char)std::lround(palette[(bits >> (i * 2)) & 3][k]);
+}
+
+static void decodeChannelBlock(const unsigned char* block, unsigned char* out, int stride) {
+    int hi = block[0], lo = block[1];
+    int palette[8] = { hi, lo };
+    for (int p = 1; p <= 6; p++) palette[p + 1] = ((7 - p) * hi + p * lo + 3) / 7;
+    uint64_t bits = 0;
+    for (int k = 0; k < 6; k++) bits |= (uint64_t)block[2 + k] << (k * 8);
+    for (int i = 0; i < 16; i++) out[i * stride] = (unsigned char)palette[hi > lo ? (bits >> (i * 3)) & 7 : 0];
+}
+
+// PSNR del nivel 0 sobre los canales que guarda el formato.
+static double levelPsnr(const unsigned char* rgba, int width, int height, BlockFormat format, const unsigned char* data) {
+    const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    const int channels = format == BlockFormat::BC5 ? 2 : format == BlockFormat::BC3 ? 4 : 3;
+    double sum = 0.0;
+    size_t samples = 0;
+    unsigned char decoded[64];
+    for (int by = 0; by < blocksY; by++)
+        for (int bx = 0; bx < blocksX; bx++, data += blockBytes(format)) {
+            if (format == BlockFormat::BC1) decodeColorBlock(data, decoded);
+            else if (format == BlockFormat::BC3) { decodeColorBlock(data + 8, decoded); decodeChannelBlock(data, decoded + 3, 4); }
+            else { decodeChannelBlock(data, decoded, 4); decodeChannelBlock(data + 8, decoded + 1, 4); }
+            for (int y = 0; y < 4 && by * 4 + y < height; y++)
+                for (int x = 0; x < 4 && bx * 4 + x < width; x++) {
+                    const unsigned char* src = rgba + ((size_t)(by * 4 + y) * width + bx * 4 + x) * 4;
+                    for (int k = 0; k < channels; k++) {
+                        double d = (double)src[k] - decoded[(y * 4 + x) * 4 + k];
+                        sum += d * d;
+                    }
+                    samples += channels;
+                }
+        }
+    double mse = samples ? sum / samples : 0.0;
+    return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+}
+
+static Result compressOne(const std::string& path, bool force) {
+    Result result;
+    result.path = path;
+    const std::string ktxPath = compressedTexturePath(path);
+    CompressedTexture existing;
+    if (!force && readKtx(ktxPath, path, existing)) {
+        result.status = Result::Skipped;
+        result.compressedBytes = existing.bytes();
+        return result;
+    }
+
+    int channels = 0;
+    unsigned char* rgba = stbi_load(path.c_str(), &result.width, &result.height, &channels, 4);
+    if (!rgba) return result;
+
+    BlockFormat format = chooseBlockFormat(path, rgba, result.width, result.height);
+    result.format = format == BlockFormat::BC1 ? "BC1" : format == BlockFormat::BC3 ? "BC3" : "BC5";
+    CompressedTexture texture;
+    compressTexture(rgba, result.width, result.height, format, texture);
+    result.psnr = levelPsnr(rgba, result.width, result.height, format, texture.data.data());
+    // Lo que ocupa hoy en GPU: la imagen tal cual más un tercio de mipmaps
+    result.rawBytes = (size_t)result.width * result.height * channels * 4 / 3;
+    result.compressedBytes = texture.bytes();
+    stbi_image_free(rgba);
+
+    result.status = writeKtx(ktxPath, texture, path) ? Result::Baked : Result::Failed;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    bool force = false;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--force") == 0) force = true;
+        else inputs.push_back(argv[i]);
+    }
+    if (inputs.empty()) inputs.push_back("model/scene2/textures");
+
+    std::vector<std::string> files;
+    for (const auto& input : inputs) {
+        if (!fs::is_directory(input)) {
+            files.push_back(input);
+            continue;
+        }
+        for (const auto& entry : fs::directory_iterator(input)) {
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".tga")
+                files.push_back(entry.path().generic_string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    // Una imagen por tarea; el resultado se imprime en orden al final
+    std::vector<Result> results(files.size());
+    ThreadPool pool;
+    pool.parallelFor(files.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) results[i] = compressOne(files[i], force);
+    });
+
+    size_t rawTotal = 0, compressedTotal = 0;
+    int failures = 0, skipped = 0;
+    for (const Result& r : results) {
+        if (r.status == Result::Failed) {
+            failures++;
+            std::printf("FAILED  %s\n", r.path.c_str());
+            continue;
+        }
+        if (r.status == Result::Skipped) {
+            skipped++;
+            continue;
+        }
+        rawTotal += r.rawBytes;
+        compressedTotal += r.compressedBytes;
+        std::printf("BAKED   %-60s %s %5dx%-5d %8zu KiB -> %7zu KiB (%4.1fx)  PSNR %.1f dB\n", r.path.c_str(), r.format,
+                    r.width, r.height, r.rawBytes / 1024, r.compressedBytes / 1024,
+                    (double)r.rawBytes / std::max<size_t>(r.compressedBytes, 1), r.psnr);
+    }
+    std::printf("%zu textures: %d baked, %d up to date, %d failed; %.1f MB -> %.1f MB\n", files.size(),
+                (int)files.size() - skipped - failures, skipped, failures, rawTotal / 1048576.0, compressedTotal / 1048576.0);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+#ifndef TOOLS_GL_CONTEXT_H
+#define TOOLS_GL_CONTEXT_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+
+// Contexto OpenGL 3.3 core con una ventana oculta, para las herramientas de
+// línea de comandos que necesitan subir buffers o texturas (bake, benchmarks).
+inline GLFWwindow* createHiddenContext() {
+    if (!glfwInit()) {
+        std::cout << "Failed to initialize GLFW" << std::endl;
+        return nullptr;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, 0);
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "tool", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create hidden GL context" << std::endl;
+        glfwTerminate();
+        return nullptr;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return nullptr;
+    }
+    return window;
+}
+
+#endif
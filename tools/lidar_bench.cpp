@@ -0,0 +1,103 @@
+// Rayos por segundo del LiDAR simulado (lidar_sensor.h) contra la BVH de
+// Scnecp: rayo por rayo en un hilo, paquetes SSE de 4 rayos en un hilo y
+// paquetes repartidos en el pool. Verifica que los paquetes den las mismas
+// distancias que los rayos sueltos y compara con el ritmo de 10 y 20 Hz.
+// Requiere la caché horneada (bake_scene); no abre ventana ni contexto GL.
+// Uso: lidar_bench [modelo.obj] [--scans N] [--beams N] [--steps N]   (por defecto: model/scene2/Scnecp.obj, 20, 64, 1024)
+#include "../engine/lidar_sensor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/stb_image.h>
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Poses repartidas por la escena: centro a media altura y cerca de las esquinas, con rumbos distintos.
+std::vector<LidarPose> scenePoses(const glm::vec3& mn, const glm::vec3& mx) {
+    std::vector<LidarPose> poses;
+    glm::vec3 extent = mx - mn;
+    const glm::vec3 spots[] = { glm::vec3(0.5f, 0.3f, 0.5f), glm::vec3(0.2f, 0.2f, 0.2f), glm::vec3(0.8f, 0.4f, 0.3f),
+                                glm::vec3(0.3f, 0.6f, 0.8f), glm::vec3(0.7f, 0.2f, 0.7f) };
+    float yaw = 0.0f;
+    for (const auto& s : spots) {
+        LidarPose pose;
+        pose.position = mn + extent * s;
+        pose.yaw = yaw;
+        yaw += 73.0f;
+        poses.push_back(pose);
+    }
+    return poses;
+}
+
+// Milisegundos por barrido (promedio de 'scans'); deja el último barrido en 'points'.
+double timeScans(const LidarScanner& scanner, const CollisionBVH& bvh, const std::vector<LidarPose>& poses,
+                 ThreadPool& pool, bool packets, int scans, std::vector<LidarPoint>& points, uint32_t& hits) {
+    points.resize(scanner.pointCount());
+    auto start = Clock::now();
+    for (int s = 0; s < scans; s++)
+        hits = scanner.scan(bvh, poses[s % poses.size()], pool, points.data(), packets);
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / scans;
+}
+
+int main(int argc, char** argv) {
+    std::string path = "model/scene2/Scnecp.obj";
+    int scans = 20;
+    LidarSettings settings;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--scans") == 0 && hasValue) scans = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--beams") == 0 && hasValue) settings.beams = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--steps") == 0 && hasValue) settings.azimuthSteps = std::max(4, std::atoi(argv[++i]));
+        else path = argv[i];
+    }
+
+    SceneLoadOptions options;
+    options.uploadToGpu = false;
+    options.writeCache = false;
+    SceneModel scene(path, options);
+    if (scene.meshes.empty()) return 1;
+
+    CollisionBVH bvh;
+    bvh.addMeshes(scene.meshes);
+    bvh.build();
+    LidarScanner scanner(settings);
+    const LidarSettings& used = scanner.config();
+    std::vector<LidarPose> poses = scenePoses(scene.boundsMin, scene.boundsMax);
+
+    ThreadPool serial(0), pool;
+    std::printf("%s: %zu triangles, %d beams x %d steps = %zu rays per scan, %zu worker threads, %d scans\n",
+                path.c_str(), bvh.triangleCount(), used.beams, used.azimuthSteps, scanner.pointCount(), pool.size(), scans);
+
+    std::vector<LidarPoint> single, packet, parallel;
+    uint32_t singleHits = 0, packetHits = 0, parallelHits = 0;
+    double singleMs = timeScans(scanner, bvh, poses, serial, false, scans, single, singleHits);
+    double packetMs = timeScans(scanner, bvh, poses, serial, true, scans, packet, packetHits);
+    double parallelMs = timeScans(scanner, bvh, poses, pool, true, scans, parallel, parallelHits);
+
+    std::printf("%-22s %10s %10s %9s %8s %8s\n", "variant", "ms/scan", "Mrays/s", "speedup", "10 Hz", "20 Hz");
+    auto row = [&](const char* name, double ms) {
+        std::printf("%-22s %10.3f %10.2f %8.2fx %8s %8s\n", name, ms, scanner.pointCount() / (ms * 1000.0), singleMs / ms,
+                    ms <= 100.0 ? "ok" : "slow", ms <= 50.0 ? "ok" : "slow");
+    };
+    row("single rays, 1 thread", singleMs);
+    row("SSE packets, 1 thread", packetMs);
+    row("SSE packets, pool", parallelMs);
+
+    double worst = 0.0;
+    for (size_t i = 0; i < single.size(); i++) {
+        worst = std::max(worst, (double)std::fabs(single[i].range - packet[i].range));
+        worst = std::max(worst, (double)std::fabs(single[i].range - parallel[i].range));
+    }
+    std::printf("hits %u of %zu, max range difference %.2e m\n", singleHits, scanner.pointCount(), worst);
+    bool ok = singleHits == packetHits && singleHits == parallelHits && worst < 1e-4;
+    if (!ok) std::printf("MISMATCH between packets and single rays\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+// Compara el análisis de mallas de mesh_analysis.h con el recorrido escalar
+// que hacía ExtractData (glm::min/max y suma de centroides vértice por
+// vértice, en el hilo principal) sobre las mallas de Scnecp: escalar, SIMD en
+// un hilo y SIMD repartido en el pool. Verifica que los resultados coincidan.
+// Requiere la caché horneada (bake_scene); no abre ventana ni contexto GL.
+// Uso: mesh_analysis_bench [modelo.obj] [--runs N]   (por defecto: model/scene2/Scnecp.obj, 50)
+#include "../engine/scene_cache.h"
+#include "../engine/mesh_analysis.h"
+#include "../engine/thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/stb_image.h>
+
+using Clock = std::chrono::high_resolution_clock;
+
+// El recorrido de antes, más la esfera y los triángulos para dar las mismas salidas.
+std::vector<MeshStats> analyzeScalar(const std::vector<SceneMesh>& meshes) {
+    std::vector<MeshStats> out(meshes.size());
+    for (size_t m = 0; m < meshes.size(); m++) {
+        const SceneMesh& mesh = meshes[m];
+        MeshStats& s = out[m];
+        s.vertexCount = (uint32_t)mesh.vertices.size();
+        s.triangleCount = (uint32_t)(mesh.indices.size() / 3);
+        if (mesh.vertices.empty()) continue;
+        glm::vec3 center(0.0f);
+        for (const auto& v : mesh.vertices) {
+            s.boundsMin = glm::min(s.boundsMin, v.Position);
+            s.boundsMax = glm::max(s.boundsMax, v.Position);
+            center += v.Position;
+        }
+        s.centroid = center / (float)mesh.vertices.size();
+        s.sphereCenter = (s.boundsMin + s.boundsMax) * 0.5f;
+        float radius2 = 0.0f;
+        for (const auto& v : mesh.vertices) {
+            glm::vec3 d = v.Position - s.sphereCenter;
+            radius2 = std::max(radius2, glm::dot(d, d));
+        }
+        s.sphereRadius = std::sqrt(radius2);
+    }
+    return out;
+}
+
+std::vector<MeshStats> analyzeSimdSerial(const std::vector<SceneMesh>& meshes) {
+    std::vector<MeshStats> out(meshes.size());
+    for (size_t m = 0; m < meshes.size(); m++) out[m] = analyzeMesh(meshes[m]);
+    return out;
+}
+
+// Mejor tiempo de 'runs' corridas, en ms.
+double timeBest(int runs, const std::function<std::vector<MeshStats>()>& fn, std::vector<MeshStats>& result) {
+    double best = 1e30;
+    for (int r = 0; r < runs; r++) {
+        auto start = Clock::now();
+        result = fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+// Diferencia máxima relativa al tamaño de cada malla.
+double maxError(const std::vector<MeshStats>& a, const std::vector<MeshStats>& b, bool& countsMatch) {
+    double worst = 0.0;
+    countsMatch = a.size() == b.size();
+    for (size_t m = 0; m < a.size() && countsMatch; m++) {
+        countsMatch = a[m].vertexCount == b[m].vertexCount && a[m].triangleCount == b[m].triangleCount;
+        if (a[m].vertexCount == 0) continue;
+        double size = std::max(1e-6f, glm::length(a[m].boundsMax - a[m].boundsMin));
+        double e = std::max({ (double)glm::length(a[m].boundsMin - b[m].boundsMin), (double)glm::length(a[m].boundsMax - b[m].boundsMax),
+                              (double)glm::length(a[m].centroid - b[m].centroid), (double)std::fabs(a[m].sphereRadius - b[m].sphereRadius) });
+        worst = std::max(worst, e / size);
+    }
+    return worst;
+}
+
+int main(int argc, char** argv) {
+    std::string path = "model/scene2/Scnecp.obj";
+    int runs = 50;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) runs = std::max(1, std::atoi(argv[++i]));
+        else path = argv[i];
+    }
+
+    SceneLoadOptions options;
+    options.uploadToGpu = false;
+    options.writeCache = false;
+    SceneModel scene(path, options);
+    if (scene.meshes.empty()) return 1;
+
+    size_t vertices = 0;
+    for (const auto& mesh : scene.meshes) vertices += mesh.vertices.size();
+    ThreadPool pool;
+    std::printf("%s: %zu meshes, %zu vertices, %zu worker threads, best of %d runs\n", path.c_str(),
+                scene.meshes.size(), vertices, pool.size(), runs);
+
+    std::vector<MeshStats> scalar, serial, parallel;
+    double scalarMs = timeBest(runs, [&] { return analyzeScalar(scene.meshes); }, scalar);
+    double serialMs = timeBest(runs, [&] { return analyzeSimdSerial(scene.meshes); }, serial);
+    double parallelMs = timeBest(runs, [&] { return analyzeMeshes(scene.meshes, pool); }, parallel);
+
+    std::printf("%-22s %10s %12s %9s\n", "variant", "ms", "Mverts/s", "speedup");
+    auto row = [&](const char* name, double ms) {
+        std::printf("%-22s %10.3f %12.1f %8.2fx\n", name, ms, vertices / (ms * 1000.0), scalarMs / ms);
+    };
+    row("scalar (ExtractData)", scalarMs);
+    row("SoA + SSE, 1 thread", serialMs);
+    row("SoA + SSE, pool", parallelMs);
+
+    bool serialCounts, parallelCounts;
+    double serialError = maxError(scalar, serial, serialCounts);
+    double parallelError = maxError(scalar, parallel, parallelCounts);
+    std::printf("max relative error: %.2e (1 thread), %.2e (pool)\n", serialError, parallelError);
+    bool ok = serialCounts && parallelCounts && serialError < 1e-4 && parallelError < 1e-4;
+    if (!ok) std::printf("MISMATCH against the scalar reference\n");
+    return ok ? 0 : 1;
+}
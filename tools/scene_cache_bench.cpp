@@ -0,0 +1,81 @@
+// Compara el tiempo de carga OBJ (Assimp) contra la caché mapeada en memoria
+// para cada modelo de un directorio.
+// Uso: scene_cache_bench [directorio] [--runs N]   (por defecto: model/scene2, 3)
+#include "gl_context.h"
+#include "../engine/scene_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/stb_image.h>
+
+namespace fs = std::filesystem;
+
+double timeLoad(const std::string& path, const SceneLoadOptions& options, bool& usedCache) {
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        SceneModel model(path, options);
+        if (options.uploadToGpu) glFinish();
+        usedCache = model.fromCache();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+double median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+int main(int argc, char** argv) {
+    std::string directory = "model/scene2";
+    int runs = 3;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) runs = std::max(1, std::atoi(argv[++i]));
+        else directory = argv[i];
+    }
+
+    std::vector<std::string> files;
+    for (const auto& entry : fs::directory_iterator(directory))
+        if (entry.path().extension() == ".obj") files.push_back(entry.path().generic_string());
+    std::sort(files.begin(), files.end());
+
+    GLFWwindow* window = createHiddenContext();
+    if (!window) return -1;
+
+    SceneLoadOptions objOptions;
+    objOptions.useCache = false;
+    objOptions.writeCache = false;
+    SceneLoadOptions cacheOptions;
+    cacheOptions.writeCache = false;
+    SceneLoadOptions mapOptions = cacheOptions;
+    mapOptions.uploadToGpu = false;
+
+    std::printf("%-28s %12s %12s %12s %9s\n", "model", "obj ms", "cache ms", "map ms", "speedup");
+    for (const auto& path : files) {
+        // Se asegura que exista una caché vigente antes de medir.
+        { SceneModel warm(path); }
+
+        std::vector<double> objTimes, cacheTimes, mapTimes;
+        bool usedCache = false, cacheHit = true;
+        for (int r = 0; r < runs; r++) {
+            objTimes.push_back(timeLoad(path, objOptions, usedCache));
+            cacheTimes.push_back(timeLoad(path, cacheOptions, usedCache));
+            cacheHit = cacheHit && usedCache;
+            mapTimes.push_back(timeLoad(path, mapOptions, usedCache));
+        }
+        double obj = median(objTimes), cache = median(cacheTimes), map = median(mapTimes);
+        std::printf("%-28s %12.2f %12.2f %12.2f %8.1fx%s\n", fs::path(path).filename().string().c_str(),
+                    obj, cache, map, cache > 0.0 ? obj / cache : 0.0, cacheHit ? "" : "  (cache miss)");
+    }
+
+    glfwTerminate();
+    return 0;
+}
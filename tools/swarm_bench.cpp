@@ -0,0 +1,145 @@
+// Escalado del enjambre de drones (drone_swarm.h): tiempo por paso con
+// distintas cantidades de drones y de hilos del pool, contra una escena
+// sintética de cajas alrededor del punto de salida (paredes de una casa y
+// columnas) en la BVH de colisión. Verifica que el estado final sea el mismo
+// con cualquier cantidad de hilos.
+// No abre ventana ni contexto GL ni necesita assets.
+// Uso: swarm_bench [--steps N] [--max-drones N] [--max-threads N]   (por defecto: 300, 16384, núcleos)
+#include "../engine/drone_swarm.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/stb_image.h>
+
+const glm::vec3 SPAWN_POINT = glm::vec3(0.0f, 2.0f, 15.0f);
+const float STEP_SECONDS = 1.0f / 60.0f;
+const int WARMUP_STEPS = 30;
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Las 12 caras de una caja como triángulos de colisión.
+void addBox(CollisionBVH& bvh, const glm::vec3& mn, const glm::vec3& mx) {
+    glm::vec3 c[8];
+    for (int i = 0; i < 8; i++)
+        c[i] = glm::vec3(i & 1 ? mx.x : mn.x, i & 2 ? mx.y : mn.y, i & 4 ? mx.z : mn.z);
+    const int faces[6][4] = { { 0, 1, 3, 2 }, { 4, 6, 7, 5 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 2, 6, 4 }, { 1, 5, 7, 3 } };
+    for (const auto& f : faces) {
+        bvh.triangles.push_back({ c[f[0]], c[f[1]], c[f[2]] });
+        bvh.triangles.push_back({ c[f[0]], c[f[2]], c[f[3]] });
+    }
+}
+
+void buildScene(CollisionBVH& bvh) {
+    // Casa de 20 x 6 x 20 con paredes de 0.3 y un piso grande
+    addBox(bvh, glm::vec3(-60.0f, -0.5f, -60.0f), glm::vec3(60.0f, 0.0f, 60.0f));
+    addBox(bvh, glm::vec3(-10.0f, 0.0f, -10.0f), glm::vec3(10.0f, 6.0f, -9.7f));
+    addBox(bvh, glm::vec3(-10.0f, 0.0f, 9.7f), glm::vec3(10.0f, 6.0f, 10.0f));
+    addBox(bvh, glm::vec3(-10.0f, 0.0f, -10.0f), glm::vec3(-9.7f, 6.0f, 10.0f));
+    addBox(bvh, glm::vec3(9.7f, 0.0f, -10.0f), glm::vec3(10.0f, 6.0f, 10.0f));
+    addBox(bvh, glm::vec3(-10.0f, 6.0f, -10.0f), glm::vec3(10.0f, 6.3f, 10.0f));
+    // Columnas en anillo, en el camino de las órbitas
+    for (int i = 0; i < 24; i++) {
+        float angle = 6.2831853f * (float)i / 24.0f;
+        glm::vec3 center = SPAWN_POINT + glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * 35.0f;
+        addBox(bvh, glm::vec3(center.x - 1.0f, 0.0f, center.z - 1.0f), glm::vec3(center.x + 1.0f, 20.0f, center.z + 1.0f));
+    }
+    bvh.build();
+}
+
+std::unique_ptr<DroneSwarm> makeSwarm(size_t drones) {
+    DroneTuning tuning;
+    tuning.spawnPoint = SPAWN_POINT;
+    std::unique_ptr<DroneSwarm> swarm(new DroneSwarm(tuning, SwarmSettings(),
+                                                     makeOrbitRoutes(SPAWN_POINT, 16, 8.0f, 60.0f, 1.0f, 15.0f)));
+    swarm->spawn(drones);
+    return swarm;
+}
+
+// Suma de posiciones y velocidades en bits: igual solo si el estado es idéntico.
+uint64_t checksum(const DroneSwarm& swarm) {
+    uint64_t sum = 1469598103934665603ull;
+    for (size_t i = 0; i < swarm.size(); i++) {
+        glm::vec3 p = swarm.position(i), v = swarm.velocity(i);
+        for (float f : { p.x, p.y, p.z, v.x, v.y, v.z }) {
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            sum = (sum ^ bits) * 1099511628211ull;
+        }
+    }
+    return sum;
+}
+
+int main(int argc, char** argv) {
+    int steps = 300;
+    size_t maxDrones = 16384;
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--steps") == 0 && hasValue) steps = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--max-drones") == 0 && hasValue) maxDrones = (size_t)std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--max-threads") == 0 && hasValue) maxThreads = (unsigned)std::max(1, std::atoi(argv[++i]));
+        else {
+            std::printf("Usage: %s [--steps N] [--max-drones N] [--max-threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    CollisionBVH scene;
+    buildScene(scene);
+    std::printf("scene: %zu triangles, %d steps of %.4f s after %d warm-up steps\n",
+                scene.triangleCount(), steps, STEP_SECONDS, WARMUP_STEPS);
+
+    // Hilos totales = los del pool + el que llama
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    std::printf("%8s %8s %10s %8s %8s %8s %8s %9s %9s %9s\n", "drones", "threads", "ms/step", "grid", "steer",
+                "integ", "resolve", "Mdrone/s", "speedup", "respawns");
+    bool deterministic = true;
+    for (size_t drones = 256; drones <= maxDrones; drones *= 4) {
+        double baseMs = 0.0;
+        uint64_t baseSum = 0;
+        for (unsigned int threads : threadCounts) {
+            ThreadPool pool(threads - 1);
+            std::unique_ptr<DroneSwarm> swarm = makeSwarm(drones);
+            for (int s = 0; s < WARMUP_STEPS; s++) swarm->step(STEP_SECONDS, pool, &scene);
+
+            SwarmStats phases;
+            int respawns = 0;
+            auto start = Clock::now();
+            for (int s = 0; s < steps; s++) {
+                swarm->step(STEP_SECONDS, pool, &scene);
+                phases.gridMs += swarm->stats.gridMs;
+                phases.steerMs += swarm->stats.steerMs;
+                phases.integrateMs += swarm->stats.integrateMs;
+                phases.resolveMs += swarm->stats.resolveMs;
+                respawns += swarm->stats.respawned;
+            }
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / steps;
+
+            uint64_t sum = checksum(*swarm);
+            if (threads == threadCounts.front()) {
+                baseMs = ms;
+                baseSum = sum;
+            }
+            else if (sum != baseSum) {
+                deterministic = false;
+            }
+            std::printf("%8zu %8u %10.3f %8.3f %8.3f %8.3f %8.3f %9.2f %8.2fx %9d\n", drones, threads, ms,
+                        phases.gridMs / steps, phases.steerMs / steps, phases.integrateMs / steps,
+                        phases.resolveMs / steps, drones / (ms * 1000.0), baseMs / ms, respawns);
+        }
+    }
+    if (!deterministic) std::printf("MISMATCH: the final state depends on the thread count\n");
+    return deterministic ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+// Rendimiento de decodificación de texturas sin ventana ni contexto GL.
+// Decodifica todo el directorio con 1, 2, 4... hilos usando la misma cola que
+// el TextureStreamer y reporta imágenes/s y MB/s (comprimidos y decodificados).
+// Uso: texture_decode_bench [directorio] [--threads N]   (por defecto: model/scene2/textures)
+#include "../engine/texture_streamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/stb_image.h>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv) {
+    std::string directory = "model/scene2/textures";
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) maxThreads = (unsigned int)std::max(1, std::atoi(argv[++i]));
+        else directory = argv[i];
+    }
+
+    std::vector<std::string> files;
+    uintmax_t compressedBytes = 0;
+    for (const auto& entry : fs::directory_iterator(directory)) {
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == ".png" || ext == ".jpg" || ext == ".jpeg") {
+            files.push_back(entry.path().generic_string());
+            compressedBytes += entry.file_size();
+        }
+    }
+    if (files.empty()) {
+        std::printf("No images found in %s\n", directory.c_str());
+        return 1;
+    }
+    std::printf("%zu images, %.1f MB compressed\n", files.size(), compressedBytes / 1048576.0);
+    std::printf("%8s %10s %10s %12s %12s %9s\n", "threads", "ms", "img/s", "in MB/s", "out MB/s", "speedup");
+
+    double baseline = 0.0;
+    for (unsigned int threads = 1; threads <= maxThreads; threads = threads < maxThreads ? std::min(threads * 2, maxThreads) : threads + 1) {
+        size_t decodedBytes = 0, failed = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            ImageDecodeQueue queue(threads, TEXTURE_READY_CAPACITY);
+            for (const auto& path : files) {
+                ImageJob job;
+                job.path = path;
+                queue.enqueue(job);
+            }
+            DecodedImage image;
+            while (queue.popReady(image)) {
+                if (image.pixels) decodedBytes += image.bytes();
+                else failed++;
+                stbi_image_free(image.pixels);
+            }
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        if (threads == 1) baseline = ms;
+
+        double seconds = ms / 1000.0;
+        std::printf("%8u %10.1f %10.1f %12.1f %12.1f %8.2fx%s\n", threads, ms, files.size() / seconds,
+                    compressedBytes / 1048576.0 / seconds, decodedBytes / 1048576.0 / seconds,
+                    baseline / ms, failed ? "  (decode failures)" : "");
+    }
+    return 0;
+}